@@ -18,6 +18,13 @@
 #define SERIAL_BAUD_RATE        115200  // USB serial baud rate
 #define COMMAND_BUFFER_SIZE     128     // Maximum command length
 #define COMMAND_TIMEOUT_MS      1000    // Timeout for incomplete commands
+#define COMMAND_WINDOW          4       // Commands a host may have in flight
+#define COMMAND_QUEUE_SIZE      256     // Bytes buffered for queued commands
+#define TX_QUEUE_URGENT_SIZE    128     // Output queue for errors and ESTOP acknowledgements
+#define TX_QUEUE_NORMAL_SIZE    256     // Output queue for replies and events
+#define TX_QUEUE_TELEMETRY_SIZE 128     // Output queue for telemetry (coalesced when full)
+#define TX_OVERFLOW_SIZE        256     // Replies waiting for the normal queue (output waits when full)
+#define PARSE_BENCHMARK_ITERATIONS 100 // Passes over the sample commands in SERVICE PARSE_BENCHMARK
 #define DEFAULT_ACK_MODE        true    // true = verbose (send ACK), false = quiet
 
 // ============================================
@@ -29,6 +36,8 @@
 #define NUM_MOSFETS             3       // MOSFET outputs (heaters/fans)
 #define NUM_ENDSWITCHES         6       // Limit switches
 #define NUM_ANALOG_SENSORS      3       // Thermistors/analog inputs
+#define MAX_DEVICES             (NUM_STEPPERS + NUM_SERVOS + NUM_MOSFETS + NUM_ENDSWITCHES + NUM_ANALOG_SENSORS)
+#define DEVICE_HASH_SLOTS       32      // Device name lookup table (power of 2, > MAX_DEVICES)
 
 // ============================================
 // MOTION SETTINGS
@@ -37,6 +46,21 @@
 #define DEFAULT_MAX_SPEED       1000.0  // steps/sec or rad/sec
 #define DEFAULT_ACCELERATION    500.0   // steps/sec^2 or rad/sec^2
 #define DEFAULT_MIN_SPEED       1.0     // Minimum speed
+#define DEFAULT_JERK            0.0     // steps/sec^3 or rad/sec^3 (0 = trapezoid ramps)
+
+// Step generation (Timer1 interrupt)
+#define STEP_TIMER_FREQUENCY    2000000UL // Timer ticks/sec (16 MHz / 8)
+#define STEP_MAX_RATE           20000.0 // Max step rate per axis (steps/sec)
+#define STEP_MIN_ACCELERATION   1.0     // Lowest usable ramp (steps/sec^2)
+#define STEP_IDLE_TICKS         2000    // ISR period when no axis is due (1 ms)
+#define STEP_MIN_TICKS          40      // Shortest ISR period (20 us)
+#define STEP_SCURVE_MIN_RATE    100.0   // Start/stop rate of S-curve ramps (steps/sec)
+#define STEP_PULSE_TICKS        4       // Minimum step pulse width (2 us)
+#define STEP_BENCHMARK_ITERATIONS 1000  // Output writes timed by SERVICE STEP_BENCHMARK
+
+// Coordinated moves (lookahead planner)
+#define MOTION_QUEUE_SIZE       16      // Ring buffer slots (one stays free)
+#define MOTION_JUNCTION_DEVIATION 0.01  // Corner blending tolerance (units)
 
 // Servo settings
 #define SERVO_MIN_ANGLE         0       // degrees
@@ -51,7 +75,12 @@
 #define ANALOG_RESOLUTION       10      // bits (10 for Arduino)
 #define ANALOG_MAX_VALUE        1023    // 2^10 - 1
 #define ANALOG_SMOOTHING        true    // Enable averaging
-#define ANALOG_SAMPLES          5       // Number of samples to average
+#define ANALOG_SAMPLES          5       // Samples averaged per channel (ADC interrupt ring)
+#define THERMISTOR_TABLE_MIN    -40     // Lowest temperature in the thermistor table (°C)
+#define THERMISTOR_TABLE_MAX    400     // Highest temperature in the thermistor table (°C)
+#define THERMISTOR_TABLE_STEP   5       // Table spacing (°C); 5 keeps interpolation error < 0.25°C
+#define THERMISTOR_TABLE_SIZE   ((THERMISTOR_TABLE_MAX - THERMISTOR_TABLE_MIN) / THERMISTOR_TABLE_STEP + 1)
+#define THERMISTOR_BENCHMARK_ITERATIONS 200 // Conversions timed by SERVICE THERMISTOR_BENCHMARK
 
 // Sensor value modes
 #define SENSOR_MODE_RAW         0       // Raw ADC values
@@ -63,6 +92,29 @@
 #define ENABLE_THRESHOLDS       false
 #define DEFAULT_THRESHOLD       512     // Middle of ADC range
 
+// ============================================
+// HEATER CONTROL SETTINGS
+// ============================================
+#define NUM_HEATERS             2       // Closed-loop heater slots
+#define HEATER_CONTROL_INTERVAL 100     // PID period (ms)
+#define HEATER_MAX_TEMP         275.0   // Highest accepted setpoint (°C)
+
+// Relay autotune
+#define AUTOTUNE_CYCLES         5       // Oscillations to measure
+#define AUTOTUNE_HYSTERESIS     1.0     // Switching band around the target (°C)
+#define AUTOTUNE_MAX_OVERSHOOT  20.0    // Abort above target + this (°C)
+#define AUTOTUNE_TIMEOUT_MS     900000  // Abort after 15 minutes
+
+// Thermal protection (emergency stop on a fault)
+#define THERMAL_MIN_TEMP        0.0     // Lower readings mean an open/shorted sensor (°C)
+#define THERMAL_MAX_TEMP        290.0   // Absolute limit while powered (°C)
+#define THERMAL_FAULT_COUNT     3       // Consecutive periods outside the limits
+#define THERMAL_HYSTERESIS      5.0     // Target counts as reached within this (°C)
+#define THERMAL_WATCH_PERIOD_MS 20000   // Window for the heating check (use ~60000 for a bed)
+#define THERMAL_WATCH_RISE      2.0     // Minimum rise per window while heating (°C)
+#define THERMAL_RUNAWAY_BAND    10.0    // Allowed drop below a reached target (°C)
+#define THERMAL_RUNAWAY_PERIOD_MS 30000 // Time allowed outside the band
+
 // ============================================
 // SYSTEM BEHAVIOR
 // ============================================
@@ -78,7 +130,9 @@
 #define SERVICE_NOTIFY_START    true    // Send notification when service starts
 #define SERVICE_NOTIFY_DONE     true    // Send notification when service completes
 #define CALIBRATION_SPEED       100.0   // Speed for homing/calibration
-#define CALIBRATION_TIMEOUT_MS  30000   // Maximum time for calibration
+#define CALIBRATION_TIMEOUT_MS  30000   // Maximum time for each homing phase
+#define CALIBRATION_SLOW_SPEED  25.0    // Speed for the second, latching approach
+#define CALIBRATION_BACKOFF_STEPS 160   // Steps to back off the switch between approaches
 
 // ============================================
 // DEBUG SETTINGS
@@ -90,15 +144,26 @@
 // FEATURE TOGGLES
 // ============================================
 #define ENABLE_JSON_MODE        false   // JSON protocol support (future)
+#define ENABLE_BINARY_MODE      true    // COBS/CRC16 binary protocol (CONTROLLER protocol binary)
 #define ENABLE_DISPLAY          false   // LCD display support (future)
 #define ENABLE_ENCODER          false   // Rotary encoder support (future)
 #define ENABLE_SD_CARD          false   // SD card support (future)
+#define ENABLE_PROFILING        false   // Loop, device and command timing (CONTROLLER perf?), ~450 bytes RAM
 
 // ============================================
 // TIMING SETTINGS
 // ============================================
-#define MAIN_LOOP_DELAY         1       // ms delay in main loop (0 = no delay)
-#define STATUS_UPDATE_INTERVAL  1000    // ms between status updates (if enabled)
+#define SCHEDULER_MAX_TASKS     24      // Main loop tasks (interface, devices, loops)
+#define STEPPER_TASK_PERIOD     1       // ms between stepper updates (velocity mode refill)
+#define SERVO_TASK_PERIOD       5       // ms between servo position updates
+#define OUTPUT_TASK_PERIOD      5       // ms between output fade steps
+#define SWITCH_TASK_PERIOD      1       // ms between end switch updates
+#define SENSOR_TASK_PERIOD      5       // ms between analog sensor updates
+#define CONTROL_TASK_PERIOD     1       // ms between heater, homing and telemetry checks
+#define HEARTBEAT_PERIOD        2000    // ms between heartbeat LED blinks
+#define HEARTBEAT_ON_TIME       50      // ms the heartbeat LED stays on
+#define STATUS_UPDATE_INTERVAL  1000    // Default ms between telemetry records (SUBSCRIBE)
+#define TELEMETRY_MAX_CHANNELS  8       // Device values in one telemetry record
 
 // ============================================
 // PROTOCOL SETTINGS
@@ -106,7 +171,10 @@
 #define COMMAND_START_CHAR      '>'     // Command prefix character
 #define COMMAND_DELIMITER       ' '     // Field separator in commands
 #define COMMAND_TERMINATOR      '\n'    // End of command character
+#define COMMAND_SEQUENCE_CHAR   '#'     // Optional sequence tag prefix (#<n> >X position 1)
 #define USE_START_MARKER        true    // Require start character
+#define COMMAND_MAX_PARAMS      4       // Values after the interface (move x y z feed)
+#define BINARY_MAX_PAYLOAD      64      // Largest binary reply payload (longer text is split)
 
 // ============================================
 // ERROR CODES
@@ -43,6 +43,13 @@
 #define STEPPER_E0_MAX_SPEED        800.0
 #define STEPPER_E1_MAX_SPEED        800.0
 
+// Accelerations (steps/sec^2)
+#define STEPPER_X_ACCELERATION      4000.0
+#define STEPPER_Y_ACCELERATION      4000.0
+#define STEPPER_Z_ACCELERATION      2000.0
+#define STEPPER_E0_ACCELERATION     4000.0
+#define STEPPER_E1_ACCELERATION     4000.0
+
 // ============================================
 // SERVO CONFIGURATION
 // ============================================
@@ -109,6 +116,22 @@
 #define SWITCH_Y_MAX_INVERTED   false
 #define SWITCH_Z_MAX_INVERTED   false
 
+// Axis binding: each switch limits one axis at one end. While triggered
+// it blocks travel in SWITCH_*_DIRECTION (-1 min end, +1 max end, 0 to
+// only report it); the min end switch is also the axis's home switch.
+#define SWITCH_X_MIN_AXIS       STEPPER_X_NAME
+#define SWITCH_X_MIN_DIRECTION  -1
+#define SWITCH_Y_MIN_AXIS       STEPPER_Y_NAME
+#define SWITCH_Y_MIN_DIRECTION  -1
+#define SWITCH_Z_MIN_AXIS       STEPPER_Z_NAME
+#define SWITCH_Z_MIN_DIRECTION  -1
+#define SWITCH_X_MAX_AXIS       STEPPER_X_NAME
+#define SWITCH_X_MAX_DIRECTION  1
+#define SWITCH_Y_MAX_AXIS       STEPPER_Y_NAME
+#define SWITCH_Y_MAX_DIRECTION  1
+#define SWITCH_Z_MAX_AXIS       STEPPER_Z_NAME
+#define SWITCH_Z_MAX_DIRECTION  1
+
 // ============================================
 // ANALOG SENSOR CONFIGURATION
 // ============================================
@@ -133,14 +156,26 @@
 #define ANALOG_0_THERMISTOR_BETA 3950   // Thermistor beta value
 
 // ============================================
-// DEVICE COUNT VERIFICATION
+// HEATER LOOP CONFIGURATION
 // ============================================
-// These should match NUM_* in Config.h
-#define CONFIGURED_STEPPERS     3   // X, Y, Z
-#define CONFIGURED_SERVOS       2   // Servo 0, 1
-#define CONFIGURED_MOSFETS      3   // A, B, C
-#define CONFIGURED_SWITCHES     3   // X_MIN, Y_MIN, Z_MIN
-#define CONFIGURED_ANALOG       2   // Analog 0, 1
+// A heater loop regulates a MOSFET output from a thermistor input
+#define HEATER_0_ENABLED
+// #define HEATER_1_ENABLED
+
+#define HEATER_0_SENSOR         ANALOG_0_NAME   // T0 thermistor
+#define HEATER_0_OUTPUT         MOSFET_A_NAME   // D10 hotend
+#define HEATER_1_SENSOR         ANALOG_1_NAME   // T1 (needs SENSOR_MODE_CUSTOM)
+#define HEATER_1_OUTPUT         MOSFET_C_NAME   // D8 bed
+
+// PID gains (duty per °C); replaced by the AUTOTUNE_<output> service
+#define HEATER_0_KP             0.08
+#define HEATER_0_KI             0.004
+#define HEATER_0_KD             0.4
+#define HEATER_0_MAX_POWER      1.0     // Highest duty (0.0-1.0)
+#define HEATER_1_KP             0.3
+#define HEATER_1_KI             0.01
+#define HEATER_1_KD             2.0
+#define HEATER_1_MAX_POWER      1.0
 
 // ============================================
 // BULK COMMAND GROUP NAMES
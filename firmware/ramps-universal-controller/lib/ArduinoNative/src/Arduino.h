@@ -0,0 +1,135 @@
+/**
+ * @file Arduino.h
+ * @brief Arduino core API for host builds (env:native)
+ *
+ * Only what the firmware uses from the AVR core, implemented on top of
+ * the simulated board in NativeHal. The Mega 2560 pin numbering is kept
+ * so PinDefinitions.h works unchanged.
+ */
+
+#ifndef ARDUINO_NATIVE_H
+#define ARDUINO_NATIVE_H
+
+// Standard headers first: the min/max/abs/round macros below would
+// break their declarations
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "WString.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH                    0x1
+#define LOW                     0x0
+
+#define INPUT                   0x0
+#define OUTPUT                  0x1
+#define INPUT_PULLUP            0x2
+
+#define CHANGE                  1
+#define FALLING                 2
+#define RISING                  3
+#define NOT_AN_INTERRUPT        -1
+
+#define PI                      3.1415926535897932384626433832795
+#define HALF_PI                 1.5707963267948966192313216916398
+#define TWO_PI                  6.283185307179586476925286766559
+#define DEG_TO_RAD              0.017453292519943295769236907684886
+#define RAD_TO_DEG              57.295779513082320876798154814105
+
+#define LED_BUILTIN             13
+#define NUM_DIGITAL_PINS        70
+#define NUM_ANALOG_INPUTS       16
+
+#define A0                      54
+#define A1                      55
+#define A2                      56
+#define A3                      57
+#define A4                      58
+#define A5                      59
+#define A6                      60
+#define A7                      61
+#define A8                      62
+#define A9                      63
+#define A10                     64
+#define A11                     65
+#define A12                     66
+#define A13                     67
+#define A14                     68
+#define A15                     69
+
+// Program memory is ordinary memory on the host
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define F(s)                    (s)
+#define pgm_read_byte(addr)     (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t*)(addr))
+#define pgm_read_float(addr)    (*(const float*)(addr))
+#define strcmp_P(a, b)          strcmp((a), (b))
+#define strcasecmp_P(a, b)      strcasecmp((a), (b))
+#define strncasecmp_P(a, b, n)  strncasecmp((a), (b), (n))
+#define memcpy_P(d, s, n)       memcpy((d), (s), (n))
+
+// Same macros as the AVR core
+#define min(a, b)               ((a) < (b) ? (a) : (b))
+#define max(a, b)               ((a) > (b) ? (a) : (b))
+#define abs(x)                  ((x) > 0 ? (x) : -(x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define round(x)                ((x) >= 0 ? (long)((x) + 0.5) : (long)((x) - 0.5))
+#define radians(deg)            ((deg) * DEG_TO_RAD)
+#define degrees(rad)            ((rad) * RAD_TO_DEG)
+#define sq(x)                   ((x) * (x))
+
+#define lowByte(w)              ((uint8_t)((w) & 0xff))
+#define highByte(w)             ((uint8_t)((w) >> 8))
+#define bitRead(value, bit)     (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)      ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)    ((value) &= ~(1UL << (bit)))
+#define bit(b)                  (1UL << (b))
+#define _BV(b)                  (1 << (b))
+
+// Interrupts cannot preempt the simulated firmware
+#define interrupts()
+#define noInterrupts()
+#define cli()
+#define sei()
+
+// Digital and analog I/O
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+// External interrupts (Mega 2560 pins 2, 3, 18-21)
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+// Time (virtual, see NativeHal)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+// Sketch entry points
+void setup();
+void loop();
+
+#endif // ARDUINO_NATIVE_H
@@ -0,0 +1,189 @@
+/**
+ * @file HardwareSerial.cpp
+ * @brief Implementation of the simulated UART
+ */
+
+#include "HardwareSerial.h"
+#include "NativeHal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SERIAL_READ_AHEAD       256     // Host bytes read before they are due
+#define SERIAL_POLL_NS          50000   // Shortest virtual time between host reads
+
+HardwareSerial Serial;
+
+HardwareSerial::HardwareSerial() {
+    inFd = -1;
+    outFd = -1;
+    baud = 0;
+    lastRx = 0;
+    lastTx = 0;
+    lastPoll = 0;
+    inputClosed = false;
+    overruns = 0;
+}
+
+/**
+ * @brief Connect the UART to host file descriptors
+ */
+void HardwareSerial::connect(int input, int output, bool blocking) {
+    inFd = input;
+    outFd = output;
+    inputClosed = (input < 0);
+
+    if (inFd >= 0) {
+        int flags = fcntl(inFd, F_GETFL);
+        if (flags >= 0) {
+            fcntl(inFd, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK));
+        }
+    }
+}
+
+/**
+ * @brief Move bytes whose time has come
+ */
+void HardwareSerial::service() {
+    uint64_t now = NativeHal::nanos();
+
+    // Read ahead from the host; bytes arrive one byte time apart
+    if (inFd >= 0 && !inputClosed && incoming.size() < SERIAL_READ_AHEAD &&
+        (now - lastPoll >= SERIAL_POLL_NS || incoming.empty())) {
+        lastPoll = now;
+        uint8_t buffer[SERIAL_READ_AHEAD];
+        ssize_t n = ::read(inFd, buffer, SERIAL_READ_AHEAD - incoming.size());
+        if (n > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                lastRx = (lastRx > now ? lastRx : now) + byteTime();
+                incoming.push_back({buffer[i], lastRx});
+            }
+        } else if (n == 0) {
+            inputClosed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EIO && errno != EINTR) {
+            inputClosed = true;
+        }
+    }
+
+    while (!incoming.empty() && incoming.front().time <= now) {
+        if (rxBuffer.size() < SERIAL_RX_BUFFER_SIZE - 1) {
+            rxBuffer.push_back(incoming.front().value);
+        } else {
+            overruns++;     // The AVR core drops bytes when its buffer is full
+        }
+        incoming.pop_front();
+    }
+
+    // Hand finished output to the host in one write
+    uint8_t out[SERIAL_TX_BUFFER_SIZE];
+    size_t count = 0;
+    while (!txBuffer.empty() && txBuffer.front().time <= now) {
+        out[count++] = txBuffer.front().value;
+        txBuffer.pop_front();
+    }
+    if (count > 0 && outFd >= 0) {
+        size_t done = 0;
+        while (done < count) {
+            ssize_t n = ::write(outFd, out + done, count - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += n;
+        }
+    }
+}
+
+/**
+ * @brief Send all pending output now
+ */
+void HardwareSerial::drain() {
+    while (!txBuffer.empty()) {
+        uint8_t c = txBuffer.front().value;
+        txBuffer.pop_front();
+        if (outFd >= 0 && ::write(outFd, &c, 1) < 0) break;
+    }
+}
+
+/**
+ * @brief Check if the host input is exhausted
+ */
+bool HardwareSerial::isInputDone() const {
+    return inputClosed && incoming.empty() && rxBuffer.empty();
+}
+
+void HardwareSerial::begin(unsigned long rate) {
+    baud = rate;
+}
+
+void HardwareSerial::end() {
+    flush();
+}
+
+int HardwareSerial::available() {
+    service();
+    return (int)rxBuffer.size();
+}
+
+int HardwareSerial::peek() {
+    service();
+    return rxBuffer.empty() ? -1 : rxBuffer.front();
+}
+
+int HardwareSerial::read() {
+    service();
+    if (rxBuffer.empty()) return -1;
+    uint8_t c = rxBuffer.front();
+    rxBuffer.pop_front();
+    return c;
+}
+
+/**
+ * @brief Get free room in the transmit buffer
+ *
+ * Firmware polls this in a loop while it waits for room. On the board the
+ * UART empties meanwhile; here a full buffer lets virtual time run until
+ * the oldest byte is out, so such a loop cannot spin forever.
+ */
+int HardwareSerial::availableForWrite() {
+    service();
+    if (txBuffer.size() >= SERIAL_TX_BUFFER_SIZE - 1) {
+        NativeHal::advance(txBuffer.front().time - NativeHal::nanos());
+    }
+    return (int)(SERIAL_TX_BUFFER_SIZE - 1 - txBuffer.size());
+}
+
+/**
+ * @brief Wait until all output has been sent
+ */
+void HardwareSerial::flush() {
+    while (!txBuffer.empty()) {
+        NativeHal::advance(txBuffer.back().time - NativeHal::nanos());
+        service();
+    }
+}
+
+/**
+ * @brief Queue a byte, waiting for room like the AVR core
+ */
+size_t HardwareSerial::write(uint8_t c) {
+    // Polling a full buffer lets virtual time pass
+    while (availableForWrite() <= 0) {}
+
+    uint64_t now = NativeHal::nanos();
+    lastTx = (lastTx > now ? lastTx : now) + byteTime();
+    txBuffer.push_back({c, lastTx});
+
+    if (baud == 0) service();
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t HardwareSerial::write(const char* str) {
+    return str ? write((const uint8_t*)str, strlen(str)) : 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file HardwareSerial.h
+ * @brief Simulated UART for host builds
+ *
+ * Bytes move at the configured baud rate in virtual time, through 64
+ * byte receive and transmit buffers like the AVR core's: input read from
+ * the host file descriptor becomes available one byte time apart and is
+ * lost when the receive buffer is full; output reaches the host when its
+ * byte time has passed, and write() waits (advancing virtual time) when
+ * the transmit buffer is full.
+ */
+
+#ifndef ARDUINO_NATIVE_HARDWARE_SERIAL_H
+#define ARDUINO_NATIVE_HARDWARE_SERIAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include "WString.h"
+
+#define SERIAL_RX_BUFFER_SIZE   64
+#define SERIAL_TX_BUFFER_SIZE   64
+
+/**
+ * @class HardwareSerial
+ * @brief UART backed by host file descriptors
+ */
+class HardwareSerial {
+private:
+    struct TimedByte {
+        uint8_t value;
+        uint64_t time;              // Virtual ns when the byte has moved
+    };
+
+    int inFd;                       // Host input (-1 = none)
+    int outFd;                      // Host output (-1 = discard)
+    unsigned long baud;             // 0 = no rate limit
+    uint64_t lastRx;                // Arrival time of the last received byte
+    uint64_t lastTx;                // Completion time of the last sent byte
+    uint64_t lastPoll;              // Virtual time of the last host read
+    std::deque<TimedByte> incoming; // Read from the host, not yet arrived
+    std::deque<uint8_t> rxBuffer;   // Arrived, not yet read by the firmware
+    std::deque<TimedByte> txBuffer; // Written, not yet on the host
+    bool inputClosed;               // Host input reached end of file
+    uint32_t overruns;              // Bytes lost to a full receive buffer
+
+public:
+    HardwareSerial();
+
+    /**
+     * @brief Connect the UART to host file descriptors
+     *
+     * Blocking input suits scripts: virtual time stands still while the
+     * host has nothing to send, so when the bytes arrive cannot change
+     * the run.
+     * @param input Host input (-1 for none)
+     * @param output Host output (-1 to discard)
+     * @param blocking true to wait for host input
+     */
+    void connect(int input, int output, bool blocking = false);
+
+    /**
+     * @brief Move bytes whose time has come (called by NativeHal)
+     */
+    void service();
+
+    /**
+     * @brief Send all pending output now, regardless of virtual time
+     */
+    void drain();
+
+    /**
+     * @brief Check if the host input is exhausted
+     * @return true after end of file once every byte was read
+     */
+    bool isInputDone() const;
+
+    /**
+     * @brief Check if output is still in flight
+     * @return true if the transmit buffer holds bytes
+     */
+    bool isSending() const { return !txBuffer.empty(); }
+
+    /**
+     * @brief Get bytes lost to a full receive buffer
+     */
+    uint32_t getOverruns() const { return overruns; }
+
+    /**
+     * @brief Nanoseconds per byte (start, 8 data and stop bits)
+     */
+    uint64_t byteTime() const { return baud ? 10000000000ULL / baud : 0; }
+
+    // Arduino API
+    void begin(unsigned long rate);
+    void end();
+    int available();
+    int peek();
+    int read();
+    int availableForWrite();
+    void flush();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str);
+
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, (unsigned char)digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_NATIVE_HARDWARE_SERIAL_H
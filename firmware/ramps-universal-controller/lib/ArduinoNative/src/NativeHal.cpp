@@ -0,0 +1,331 @@
+/**
+ * @file NativeHal.cpp
+ * @brief Simulated board state, virtual clock and the Arduino I/O API
+ */
+
+#include "Arduino.h"
+#include "NativeHal.h"
+#include <stdio.h>
+#include <time.h>
+
+#define NATIVE_NUM_INTERRUPTS   6
+#define REALTIME_SLACK_NS       2000000ULL  // Virtual time may lead the wall clock by this much
+
+namespace {
+
+struct PinState {
+    int mode = INPUT;
+    int latch = LOW;            // Level written by the firmware
+    bool driven = false;        // Input driven from outside
+    int input = LOW;            // Level of a driven input
+    int pwm = 0;
+    int servo = 0;              // Servo pulse in us (0 = none)
+};
+
+struct Interrupt {
+    void (*handler)(void) = nullptr;
+    int mode = CHANGE;
+};
+
+PinState pins[NATIVE_NUM_PINS];
+int analogInputs[NUM_ANALOG_INPUTS];
+Interrupt pinInterrupts[NATIVE_NUM_INTERRUPTS];
+NativePinWatcher pinWatcher = nullptr;
+
+uint64_t clockNs = 0;
+uint64_t runLimitNs = 0;
+
+NativeTimerHandler timerHandler = nullptr;
+uint32_t timerFrequency = 1;
+uint64_t timerNextNs = 0;
+uint64_t timerRemainder = 0;    // ns * frequency carried between compare matches
+bool inTimer = false;
+
+bool realtime = false;
+bool wallStarted = false;
+struct timespec wallStart;
+
+uint32_t randomState = 1;
+
+/**
+ * @brief Wall clock time since the first paced advance
+ */
+uint64_t wallElapsed() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - wallStart.tv_sec) * 1000000000ULL + now.tv_nsec - wallStart.tv_nsec;
+}
+
+/**
+ * @brief Schedule the next compare match
+ */
+void scheduleTimer(uint32_t ticks) {
+    if (ticks == 0) ticks = 1;
+    uint64_t scaled = (uint64_t)ticks * 1000000000ULL + timerRemainder;
+    timerNextNs += scaled / timerFrequency;
+    timerRemainder = scaled % timerFrequency;
+}
+
+/**
+ * @brief External interrupt number of a pin (Mega 2560)
+ */
+int pinInterrupt(uint8_t pin) {
+    switch (pin) {
+        case 2:  return 0;
+        case 3:  return 1;
+        case 21: return 2;
+        case 20: return 3;
+        case 19: return 4;
+        case 18: return 5;
+        default: return NOT_AN_INTERRUPT;
+    }
+}
+
+}   // namespace
+
+// ============================================
+// Clock
+// ============================================
+
+uint64_t NativeHal::nanos() {
+    return clockNs;
+}
+
+void NativeHal::advance(uint64_t ns) {
+    uint64_t target = clockNs + ns;
+
+    // Compare matches in the interval, at their own instants
+    if (!inTimer) {
+        inTimer = true;
+        while (timerHandler && timerNextNs <= target) {
+            clockNs = timerNextNs;
+            scheduleTimer(timerHandler());
+        }
+        inTimer = false;
+    }
+    clockNs = target;
+
+    Serial.service();
+
+    if (realtime) {
+        if (!wallStarted) {
+            clock_gettime(CLOCK_MONOTONIC, &wallStart);
+            wallStarted = true;
+        }
+        uint64_t wall = wallElapsed();
+        if (clockNs > wall + REALTIME_SLACK_NS) {
+            uint64_t lead = clockNs - wall;
+            struct timespec pause = { (time_t)(lead / 1000000000ULL), (long)(lead % 1000000000ULL) };
+            nanosleep(&pause, nullptr);
+        }
+    }
+
+    if (isExpired()) {
+        NativeHal::exit(0);
+    }
+}
+
+void NativeHal::setRealtime(bool enabled) {
+    realtime = enabled;
+    wallStarted = false;
+}
+
+bool NativeHal::isRealtime() {
+    return realtime;
+}
+
+void NativeHal::setRunLimit(uint64_t ns) {
+    runLimitNs = ns;
+}
+
+bool NativeHal::isExpired() {
+    return runLimitNs > 0 && clockNs >= runLimitNs;
+}
+
+void NativeHal::exit(int code) {
+    Serial.drain();
+    if (Serial.getOverruns() > 0) {
+        // Bytes the firmware did not read in time (a stalled main loop)
+        fprintf(stderr, "RX overruns: %lu\n", (unsigned long)Serial.getOverruns());
+    }
+    ::exit(code);
+}
+
+// ============================================
+// Timer
+// ============================================
+
+void NativeHal::attachTimer(NativeTimerHandler handler, uint32_t frequency, uint32_t firstTicks) {
+    timerHandler = handler;
+    timerFrequency = frequency ? frequency : 1;
+    timerNextNs = clockNs;
+    timerRemainder = 0;
+    scheduleTimer(firstTicks);
+}
+
+void NativeHal::detachTimer() {
+    timerHandler = nullptr;
+}
+
+// ============================================
+// Pins
+// ============================================
+
+void NativeHal::setInput(uint8_t pin, int level) {
+    if (pin >= NATIVE_NUM_PINS) return;
+
+    int before = readPin(pin);
+    pins[pin].driven = true;
+    pins[pin].input = level ? HIGH : LOW;
+    int after = readPin(pin);
+
+    int number = pinInterrupt(pin);
+    if (before == after || number == NOT_AN_INTERRUPT) return;
+
+    const Interrupt& interrupt = pinInterrupts[number];
+    if (interrupt.handler &&
+        (interrupt.mode == CHANGE ||
+         (interrupt.mode == RISING && after == HIGH) ||
+         (interrupt.mode == FALLING && after == LOW))) {
+        interrupt.handler();
+    }
+}
+
+void NativeHal::releaseInput(uint8_t pin) {
+    if (pin >= NATIVE_NUM_PINS) return;
+    pins[pin].driven = false;
+}
+
+void NativeHal::setAnalog(uint8_t pin, int value) {
+    uint8_t channel = (pin >= A0) ? pin - A0 : pin;
+    if (channel >= NUM_ANALOG_INPUTS) return;
+    analogInputs[channel] = constrain(value, 0, 1023);
+}
+
+int NativeHal::getOutput(uint8_t pin) {
+    return (pin < NATIVE_NUM_PINS) ? pins[pin].latch : LOW;
+}
+
+int NativeHal::getPwm(uint8_t pin) {
+    return (pin < NATIVE_NUM_PINS) ? pins[pin].pwm : 0;
+}
+
+int NativeHal::getMode(uint8_t pin) {
+    return (pin < NATIVE_NUM_PINS) ? pins[pin].mode : INPUT;
+}
+
+int NativeHal::getServoPulse(uint8_t pin) {
+    return (pin < NATIVE_NUM_PINS) ? pins[pin].servo : 0;
+}
+
+void NativeHal::setPinWatcher(NativePinWatcher watcher) {
+    pinWatcher = watcher;
+}
+
+void NativeHal::writePin(uint8_t pin, int level) {
+    if (pin >= NATIVE_NUM_PINS) return;
+
+    level = level ? HIGH : LOW;
+    PinState& state = pins[pin];
+    state.pwm = level ? 255 : 0;
+    if (state.latch == level) return;
+
+    state.latch = level;
+    if (pinWatcher) pinWatcher(pin, level, clockNs);
+}
+
+int NativeHal::readPin(uint8_t pin) {
+    if (pin >= NATIVE_NUM_PINS) return LOW;
+
+    const PinState& state = pins[pin];
+    if (state.mode == OUTPUT) return state.latch;
+    if (state.driven) return state.input;
+    return (state.mode == INPUT_PULLUP) ? HIGH : LOW;
+}
+
+void NativeHal::setPinMode(uint8_t pin, int mode) {
+    if (pin >= NATIVE_NUM_PINS) return;
+    pins[pin].mode = mode;
+}
+
+void NativeHal::writePwm(uint8_t pin, int duty) {
+    if (pin >= NATIVE_NUM_PINS) return;
+
+    duty = constrain(duty, 0, 255);
+    PinState& state = pins[pin];
+    if (state.pwm == duty) return;
+
+    state.pwm = duty;
+    state.latch = (duty >= 128) ? HIGH : LOW;
+    if (pinWatcher) pinWatcher(pin, duty, clockNs);
+}
+
+int NativeHal::readAnalog(uint8_t pin) {
+    uint8_t channel = (pin >= A0) ? pin - A0 : pin;
+    return (channel < NUM_ANALOG_INPUTS) ? analogInputs[channel] : 0;
+}
+
+void NativeHal::writeServo(uint8_t pin, int pulse) {
+    if (pin >= NATIVE_NUM_PINS) return;
+    pins[pin].servo = pulse;
+}
+
+void NativeHal::attachPinInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+    if (interrupt >= NATIVE_NUM_INTERRUPTS) return;
+    pinInterrupts[interrupt].handler = handler;
+    pinInterrupts[interrupt].mode = mode;
+}
+
+void NativeHal::detachPinInterrupt(uint8_t interrupt) {
+    if (interrupt >= NATIVE_NUM_INTERRUPTS) return;
+    pinInterrupts[interrupt].handler = nullptr;
+}
+
+// ============================================
+// Arduino API
+// ============================================
+
+void pinMode(uint8_t pin, uint8_t mode) { NativeHal::setPinMode(pin, mode); }
+void digitalWrite(uint8_t pin, uint8_t value) { NativeHal::writePin(pin, value); }
+int digitalRead(uint8_t pin) { return NativeHal::readPin(pin); }
+int analogRead(uint8_t pin) { return NativeHal::readAnalog(pin); }
+
+void analogWrite(uint8_t pin, int value) {
+    // Like the AVR core: the ends of the range are plain digital levels
+    if (value <= 0) {
+        NativeHal::writePin(pin, LOW);
+    } else if (value >= 255) {
+        NativeHal::writePin(pin, HIGH);
+    } else {
+        NativeHal::writePwm(pin, value);
+    }
+}
+
+int digitalPinToInterrupt(uint8_t pin) { return pinInterrupt(pin); }
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) { NativeHal::attachPinInterrupt(interrupt, handler, mode); }
+void detachInterrupt(uint8_t interrupt) { NativeHal::detachPinInterrupt(interrupt); }
+
+unsigned long millis() { return (unsigned long)(NativeHal::nanos() / 1000000ULL); }
+unsigned long micros() { return (unsigned long)(NativeHal::nanos() / 1000ULL); }
+void delay(unsigned long ms) { NativeHal::advance((uint64_t)ms * 1000000ULL); }
+void delayMicroseconds(unsigned int us) { NativeHal::advance((uint64_t)us * 1000ULL); }
+void yield() {}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    randomState = randomState * 1103515245UL + 12345UL;     // Deterministic across runs
+    return (long)((randomState >> 1) % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) randomState = (uint32_t)seed;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file NativeHal.h
+ * @brief Simulated Mega 2560 for host builds
+ *
+ * Time is virtual: it only moves when the simulation advances it (each
+ * loop() pass, delay(), a blocking serial write), so a run is
+ * deterministic and may go faster or slower than real time. Advancing
+ * fires the simulated step timer at its programmed instants and moves
+ * serial bytes. Pins and ADC inputs are plain state a harness can set
+ * and inspect; every output change can be reported to a watcher with its
+ * timestamp.
+ */
+
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <stdint.h>
+
+#define NATIVE_NUM_PINS         70
+
+/**
+ * @brief Timer compare handler
+ * @return Timer ticks until the next call
+ */
+typedef uint32_t (*NativeTimerHandler)();
+
+/**
+ * @brief Output change callback
+ * @param pin Pin number
+ * @param level New level (HIGH/LOW) or PWM duty (0-255)
+ * @param nanos Virtual time of the change
+ */
+typedef void (*NativePinWatcher)(uint8_t pin, int level, uint64_t nanos);
+
+/**
+ * @class NativeHal
+ * @brief Board state and virtual clock
+ */
+class NativeHal {
+public:
+    // Clock
+
+    /**
+     * @brief Get virtual time
+     * @return Nanoseconds since start
+     */
+    static uint64_t nanos();
+
+    /**
+     * @brief Move virtual time forward
+     *
+     * Runs the timer handler at every compare instant in the interval
+     * and services the serial port. Stops the program once the run limit
+     * is reached.
+     * @param ns Nanoseconds to advance
+     */
+    static void advance(uint64_t ns);
+
+    /**
+     * @brief Keep virtual time from running ahead of the wall clock
+     * @param enabled true to pace the simulation in real time
+     */
+    static void setRealtime(bool enabled);
+
+    /**
+     * @brief Check if the simulation is paced in real time
+     */
+    static bool isRealtime();
+
+    /**
+     * @brief Stop the program when virtual time reaches a limit
+     * @param ns Limit in nanoseconds (0 = none)
+     */
+    static void setRunLimit(uint64_t ns);
+
+    /**
+     * @brief Check if the run limit has been reached
+     */
+    static bool isExpired();
+
+    /**
+     * @brief Flush serial output and exit
+     * @param code Exit code
+     */
+    static void exit(int code);
+
+    // Timer
+
+    /**
+     * @brief Attach the step timer (Timer1 on the board)
+     * @param handler Called at each compare match
+     * @param frequency Timer ticks per second
+     * @param firstTicks Ticks until the first call
+     */
+    static void attachTimer(NativeTimerHandler handler, uint32_t frequency, uint32_t firstTicks);
+
+    /**
+     * @brief Stop the step timer
+     */
+    static void detachTimer();
+
+    // Pins
+
+    /**
+     * @brief Drive an input pin from outside (switch, sensor)
+     *
+     * Runs an attached external interrupt on a matching edge.
+     * @param pin Pin number
+     * @param level HIGH or LOW
+     */
+    static void setInput(uint8_t pin, int level);
+
+    /**
+     * @brief Release an input so it floats (pull-up or LOW)
+     * @param pin Pin number
+     */
+    static void releaseInput(uint8_t pin);
+
+    /**
+     * @brief Set the voltage seen by an analog input
+     * @param pin Analog pin (A0-A15) or channel (0-15)
+     * @param value ADC reading (0-1023)
+     */
+    static void setAnalog(uint8_t pin, int value);
+
+    /**
+     * @brief Get the level written to an output
+     * @param pin Pin number
+     * @return HIGH or LOW
+     */
+    static int getOutput(uint8_t pin);
+
+    /**
+     * @brief Get the PWM duty written with analogWrite()
+     * @param pin Pin number
+     * @return Duty (0-255)
+     */
+    static int getPwm(uint8_t pin);
+
+    /**
+     * @brief Get the mode set with pinMode()
+     * @param pin Pin number
+     * @return INPUT, OUTPUT or INPUT_PULLUP
+     */
+    static int getMode(uint8_t pin);
+
+    /**
+     * @brief Get the pulse width of a servo output
+     * @param pin Pin number
+     * @return Pulse in microseconds, 0 if no servo is attached
+     */
+    static int getServoPulse(uint8_t pin);
+
+    /**
+     * @brief Report output changes
+     * @param watcher Callback, nullptr to stop
+     */
+    static void setPinWatcher(NativePinWatcher watcher);
+
+    // Used by the Arduino layer
+
+    static void writePin(uint8_t pin, int level);
+    static int readPin(uint8_t pin);
+    static void setPinMode(uint8_t pin, int mode);
+    static void writePwm(uint8_t pin, int duty);
+    static int readAnalog(uint8_t pin);
+    static void writeServo(uint8_t pin, int pulse);
+    static void attachPinInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+    static void detachPinInterrupt(uint8_t interrupt);
+};
+
+#endif // NATIVE_HAL_H
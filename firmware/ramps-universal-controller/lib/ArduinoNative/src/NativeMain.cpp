@@ -0,0 +1,162 @@
+/**
+ * @file NativeMain.cpp
+ * @brief Entry point of host builds: runs setup() and loop() on the
+ * simulated board
+ *
+ * Options:
+ *   --pty               Serial on a new pseudo terminal (name on stderr)
+ *   --pty-link <path>   Also make a symlink to the pty
+ *   --realtime          Keep virtual time in step with the wall clock
+ *   --loop-us <us>      Virtual time per loop() pass (default 20)
+ *   --run-ms <ms>       Stop after this much virtual time
+ *   --linger-ms <ms>    Keep running after stdin ends (default 1000)
+ *   --adc <pin>=<value> Analog input reading, e.g. A13=977
+ *   --input <pin>=<0|1> Drive a digital input, e.g. 3=1
+ *   --trace <file>      Record every output change (see PinTrace.h)
+ *
+ * Without --pty the serial port is stdin/stdout, so a command script can
+ * be piped through the firmware. The run ends when the script has been
+ * read and the linger time has passed. Unless --realtime is given, virtual
+ * time waits for piped input, which makes runs reproducible.
+ */
+
+#include "Arduino.h"
+#include "NativeHal.h"
+#include "PinTrace.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @brief Parse a pin name (A0-A15 or a number)
+ */
+static int parsePin(const char* text) {
+    if (text[0] == 'A' || text[0] == 'a') {
+        return A0 + atoi(text + 1);
+    }
+    return atoi(text);
+}
+
+/**
+ * @brief Parse "<pin>=<value>"
+ */
+static bool parseAssignment(const char* text, int& pin, int& value) {
+    const char* equals = strchr(text, '=');
+    if (!equals) return false;
+    pin = parsePin(text);
+    value = atoi(equals + 1);
+    return pin >= 0 && pin < NATIVE_NUM_PINS;
+}
+
+/**
+ * @brief Open a raw pseudo terminal
+ * @param link Symlink to create (nullptr for none)
+ * @return Master file descriptor, -1 on error
+ */
+static int openPty(const char* link) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+        perror("pty");
+        return -1;
+    }
+
+    const char* name = ptsname(master);
+
+    // Hold the slave open so reads do not fail between host connections
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave >= 0) {
+        struct termios tio;
+        tcgetattr(slave, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    if (link) {
+        unlink(link);
+        if (symlink(name, link) < 0) perror("pty link");
+    }
+
+    fprintf(stderr, "PTY %s\n", name);
+    return master;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--pty] [--pty-link path] [--realtime] [--loop-us us] [--run-ms ms]\n"
+            "          [--linger-ms ms] [--adc pin=value]... [--input pin=level]...\n"
+            "          [--trace file]\n",
+            program);
+}
+
+int main(int argc, char** argv) {
+    bool pty = false;
+    const char* ptyLink = nullptr;
+    uint64_t loopNs = 20000;
+    uint64_t lingerNs = 1000000000ULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* next = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        int pin;
+        int value;
+
+        if (strcmp(arg, "--pty") == 0) {
+            pty = true;
+        } else if (strcmp(arg, "--pty-link") == 0 && next) {
+            pty = true;
+            ptyLink = argv[++i];
+        } else if (strcmp(arg, "--realtime") == 0) {
+            NativeHal::setRealtime(true);
+        } else if (strcmp(arg, "--loop-us") == 0 && next) {
+            loopNs = strtoull(argv[++i], nullptr, 10) * 1000ULL;
+        } else if (strcmp(arg, "--run-ms") == 0 && next) {
+            NativeHal::setRunLimit(strtoull(argv[++i], nullptr, 10) * 1000000ULL);
+        } else if (strcmp(arg, "--linger-ms") == 0 && next) {
+            lingerNs = strtoull(argv[++i], nullptr, 10) * 1000000ULL;
+        } else if (strcmp(arg, "--adc") == 0 && next && parseAssignment(argv[++i], pin, value)) {
+            NativeHal::setAnalog(pin, value);
+        } else if (strcmp(arg, "--input") == 0 && next && parseAssignment(argv[++i], pin, value)) {
+            NativeHal::setInput(pin, value);
+        } else if (strcmp(arg, "--trace") == 0 && next) {
+            if (!PinTrace::open(argv[++i])) return 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // A host that disconnects must not kill the simulation mid-write
+    signal(SIGPIPE, SIG_IGN);
+
+    int inFd = STDIN_FILENO;
+    int outFd = STDOUT_FILENO;
+    if (pty) {
+        inFd = outFd = openPty(ptyLink);
+        if (inFd < 0) return 1;
+    }
+
+    // Input starts once setup() is done, like a host that waits for the
+    // startup message. A piped script is read blocking unless the run is
+    // paced, so the same script always gives the same run.
+    Serial.connect(-1, outFd);
+    setup();
+    Serial.connect(inFd, outFd, !pty && !NativeHal::isRealtime());
+
+    uint64_t stopAt = 0;
+    while (true) {
+        loop();
+        NativeHal::advance(loopNs);
+
+        // After the script: let replies and moves finish, then stop
+        if (!pty && Serial.isInputDone()) {
+            if (stopAt == 0) {
+                stopAt = NativeHal::nanos() + lingerNs;
+            } else if (NativeHal::nanos() >= stopAt) {
+                Serial.flush();
+                NativeHal::exit(0);
+            }
+        }
+    }
+}
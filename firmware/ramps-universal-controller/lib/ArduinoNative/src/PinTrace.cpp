@@ -0,0 +1,61 @@
+/**
+ * @file PinTrace.cpp
+ * @brief Implementation of the output change trace
+ */
+
+#include "PinTrace.h"
+#include "NativeHal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace {
+
+FILE* traceFile = nullptr;
+uint64_t lastNanos = 0;
+
+}   // namespace
+
+bool PinTrace::open(const char* path) {
+    close();
+
+    traceFile = fopen(path, "wb");
+    if (!traceFile) {
+        perror("trace");
+        return false;
+    }
+
+    const uint8_t header[] = { 'P', 'T', 'R', 'C', PIN_TRACE_VERSION };
+    fwrite(header, 1, sizeof(header), traceFile);
+    lastNanos = 0;
+
+    NativeHal::setPinWatcher(record);
+    atexit(close);     // Runs end with exit() from the simulation
+    return true;
+}
+
+void PinTrace::record(uint8_t pin, int level, uint64_t nanos) {
+    if (!traceFile) return;
+
+    uint8_t buffer[12];
+    uint8_t length = 0;
+    uint64_t delta = nanos - lastNanos;
+    lastNanos = nanos;
+
+    do {
+        uint8_t b = delta & 0x7F;
+        delta >>= 7;
+        buffer[length++] = delta ? (b | 0x80) : b;
+    } while (delta);
+
+    buffer[length++] = pin;
+    buffer[length++] = (uint8_t)level;
+    fwrite(buffer, 1, length, traceFile);
+}
+
+void PinTrace::close() {
+    if (!traceFile) return;
+
+    NativeHal::setPinWatcher(nullptr);
+    fclose(traceFile);
+    traceFile = nullptr;
+}
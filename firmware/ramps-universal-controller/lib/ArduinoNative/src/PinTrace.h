@@ -0,0 +1,46 @@
+/**
+ * @file PinTrace.h
+ * @brief Record output pin changes of a host run to a trace file
+ *
+ * The file starts with the 4 byte magic "PTRC" and a version byte. Each
+ * change follows as the time since the previous one in nanoseconds
+ * (unsigned LEB128), the pin number and the new level (0/1, or the duty
+ * of a PWM write). Step pulses cost about five bytes per edge, so a long
+ * move stays small. tools/steptrace.py reads and analyses the file.
+ */
+
+#ifndef PIN_TRACE_H
+#define PIN_TRACE_H
+
+#include <stdint.h>
+
+#define PIN_TRACE_VERSION       1
+
+/**
+ * @class PinTrace
+ * @brief Writer of output change traces
+ */
+class PinTrace {
+public:
+    /**
+     * @brief Start recording every output change to a file
+     * @param path File to create
+     * @return true if the file was opened
+     */
+    static bool open(const char* path);
+
+    /**
+     * @brief Record a change (a NativePinWatcher)
+     * @param pin Pin number
+     * @param level New level or PWM duty
+     * @param nanos Virtual time of the change
+     */
+    static void record(uint8_t pin, int level, uint64_t nanos);
+
+    /**
+     * @brief Finish the file
+     */
+    static void close();
+};
+
+#endif // PIN_TRACE_H
@@ -0,0 +1,62 @@
+/**
+ * @file Servo.cpp
+ * @brief Implementation of the servo stand-in
+ */
+
+#include "Arduino.h"
+#include "Servo.h"
+#include "NativeHal.h"
+
+Servo::Servo() {
+    pin = -1;
+    minPulse = MIN_PULSE_WIDTH;
+    maxPulse = MAX_PULSE_WIDTH;
+    pulse = DEFAULT_PULSE_WIDTH;
+}
+
+uint8_t Servo::attach(int pin) {
+    return attach(pin, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+
+uint8_t Servo::attach(int servoPin, int min, int max) {
+    if (servoPin < 0 || servoPin >= NATIVE_NUM_PINS) return INVALID_SERVO;
+
+    pin = (int8_t)servoPin;
+    minPulse = min;
+    maxPulse = max;
+    pinMode(pin, OUTPUT);
+    NativeHal::writeServo(pin, pulse);
+    return 0;
+}
+
+void Servo::detach() {
+    if (pin < 0) return;
+    NativeHal::writeServo(pin, 0);
+    pin = -1;
+}
+
+void Servo::write(int value) {
+    // Values below the pulse range are angles, as in the Servo library
+    if (value < MIN_PULSE_WIDTH) {
+        value = constrain(value, 0, 180);
+        value = map(value, 0, 180, minPulse, maxPulse);
+    }
+    writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int value) {
+    pulse = constrain(value, minPulse, maxPulse);
+    if (pin >= 0) NativeHal::writeServo(pin, pulse);
+}
+
+int Servo::read() {
+    return map(readMicroseconds() + 1, minPulse, maxPulse, 0, 180);
+}
+
+int Servo::readMicroseconds() {
+    return pulse;
+}
+
+bool Servo::attached() {
+    return pin >= 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file Servo.h
+ * @brief Servo library stand-in for host builds
+ *
+ * Same interface as arduino-libraries/Servo; the pulse width is kept in
+ * the simulated board (NativeHal::getServoPulse()) instead of driving a
+ * timer.
+ */
+
+#ifndef ARDUINO_NATIVE_SERVO_H
+#define ARDUINO_NATIVE_SERVO_H
+
+#include <stdint.h>
+
+#define MIN_PULSE_WIDTH         544     // Pulse at 0 degrees (us)
+#define MAX_PULSE_WIDTH         2400    // Pulse at 180 degrees (us)
+#define DEFAULT_PULSE_WIDTH     1500    // Pulse when attached (us)
+#define INVALID_SERVO           255
+
+/**
+ * @class Servo
+ * @brief Simulated servo output
+ */
+class Servo {
+private:
+    int8_t pin;                 // -1 when detached
+    int minPulse;
+    int maxPulse;
+    int pulse;                  // Current pulse width (us)
+
+public:
+    Servo();
+
+    uint8_t attach(int pin);
+    uint8_t attach(int pin, int min, int max);
+    void detach();
+    void write(int value);
+    void writeMicroseconds(int value);
+    int read();
+    int readMicroseconds();
+    bool attached();
+};
+
+#endif // ARDUINO_NATIVE_SERVO_H
@@ -0,0 +1,208 @@
+/**
+ * @file WString.cpp
+ * @brief Implementation of String for host builds
+ */
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/**
+ * @brief Format an unsigned number in a base (2-36)
+ */
+static std::string formatUnsigned(unsigned long value, unsigned char base) {
+    if (base < 2 || base > 36) base = DEC;
+
+    char buffer[8 * sizeof(unsigned long) + 1];
+    char* p = buffer + sizeof(buffer);
+    *--p = '\0';
+    do {
+        unsigned digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    return std::string(p);
+}
+
+/**
+ * @brief Format a signed number like avr-libc ltoa (sign in base 10 only)
+ */
+static std::string formatSigned(long value, unsigned char base) {
+    if (base == DEC && value < 0) {
+        return "-" + formatUnsigned(0UL - (unsigned long)value, base);
+    }
+    return formatUnsigned((unsigned long)value, base);
+}
+
+/**
+ * @brief Format a float like dtostrf
+ */
+static std::string formatFloat(double value, unsigned char decimalPlaces) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimalPlaces, value);
+    return std::string(buffer);
+}
+
+String::String(const char* cstr) : text(cstr ? cstr : "") {}
+String::String(char c) : text(1, c) {}
+String::String(unsigned char value, unsigned char base) : text(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : text(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : text(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : text(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : text(formatUnsigned(value, base)) {}
+String::String(float value, unsigned char decimalPlaces) : text(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned char decimalPlaces) : text(formatFloat(value, decimalPlaces)) {}
+
+String& String::operator=(const char* cstr) {
+    text = cstr ? cstr : "";
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    text.reserve(size);
+    return true;
+}
+
+bool String::concat(const char* cstr) {
+    if (!cstr) return false;
+    text += cstr;
+    return true;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return text.size() == s.text.size() && strcasecmp(text.c_str(), s.text.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    if (offset > text.size() || prefix.text.size() > text.size() - offset) return false;
+    return text.compare(offset, prefix.text.size(), prefix.text) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.text.size() > text.size()) return false;
+    return text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < text.size() ? text[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if (index < text.size()) text[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= text.size()) {
+        dummy = 0;
+        return dummy;
+    }
+    return text[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!bufsize || !buf) return;
+    if (index >= text.size()) {
+        buf[0] = 0;
+        return;
+    }
+    unsigned int n = (unsigned int)text.size() - index;
+    if (n > bufsize - 1) n = bufsize - 1;
+    memcpy(buf, text.data() + index, n);
+    buf[n] = 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+    size_t pos = text.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& s, unsigned int fromIndex) const {
+    size_t pos = text.find(s.text, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = text.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& s) const {
+    size_t pos = text.rfind(s.text);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) {
+        unsigned int swap = beginIndex;
+        beginIndex = endIndex;
+        endIndex = swap;
+    }
+    if (beginIndex >= text.size()) return String();
+    if (endIndex > text.size()) endIndex = (unsigned int)text.size();
+    return String(text.substr(beginIndex, endIndex - beginIndex).c_str());
+}
+
+void String::replace(char find, char replacement) {
+    for (char& c : text) {
+        if (c == find) c = replacement;
+    }
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.text.empty()) return;
+    size_t pos = 0;
+    while ((pos = text.find(find.text, pos)) != std::string::npos) {
+        text.replace(pos, find.text.size(), replacement.text);
+        pos += replacement.text.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < text.size()) text.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < text.size()) text.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (char& c : text) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : text) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t begin = text.find_first_not_of(" \t\r\n\f\v");
+    if (begin == std::string::npos) {
+        text.clear();
+        return;
+    }
+    size_t end = text.find_last_not_of(" \t\r\n\f\v");
+    text = text.substr(begin, end - begin + 1);
+}
+
+long String::toInt() const { return atol(text.c_str()); }
+float String::toFloat() const { return (float)atof(text.c_str()); }
+double String::toDouble() const { return atof(text.c_str()); }
+
+String operator+(const String& lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, const char* rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const char* lhs, const String& rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, char rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned char rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, int rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned int rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, long rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, unsigned long rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, float rhs) { String s(lhs); s.concat(rhs); return s; }
+String operator+(const String& lhs, double rhs) { String s(lhs); s.concat(rhs); return s; }
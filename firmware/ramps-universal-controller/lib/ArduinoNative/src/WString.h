@@ -0,0 +1,127 @@
+/**
+ * @file WString.h
+ * @brief Arduino String for host builds
+ *
+ * Same interface and number formatting as the AVR core's String, stored
+ * in a std::string.
+ */
+
+#ifndef ARDUINO_NATIVE_WSTRING_H
+#define ARDUINO_NATIVE_WSTRING_H
+
+#include <stdint.h>
+#include <string>
+
+#define DEC                     10
+#define HEX                     16
+#define OCT                     8
+#define BIN                     2
+
+/**
+ * @class String
+ * @brief Heap string with Arduino semantics
+ */
+class String {
+private:
+    std::string text;
+
+public:
+    String(const char* cstr = "");
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = DEC);
+    explicit String(int value, unsigned char base = DEC);
+    explicit String(unsigned int value, unsigned char base = DEC);
+    explicit String(long value, unsigned char base = DEC);
+    explicit String(unsigned long value, unsigned char base = DEC);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* cstr);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return (unsigned int)text.size(); }
+    const char* c_str() const { return text.c_str(); }
+
+    // Concatenation
+    bool concat(const String& s) { text += s.text; return true; }
+    bool concat(const char* cstr);
+    bool concat(char c) { text += c; return true; }
+    bool concat(unsigned char value) { return concat(String(value)); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) { concat(value); return *this; }
+
+    // Comparison
+    int compareTo(const String& s) const { return text.compare(s.text); }
+    bool equals(const String& s) const { return text == s.text; }
+    bool equals(const char* cstr) const { return text == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String& s) const;
+    bool startsWith(const String& prefix) const;
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& s) const { return compareTo(s) < 0; }
+    bool operator>(const String& s) const { return compareTo(s) > 0; }
+    bool operator<=(const String& s) const { return compareTo(s) <= 0; }
+    bool operator>=(const String& s) const { return compareTo(s) >= 0; }
+
+    // Characters
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+    void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const {
+        getBytes((unsigned char*)buf, bufsize, index);
+    }
+
+    // Search
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String& s, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& s) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    // Modification
+    void replace(char find, char replacement);
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    // Conversion
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, unsigned char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+String operator+(const String& lhs, float rhs);
+String operator+(const String& lhs, double rhs);
+
+#endif // ARDUINO_NATIVE_WSTRING_H
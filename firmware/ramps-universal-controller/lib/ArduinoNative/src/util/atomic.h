@@ -0,0 +1,20 @@
+/**
+ * @file atomic.h
+ * @brief avr-libc ATOMIC_BLOCK for host builds
+ *
+ * Simulated interrupts only run between firmware statements that advance
+ * virtual time, so the block just runs its body once.
+ */
+
+#ifndef ARDUINO_NATIVE_UTIL_ATOMIC_H
+#define ARDUINO_NATIVE_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          1
+#define NONATOMIC_RESTORESTATE  0
+#define NONATOMIC_FORCEOFF      1
+
+#define ATOMIC_BLOCK(type)      for (int atomicOnce_ = 1; atomicOnce_; atomicOnce_ = 0)
+#define NONATOMIC_BLOCK(type)   for (int atomicOnce_ = 1; atomicOnce_; atomicOnce_ = 0)
+
+#endif // ARDUINO_NATIVE_UTIL_ATOMIC_H
@@ -0,0 +1,139 @@
+/**
+ * @file HeaterLoop.cpp
+ * @brief Implementation of HeaterLoop class
+ */
+
+#include "HeaterLoop.h"
+#include "../devices/sensors/AnalogSensor.h"
+#include "../devices/actuators/MosfetOutput.h"
+
+/**
+ * @brief Constructor
+ */
+HeaterLoop::HeaterLoop() {
+    sensor = nullptr;
+    output = nullptr;
+    target = 0.0;
+    maxPower = 1.0;
+    duty = 0.0;
+    lastUpdate = 0;
+    tuning = false;
+}
+
+/**
+ * @brief Bind sensor and heater
+ */
+void HeaterLoop::attach(AnalogSensor* tempSensor, MosfetOutput* heater, float power) {
+    sensor = tempSensor;
+    output = heater;
+    maxPower = constrain(power, 0.0, 1.0);
+    pid.setOutputLimits(0.0, maxPower);
+}
+
+/**
+ * @brief Set target temperature
+ */
+bool HeaterLoop::setTarget(float temperature) {
+    if (!isAttached() || temperature < 0.0 || temperature > HEATER_MAX_TEMP) {
+        return false;
+    }
+
+    if (target == 0.0 && temperature > 0.0) {
+        pid.reset();    // Fresh start, no stale derivative
+    }
+    autotune.abort();
+    target = temperature;
+    if (target == 0.0) {
+        disable();
+    }
+    return true;
+}
+
+/**
+ * @brief Stop regulating and autotuning, heater off
+ */
+void HeaterLoop::disable() {
+    target = 0.0;
+    autotune.abort();
+    duty = 0.0;
+    protection.reset();
+    if (output) {
+        output->stop();
+    }
+}
+
+/**
+ * @brief Start relay autotune around a temperature
+ */
+bool HeaterLoop::startAutotune(float temperature) {
+    if (!isAttached() || temperature <= 0.0 || temperature > HEATER_MAX_TEMP) {
+        return false;
+    }
+
+    target = 0.0;
+    autotune.begin(temperature, maxPower);
+    tuning = true;
+    lastUpdate = millis();
+    return true;
+}
+
+/**
+ * @brief Run one control period when due
+ */
+bool HeaterLoop::update(unsigned long now) {
+    if (!isAttached()) return false;
+
+    // A run aborted by a command is reported here too
+    bool finished = false;
+    if (tuning && !autotune.isActive()) {
+        tuning = false;
+        finished = true;
+    }
+
+    if (now - lastUpdate < HEATER_CONTROL_INTERVAL) {
+        return finished;
+    }
+
+    // Fixed grid keeps dt constant; restart it after a stall
+    if (now - lastUpdate >= 2 * HEATER_CONTROL_INTERVAL) {
+        lastUpdate = now;
+    } else {
+        lastUpdate += HEATER_CONTROL_INTERVAL;
+    }
+
+    float temperature = sensor->getValue();
+
+    // Watch the pair even when the output is driven manually
+    float controlTarget = autotune.isActive() ? autotune.getSetpoint() : target;
+    if (protection.check(temperature, controlTarget, output->getPosition(), now) != ThermalFault::NONE) {
+        target = 0.0;
+        autotune.abort();
+        duty = 0.0;
+        output->stop();
+        return finished;
+    }
+
+    if (!autotune.isActive() && target == 0.0) {
+        return finished;    // Off: leave the output to manual commands
+    }
+
+    if (autotune.isActive()) {
+        duty = autotune.update(temperature, now);
+        if (!autotune.isActive()) {
+            // Apply tuned gains; the heater stays off until a new setpoint
+            if (autotune.getState() == AutotuneState::DONE) {
+                pid.setGains(autotune.getKp(), autotune.getKi(), autotune.getKd());
+            }
+            duty = 0.0;
+            tuning = false;
+            finished = true;
+        }
+    } else if (temperature < THERMAL_MIN_TEMP || temperature > THERMAL_MAX_TEMP) {
+        duty = 0.0;     // Bad reading; protection trips if it persists
+    } else {
+        duty = pid.compute(target, temperature, HEATER_CONTROL_INTERVAL / 1000.0);
+    }
+
+    output->setPosition(duty);
+    return finished;
+}
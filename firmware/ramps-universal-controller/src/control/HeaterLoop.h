@@ -0,0 +1,120 @@
+/**
+ * @file HeaterLoop.h
+ * @brief Closed-loop temperature control of a MOSFET heater
+ *
+ * Binds an AnalogSensor (thermistor) to a MosfetOutput and regulates the
+ * output duty with a PID every HEATER_CONTROL_INTERVAL ms. The same loop
+ * runs the relay autotune and applies its gains when it finishes, and
+ * checks the pair for thermal faults, including while under manual control.
+ */
+
+#ifndef HEATER_LOOP_H
+#define HEATER_LOOP_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "PidController.h"
+#include "RelayAutotune.h"
+#include "ThermalProtection.h"
+
+// Forward declarations
+class AnalogSensor;
+class MosfetOutput;
+
+/**
+ * @class HeaterLoop
+ * @brief PID temperature loop for one sensor/heater pair
+ */
+class HeaterLoop {
+private:
+    AnalogSensor* sensor;
+    MosfetOutput* output;
+    PidController pid;
+    RelayAutotune autotune;
+    ThermalProtection protection;
+    float target;               // Setpoint (°C), 0 = off
+    float maxPower;             // Highest duty the loop may apply
+    float duty;                 // Duty applied by the last update
+    unsigned long lastUpdate;   // Scheduled time of the last update
+    bool tuning;                // Autotune result not yet reported
+
+public:
+    /**
+     * @brief Constructor
+     */
+    HeaterLoop();
+
+    /**
+     * @brief Bind sensor and heater
+     * @param tempSensor Thermistor input
+     * @param heater Heater output
+     * @param power Highest duty (0.0-1.0)
+     */
+    void attach(AnalogSensor* tempSensor, MosfetOutput* heater, float power = 1.0);
+
+    /**
+     * @brief Check if the loop is bound
+     * @return true if sensor and output are set
+     */
+    bool isAttached() const { return sensor && output; }
+
+    /**
+     * @brief Set target temperature
+     * @param temperature Setpoint (°C, 0 turns the heater off)
+     * @return false if above HEATER_MAX_TEMP or negative
+     */
+    bool setTarget(float temperature);
+
+    /**
+     * @brief Get target temperature
+     * @return Setpoint (°C)
+     */
+    float getTarget() const { return target; }
+
+    /**
+     * @brief Get applied duty
+     * @return Duty cycle (0.0-1.0)
+     */
+    float getDuty() const { return duty; }
+
+    /**
+     * @brief Stop regulating and autotuning, heater off, fault cleared
+     */
+    void disable();
+
+    /**
+     * @brief Start relay autotune around a temperature
+     * @param temperature Setpoint to oscillate around
+     * @return false if out of range
+     */
+    bool startAutotune(float temperature);
+
+    /**
+     * @brief Run one control period when due
+     * @param now Current millis()
+     * @return true once when an autotune run has ended (DONE, or FAILED
+     *         including runs aborted by disable() or a new setpoint)
+     */
+    bool update(unsigned long now);
+
+    /**
+     * @brief Get the PID controller (gains)
+     */
+    PidController& getPid() { return pid; }
+
+    /**
+     * @brief Get the autotune state and results
+     */
+    const RelayAutotune& getAutotune() const { return autotune; }
+
+    /**
+     * @brief Get the thermal fault that shut the heater down
+     * @return Fault (NONE if healthy)
+     */
+    ThermalFault getFault() const { return protection.getFault(); }
+
+    AnalogSensor* getSensor() const { return sensor; }
+    MosfetOutput* getOutput() const { return output; }
+};
+
+#endif // HEATER_LOOP_H
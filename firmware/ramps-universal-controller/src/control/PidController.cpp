@@ -0,0 +1,72 @@
+/**
+ * @file PidController.cpp
+ * @brief Implementation of PidController class
+ */
+
+#include "PidController.h"
+
+/**
+ * @brief Constructor
+ */
+PidController::PidController() {
+    kp = 0.0;
+    ki = 0.0;
+    kd = 0.0;
+    outMin = 0.0;
+    outMax = 1.0;
+    reset();
+}
+
+/**
+ * @brief Set gains
+ */
+void PidController::setGains(float p, float i, float d) {
+    kp = p;
+    ki = i;
+    kd = d;
+}
+
+/**
+ * @brief Set output range
+ */
+void PidController::setOutputLimits(float min, float max) {
+    outMin = min;
+    outMax = max;
+    integral = constrain(integral, outMin, outMax);
+}
+
+/**
+ * @brief Clear integral and derivative history
+ */
+void PidController::reset() {
+    integral = 0.0;
+    lastInput = 0.0;
+    primed = false;
+}
+
+/**
+ * @brief Compute the output for one control period
+ */
+float PidController::compute(float setpoint, float input, float dt) {
+    if (dt <= 0.0) return constrain(integral, outMin, outMax);
+
+    float error = setpoint - input;
+
+    // Derivative on measurement: no kick when the setpoint changes
+    float derivative = primed ? (input - lastInput) / dt : 0.0;
+    lastInput = input;
+    primed = true;
+
+    float p = kp * error;
+    float d = -kd * derivative;
+
+    // Integrate unless the output is already saturated in the error's direction
+    float candidate = integral + ki * error * dt;
+    float output = p + candidate + d;
+    if (!((output > outMax && error > 0.0) || (output < outMin && error < 0.0))) {
+        integral = candidate;
+    }
+    integral = constrain(integral, outMin, outMax);
+
+    return constrain(p + integral + d, outMin, outMax);
+}
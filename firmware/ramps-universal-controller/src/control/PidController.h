@@ -0,0 +1,77 @@
+/**
+ * @file PidController.h
+ * @brief Discrete PID controller with anti-windup
+ *
+ * The derivative acts on the measurement rather than the error, so a
+ * setpoint change does not kick the output. The integral term is held
+ * while the output saturates in the direction of the error and is
+ * clamped to the output range, so it cannot wind up during warm-up.
+ */
+
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <Arduino.h>
+
+/**
+ * @class PidController
+ * @brief PID with derivative on measurement and conditional integration
+ */
+class PidController {
+private:
+    float kp;                   // Proportional gain (output per unit error)
+    float ki;                   // Integral gain (output per unit error per second)
+    float kd;                   // Derivative gain (output per unit/second)
+    float outMin;
+    float outMax;
+    float integral;             // Integral term in output units
+    float lastInput;            // Measurement of the previous update
+    bool primed;                // lastInput is valid
+
+public:
+    /**
+     * @brief Constructor
+     */
+    PidController();
+
+    /**
+     * @brief Set gains
+     * @param p Proportional gain
+     * @param i Integral gain (per second)
+     * @param d Derivative gain (seconds)
+     */
+    void setGains(float p, float i, float d);
+
+    /**
+     * @brief Set output range
+     * @param min Lowest output
+     * @param max Highest output
+     */
+    void setOutputLimits(float min, float max);
+
+    /**
+     * @brief Clear integral and derivative history
+     */
+    void reset();
+
+    /**
+     * @brief Compute the output for one control period
+     * @param setpoint Target value
+     * @param input Measured value
+     * @param dt Time since the previous update (seconds)
+     * @return Output within the output limits
+     */
+    float compute(float setpoint, float input, float dt);
+
+    float getKp() const { return kp; }
+    float getKi() const { return ki; }
+    float getKd() const { return kd; }
+
+    /**
+     * @brief Get integral term
+     * @return Integral contribution to the output
+     */
+    float getIntegral() const { return integral; }
+};
+
+#endif // PID_CONTROLLER_H
@@ -0,0 +1,101 @@
+/**
+ * @file RelayAutotune.cpp
+ * @brief Implementation of RelayAutotune class
+ */
+
+#include "RelayAutotune.h"
+
+/**
+ * @brief Constructor
+ */
+RelayAutotune::RelayAutotune() {
+    state = AutotuneState::IDLE;
+    setpoint = 0.0;
+    power = 0.0;
+    startTime = 0;
+    cycleStart = 0;
+    period = 0;
+    peakHigh = 0.0;
+    peakLow = 0.0;
+    cycles = 0;
+    kp = 0.0;
+    ki = 0.0;
+    kd = 0.0;
+}
+
+/**
+ * @brief Start autotuning
+ */
+void RelayAutotune::begin(float target, float outputHigh) {
+    setpoint = target;
+    power = outputHigh;
+    startTime = millis();
+    cycleStart = startTime;
+    period = 0;
+    peakHigh = -1000.0;
+    peakLow = 1000.0;
+    cycles = 0;
+    state = AutotuneState::HEATING;
+}
+
+/**
+ * @brief Advance with a new measurement
+ */
+float RelayAutotune::update(float input, unsigned long now) {
+    if (!isActive()) return 0.0;
+
+    if (input > setpoint + AUTOTUNE_MAX_OVERSHOOT || input < -100.0 ||
+        now - startTime > AUTOTUNE_TIMEOUT_MS) {
+        abort();
+        return 0.0;
+    }
+
+    if (state == AutotuneState::HEATING) {
+        // Undershoot after the relay switches on
+        if (input < peakLow) peakLow = input;
+
+        if (input > setpoint + AUTOTUNE_HYSTERESIS) {
+            state = AutotuneState::COOLING;
+
+            // The first two cycles include the warm-up from ambient
+            if (cycles >= 2) {
+                float amplitude = (peakHigh - peakLow) / 2.0;
+                if (amplitude > 0.0 && period > 0) {
+                    float ku = 4.0 * (power / 2.0) / (PI * amplitude);
+                    float pu = period / 1000.0;
+                    kp = 0.6 * ku;
+                    ki = 1.2 * ku / pu;
+                    kd = 0.075 * ku * pu;
+                }
+            }
+            if (cycles > AUTOTUNE_CYCLES) {
+                state = (kp > 0.0) ? AutotuneState::DONE : AutotuneState::FAILED;
+                return 0.0;
+            }
+            peakHigh = input;
+        }
+    } else {
+        // Overshoot after the relay switches off
+        if (input > peakHigh) peakHigh = input;
+
+        if (input < setpoint - AUTOTUNE_HYSTERESIS) {
+            // One full oscillation: heating start to heating start
+            state = AutotuneState::HEATING;
+            period = now - cycleStart;
+            cycleStart = now;
+            cycles++;
+            peakLow = input;
+        }
+    }
+
+    return (state == AutotuneState::HEATING) ? power : 0.0;
+}
+
+/**
+ * @brief Stop and fail the run
+ */
+void RelayAutotune::abort() {
+    if (isActive()) {
+        state = AutotuneState::FAILED;
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file RelayAutotune.h
+ * @brief Relay (Astrom-Hagglund) autotuning of a heater loop
+ *
+ * The heater is switched between full and zero power around the
+ * setpoint, which makes the temperature oscillate. The oscillation
+ * period Pu and amplitude a give the ultimate gain Ku = 4d / (pi a)
+ * for relay amplitude d, and Ziegler-Nichols rules give PID gains.
+ */
+
+#ifndef RELAY_AUTOTUNE_H
+#define RELAY_AUTOTUNE_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+/**
+ * @enum AutotuneState
+ * @brief Progress of an autotune run
+ */
+enum class AutotuneState {
+    IDLE,           // Not running
+    HEATING,        // Relay on, waiting to pass setpoint + hysteresis
+    COOLING,        // Relay off, waiting to fall below setpoint - hysteresis
+    DONE,           // Gains available
+    FAILED          // Overshoot, timeout or sensor fault
+};
+
+/**
+ * @class RelayAutotune
+ * @brief Relay oscillation and gain calculation
+ */
+class RelayAutotune {
+private:
+    AutotuneState state;
+    float setpoint;
+    float power;                // Relay output while heating
+    unsigned long startTime;
+    unsigned long cycleStart;   // Start of the current heating half-cycle
+    unsigned long period;       // Last full oscillation (ms)
+    float peakHigh;             // Highest temperature of the current cycle
+    float peakLow;              // Lowest temperature of the current cycle
+    uint8_t cycles;             // Completed oscillations
+    float kp;
+    float ki;
+    float kd;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    RelayAutotune();
+
+    /**
+     * @brief Start autotuning
+     * @param target Temperature to oscillate around
+     * @param outputHigh Relay output while heating (0.0-1.0)
+     */
+    void begin(float target, float outputHigh);
+
+    /**
+     * @brief Advance with a new measurement
+     * @param input Measured temperature
+     * @param now Current millis()
+     * @return Output to apply
+     */
+    float update(float input, unsigned long now);
+
+    /**
+     * @brief Stop and fail the run
+     */
+    void abort();
+
+    AutotuneState getState() const { return state; }
+
+    /**
+     * @brief Get the temperature the run oscillates around
+     */
+    float getSetpoint() const { return setpoint; }
+
+    /**
+     * @brief Check if a run is in progress
+     * @return true while heating or cooling
+     */
+    bool isActive() const { return state == AutotuneState::HEATING || state == AutotuneState::COOLING; }
+
+    float getKp() const { return kp; }
+    float getKi() const { return ki; }
+    float getKd() const { return kd; }
+};
+
+#endif // RELAY_AUTOTUNE_H
@@ -0,0 +1,71 @@
+/**
+ * @file ThermalPlant.h
+ * @brief Two-node thermal model of a heater for host simulation
+ *
+ * Not used by the firmware itself: test/native/test_thermal_plant.cpp
+ * drives a HeaterLoop against this model instead of a real heater block
+ * to exercise PID gains and autotuning without hardware. The heater
+ * cartridge and the sensor are separate thermal masses, which gives the
+ * lag a relay autotune needs to oscillate.
+ *
+ *   Ch dTh/dt = P * duty - k (Th - Ts)
+ *   Cs dTs/dt = k (Th - Ts) - h (Ts - Ta)
+ */
+
+#ifndef THERMAL_PLANT_H
+#define THERMAL_PLANT_H
+
+/**
+ * @class ThermalPlant
+ * @brief Heater and sensor temperatures under a duty cycle
+ */
+class ThermalPlant {
+private:
+    float power;                // Heater power at full duty (W)
+    float heaterCapacity;       // Heater heat capacity (J/K)
+    float sensorCapacity;       // Block/sensor heat capacity (J/K)
+    float coupling;             // Heater to sensor conductance (W/K)
+    float loss;                 // Sensor to ambient conductance (W/K)
+    float ambient;              // Ambient temperature (°C)
+    float heater;               // Heater temperature (°C)
+    float sensor;               // Sensor temperature (°C)
+
+public:
+    /**
+     * @brief Constructor (defaults resemble a 40 W hotend)
+     */
+    ThermalPlant(float watts = 40.0, float heaterJK = 4.0, float sensorJK = 8.0,
+                 float couplingWK = 0.6, float lossWK = 0.15, float ambientC = 25.0)
+        : power(watts), heaterCapacity(heaterJK), sensorCapacity(sensorJK),
+          coupling(couplingWK), loss(lossWK), ambient(ambientC),
+          heater(ambientC), sensor(ambientC) {}
+
+    /**
+     * @brief Advance the model
+     * @param duty Heater duty cycle (0.0-1.0)
+     * @param dt Time step (seconds); integrated in steps of at most 10 ms
+     */
+    void step(float duty, float dt) {
+        while (dt > 0.0f) {
+            float h = (dt > 0.01f) ? 0.01f : dt;
+            float flow = coupling * (heater - sensor);
+            heater += h * (power * duty - flow) / heaterCapacity;
+            sensor += h * (flow - loss * (sensor - ambient)) / sensorCapacity;
+            dt -= h;
+        }
+    }
+
+    /**
+     * @brief Get sensor temperature
+     * @return Temperature seen by the thermistor (°C)
+     */
+    float getTemperature() const { return sensor; }
+
+    /**
+     * @brief Get heater temperature
+     * @return Heater cartridge temperature (°C)
+     */
+    float getHeaterTemperature() const { return heater; }
+};
+
+#endif // THERMAL_PLANT_H
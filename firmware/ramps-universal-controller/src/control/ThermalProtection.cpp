@@ -0,0 +1,96 @@
+/**
+ * @file ThermalProtection.cpp
+ * @brief Implementation of ThermalProtection class
+ */
+
+#include "ThermalProtection.h"
+
+/**
+ * @brief Constructor
+ */
+ThermalProtection::ThermalProtection() {
+    reset();
+}
+
+/**
+ * @brief Clear a latched fault and disarm the checks
+ */
+void ThermalProtection::reset() {
+    fault = ThermalFault::NONE;
+    limitErrors = 0;
+    watchTarget = 0.0;
+    reached = false;
+    watchTemperature = 0.0;
+    watchStart = 0;
+    dropping = false;
+    dropStart = 0;
+}
+
+/**
+ * @brief Check one control period
+ */
+ThermalFault ThermalProtection::check(float temperature, float target, float power, unsigned long now) {
+    if (fault != ThermalFault::NONE) return fault;
+
+    bool heating = target > 0.0 || power > 0.0;
+
+    // Limits, filtered over a few periods against single bad samples
+    if (heating && (temperature < THERMAL_MIN_TEMP || temperature > THERMAL_MAX_TEMP)) {
+        if (++limitErrors >= THERMAL_FAULT_COUNT) {
+            fault = (temperature < THERMAL_MIN_TEMP) ? ThermalFault::SENSOR : ThermalFault::OVERTEMP;
+        }
+        return fault;
+    }
+    limitErrors = 0;
+
+    // A new target re-arms the heating and drop checks
+    if (target != watchTarget) {
+        watchTarget = target;
+        reached = false;
+        watchTemperature = temperature;
+        watchStart = now;
+        dropping = false;
+    }
+    if (target <= 0.0) return fault;
+
+    if (!reached) {
+        if (temperature >= target - THERMAL_HYSTERESIS) {
+            reached = true;
+        } else if (now - watchStart >= THERMAL_WATCH_PERIOD_MS) {
+            if (temperature < watchTemperature + THERMAL_WATCH_RISE) {
+                fault = ThermalFault::HEATING;
+            } else {
+                // Rising as expected; open the next window from here
+                watchTemperature = temperature;
+                watchStart = now;
+            }
+        }
+        return fault;
+    }
+
+    if (temperature < target - THERMAL_RUNAWAY_BAND) {
+        if (!dropping) {
+            dropping = true;
+            dropStart = now;
+        } else if (now - dropStart >= THERMAL_RUNAWAY_PERIOD_MS) {
+            fault = ThermalFault::DROP;
+        }
+    } else {
+        dropping = false;
+    }
+    return fault;
+}
+
+/**
+ * @brief Get name of a fault
+ */
+const char* ThermalProtection::getFaultName(ThermalFault f) {
+    switch (f) {
+        case ThermalFault::NONE:     return "NONE";
+        case ThermalFault::SENSOR:   return "SENSOR";
+        case ThermalFault::OVERTEMP: return "OVERTEMP";
+        case ThermalFault::HEATING:  return "HEATING";
+        case ThermalFault::DROP:     return "DROP";
+        default:                     return "UNKNOWN";
+    }
+}
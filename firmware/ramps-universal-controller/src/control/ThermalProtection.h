@@ -0,0 +1,88 @@
+/**
+ * @file ThermalProtection.h
+ * @brief Thermal runaway and sensor fault detection for a heater
+ *
+ * Checked once per heater control period. A fault is latched until
+ * reset() and the controller answers it with an emergency stop, so the
+ * reaction time is bounded by the check that detects it:
+ *
+ *   SENSOR    THERMAL_FAULT_COUNT periods of a reading below
+ *             THERMAL_MIN_TEMP (open/shorted thermistor reads -999)
+ *   OVERTEMP  THERMAL_FAULT_COUNT periods above THERMAL_MAX_TEMP
+ *   HEATING   no THERMAL_WATCH_RISE gain within THERMAL_WATCH_PERIOD_MS
+ *             while heating towards the target
+ *   DROP      more than THERMAL_RUNAWAY_BAND below a reached target for
+ *             THERMAL_RUNAWAY_PERIOD_MS
+ *
+ * Sensor and temperature limits apply whenever the output is powered,
+ * including manual control; the HEATING and DROP checks need a target.
+ */
+
+#ifndef THERMAL_PROTECTION_H
+#define THERMAL_PROTECTION_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+/**
+ * @enum ThermalFault
+ * @brief Reason a heater was shut down
+ */
+enum class ThermalFault : uint8_t {
+    NONE,
+    SENSOR,         // Open or shorted thermistor
+    OVERTEMP,       // Above the absolute limit
+    HEATING,        // Not rising under power (heater or sensor detached)
+    DROP            // Fell away from a reached target
+};
+
+/**
+ * @class ThermalProtection
+ * @brief Watchdog of one sensor/heater pair
+ */
+class ThermalProtection {
+private:
+    ThermalFault fault;
+    uint8_t limitErrors;        // Consecutive readings outside the limits
+    float watchTarget;          // Target the checks are armed for
+    bool reached;               // Target reached since it was set
+    float watchTemperature;     // Temperature at the start of the heating window
+    unsigned long watchStart;   // Start of the heating window
+    bool dropping;              // Below the runaway band
+    unsigned long dropStart;    // When the temperature left the band
+
+public:
+    /**
+     * @brief Constructor
+     */
+    ThermalProtection();
+
+    /**
+     * @brief Clear a latched fault and disarm the checks
+     */
+    void reset();
+
+    /**
+     * @brief Check one control period
+     * @param temperature Sensor reading (°C)
+     * @param target Regulated temperature (°C, 0 if none)
+     * @param power Output duty (0.0-1.0)
+     * @param now Current millis()
+     * @return Latched fault (NONE if healthy)
+     */
+    ThermalFault check(float temperature, float target, float power, unsigned long now);
+
+    /**
+     * @brief Get latched fault
+     */
+    ThermalFault getFault() const { return fault; }
+
+    /**
+     * @brief Get name of a fault
+     * @param f Fault
+     * @return Fault name
+     */
+    static const char* getFaultName(ThermalFault f);
+};
+
+#endif // THERMAL_PROTECTION_H
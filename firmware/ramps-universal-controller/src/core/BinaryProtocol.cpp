@@ -0,0 +1,198 @@
+/**
+ * @file BinaryProtocol.cpp
+ * @brief Implementation of BinaryProtocol class
+ */
+
+#include "BinaryProtocol.h"
+#include "DeviceConfig.h"
+
+// CRC-16/CCITT-FALSE, one nibble at a time
+static const uint16_t CRC16_NIBBLE[16] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE
+ */
+uint16_t BinaryProtocol::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc << 4) ^ pgm_read_word(&CRC16_NIBBLE[((crc >> 12) ^ (data[i] >> 4)) & 0x0F]);
+        crc = (crc << 4) ^ pgm_read_word(&CRC16_NIBBLE[((crc >> 12) ^ data[i]) & 0x0F]);
+    }
+    return crc;
+}
+
+/**
+ * @brief COBS encode a packet
+ */
+size_t BinaryProtocol::cobsEncode(const uint8_t* input, size_t length, uint8_t* output) {
+    size_t codeIndex = 0;   // Where the current block's code byte goes
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++) {
+        if (input[i] == 0) {
+            output[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        } else {
+            output[out++] = input[i];
+            code++;
+        }
+    }
+    output[codeIndex] = code;
+
+    return out;
+}
+
+/**
+ * @brief COBS decode a frame in place
+ */
+size_t BinaryProtocol::cobsDecode(uint8_t* buffer, size_t length) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < length) {
+        uint8_t code = buffer[in++];
+        if (code == 0 || in + code - 1 > length) {
+            return 0;   // Stray delimiter or block runs past the frame
+        }
+
+        for (uint8_t i = 1; i < code; i++) {
+            buffer[out++] = buffer[in++];
+        }
+
+        // Each block but the last stands for a zero byte
+        if (code < 0xFF && in < length) {
+            buffer[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief Decode a received frame and check its CRC
+ */
+bool BinaryProtocol::decodeFrame(uint8_t* buffer, size_t length, BinaryPacket& packet) {
+    size_t packetLength = cobsDecode(buffer, length);
+    if (packetLength < BINARY_HEADER_SIZE + BINARY_CRC_SIZE) {
+        return false;
+    }
+
+    size_t dataLength = packetLength - BINARY_CRC_SIZE;
+    uint16_t received = buffer[dataLength] | ((uint16_t)buffer[dataLength + 1] << 8);
+    if (crc16(buffer, dataLength) != received) {
+        return false;
+    }
+
+    packet.seq = buffer[0];
+    packet.deviceId = buffer[1];
+    packet.opcode = buffer[2];
+    packet.payload = buffer + BINARY_HEADER_SIZE;
+    packet.payloadLength = dataLength - BINARY_HEADER_SIZE;
+    return true;
+}
+
+/**
+ * @brief Build a frame
+ */
+size_t BinaryProtocol::encodeFrame(uint8_t seq, uint8_t deviceId, BinaryOpcode opcode,
+                                   const uint8_t* payload, uint8_t payloadLength, uint8_t* frame) {
+    if (payloadLength > BINARY_MAX_PAYLOAD) {
+        payloadLength = BINARY_MAX_PAYLOAD;
+    }
+
+    uint8_t packet[BINARY_MAX_PACKET];
+    packet[0] = seq;
+    packet[1] = deviceId;
+    packet[2] = (uint8_t)opcode;
+    memcpy(packet + BINARY_HEADER_SIZE, payload, payloadLength);
+
+    size_t dataLength = BINARY_HEADER_SIZE + payloadLength;
+    uint16_t crc = crc16(packet, dataLength);
+    packet[dataLength] = (uint8_t)crc;
+    packet[dataLength + 1] = (uint8_t)(crc >> 8);
+
+    size_t length = cobsEncode(packet, dataLength + BINARY_CRC_SIZE, frame);
+    frame[length++] = 0;    // Frame delimiter
+    return length;
+}
+
+/**
+ * @brief Fill a command from a request packet
+ */
+bool BinaryProtocol::toCommand(const BinaryPacket& packet, const char* deviceName, Command& cmd) {
+    CommandType type;
+    const char* iface;
+    bool query = false;
+    uint8_t minValues = 0;
+    uint8_t maxValues = 0;
+
+    switch ((BinaryOpcode)packet.opcode) {
+        case BinaryOpcode::SET_POSITION:     type = CommandType::POSITION; iface = "position"; minValues = maxValues = 1; break;
+        case BinaryOpcode::SET_VELOCITY:     type = CommandType::VELOCITY; iface = "velocity"; minValues = maxValues = 1; break;
+        case BinaryOpcode::SET_ACCELERATION: type = CommandType::CONFIG; iface = "acceleration"; minValues = maxValues = 1; break;
+        case BinaryOpcode::SET_JERK:         type = CommandType::CONFIG; iface = "jerk"; minValues = maxValues = 1; break;
+        case BinaryOpcode::ON:               type = CommandType::ON; iface = "on"; break;
+        case BinaryOpcode::OFF:              type = CommandType::OFF; iface = "off"; break;
+        case BinaryOpcode::STOP:             type = CommandType::STOP; iface = "stop"; break;
+        case BinaryOpcode::ENABLE:           type = CommandType::ENABLE; iface = "enable"; break;
+        case BinaryOpcode::DISABLE:          type = CommandType::DISABLE; iface = "disable"; break;
+        case BinaryOpcode::ZERO:             type = CommandType::RESET; iface = "zero"; break;
+        case BinaryOpcode::GET_POSITION:     type = CommandType::POSITION; iface = "position"; query = true; break;
+        case BinaryOpcode::GET_VELOCITY:     type = CommandType::VELOCITY; iface = "velocity"; query = true; break;
+        case BinaryOpcode::READ:             type = CommandType::GET; iface = "read"; query = true; break;
+        case BinaryOpcode::GET_STATE:        type = CommandType::STATE; iface = "state"; query = true; break;
+        case BinaryOpcode::SUBSCRIBE:        type = CommandType::SUBSCRIBE; iface = "subscribe"; maxValues = 1; break;
+        case BinaryOpcode::UNSUBSCRIBE:      type = CommandType::UNSUBSCRIBE; iface = "unsubscribe"; break;
+        case BinaryOpcode::MOVE:             type = CommandType::MOVE; iface = "move"; minValues = 1; maxValues = COMMAND_MAX_PARAMS; break;
+        case BinaryOpcode::GET_QUEUE:        type = CommandType::QUEUE; iface = "queue"; query = true; break;
+        case BinaryOpcode::PING:             type = CommandType::CMD_PING; iface = "ping"; break;
+        case BinaryOpcode::ESTOP:            type = CommandType::ESTOP; iface = "estop"; break;
+        case BinaryOpcode::RESET:            type = CommandType::RESET; iface = "reset"; break;
+        case BinaryOpcode::GET_WINDOW:       type = CommandType::WINDOW; iface = "window"; query = true; break;
+        default:
+            return false;
+    }
+
+    uint8_t count = packet.payloadLength / 4;
+    if (packet.payloadLength % 4 != 0 || count < minValues || count > maxValues) {
+        return false;
+    }
+
+    float values[COMMAND_MAX_PARAMS];
+    for (uint8_t i = 0; i < count; i++) {
+        values[i] = fromFixed(readInt32(packet.payload + 4 * i));
+    }
+
+    cmd.setFields(deviceName, type, iface, query, values, count);
+    return true;
+}
+
+/**
+ * @brief Get group name of a group id
+ */
+const char* BinaryProtocol::groupName(uint8_t id) {
+    switch (id) {
+        case BINARY_ID_STEPPERS:  return GROUP_ALL_STEPPERS;
+        case BINARY_ID_SERVOS:    return GROUP_ALL_SERVOS;
+        case BINARY_ID_OUTPUTS:   return GROUP_ALL_OUTPUTS;
+        case BINARY_ID_SWITCHES:  return GROUP_ALL_SWITCHES;
+        case BINARY_ID_SENSORS:   return GROUP_ALL_SENSORS;
+        case BINARY_ID_ACTUATORS: return GROUP_ALL_ACTUATORS;
+        case BINARY_ID_ALL:       return GROUP_ALL_DEVICES;
+        default:                  return nullptr;
+    }
+}
+
+/**
+ * @brief Convert to Q16.16
+ */
+int32_t BinaryProtocol::toFixed(float value) {
+    float scaled = value * 65536.0f;
+    if (scaled >= 2147483647.0f) return INT32_MAX;
+    if (scaled <= -2147483648.0f) return INT32_MIN;
+    return (int32_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
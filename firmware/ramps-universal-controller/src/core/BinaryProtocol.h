@@ -0,0 +1,211 @@
+/**
+ * @file BinaryProtocol.h
+ * @brief Compact binary framing (COBS + CRC16) for the serial link
+ *
+ * Optional alternative to the text protocol, selected with
+ * `>CONTROLLER protocol binary` and left with the TEXT opcode.
+ *
+ * Packet (before framing):
+ *   [seq] [device id] [opcode] [payload ...] [crc16 lo] [crc16 hi]
+ *
+ * The packet is COBS encoded and terminated with a 0x00 byte, so a
+ * receiver resynchronises at the next 0x00 after line noise. The CRC is
+ * CRC-16/CCITT-FALSE over seq, device id, opcode and payload. Numeric
+ * values are little-endian int32 in Q16.16 fixed point.
+ */
+
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Command.h"
+
+/**
+ * @enum ProtocolMode
+ * @brief Wire format of the serial interface
+ */
+enum class ProtocolMode {
+    TEXT,           // Line-based ASCII commands and replies
+    BINARY          // COBS framed binary packets
+};
+
+/**
+ * @enum BinaryOpcode
+ * @brief Packet opcodes (requests < 0x80, replies >= 0x80)
+ */
+enum class BinaryOpcode : uint8_t {
+    // Actuator commands (payload: one value unless noted)
+    SET_POSITION     = 0x01,
+    SET_VELOCITY     = 0x02,
+    SET_ACCELERATION = 0x03,
+    SET_JERK         = 0x04,
+    ON               = 0x05,    // No payload
+    OFF              = 0x06,    // No payload
+    STOP             = 0x07,    // No payload
+    ENABLE           = 0x08,    // No payload
+    DISABLE          = 0x09,    // No payload
+    ZERO             = 0x0A,    // No payload
+
+    // Queries (no payload, answered with VALUE)
+    GET_POSITION     = 0x10,
+    GET_VELOCITY     = 0x11,
+    READ             = 0x12,    // Sensor value
+    GET_STATE        = 0x13,    // Switch state
+
+    // Telemetry (device: default value, CONTROLLER: optional period in ms)
+    SUBSCRIBE        = 0x14,
+    UNSUBSCRIBE      = 0x15,    // No payload
+
+    // Coordinated moves (device STEPPERS)
+    MOVE             = 0x20,    // One value per stepper and optional feed
+    GET_QUEUE        = 0x21,
+
+    // System commands (device CONTROLLER)
+    PING             = 0x30,
+    ESTOP            = 0x31,
+    RESET            = 0x32,
+    GET_WINDOW       = 0x33,    // Commands a host may have in flight
+    TEXT             = 0x3F,    // Return to the text protocol
+
+    // Replies
+    REPLY_OK         = 0x80,    // Payload: request opcode [, text]
+    REPLY_VALUE      = 0x81,    // Payload: request opcode, value
+    REPLY_ERROR      = 0x82,    // Payload: request opcode, error code [, text]
+    REPLY_EVENT      = 0x83,    // Payload: "interface value" text
+    REPLY_INFO       = 0x84,    // Payload: text (last part)
+    REPLY_INFO_PART  = 0x85,    // Payload: text (more parts follow)
+    REPLY_TELEMETRY  = 0x86     // Payload: uint32 millis, one value per channel
+};
+
+// Device ids above the device table
+#define BINARY_ID_STEPPERS      0xF0    // GROUP_ALL_STEPPERS
+#define BINARY_ID_SERVOS        0xF1    // GROUP_ALL_SERVOS
+#define BINARY_ID_OUTPUTS       0xF2    // GROUP_ALL_OUTPUTS
+#define BINARY_ID_SWITCHES      0xF3    // GROUP_ALL_SWITCHES
+#define BINARY_ID_SENSORS       0xF4    // GROUP_ALL_SENSORS
+#define BINARY_ID_ACTUATORS     0xF5    // GROUP_ALL_ACTUATORS
+#define BINARY_ID_ALL           0xF6    // GROUP_ALL_DEVICES
+#define BINARY_ID_CONTROLLER    0xFF    // System commands
+
+#define BINARY_HEADER_SIZE      3       // seq, device id, opcode
+#define BINARY_CRC_SIZE         2
+#define BINARY_MAX_PACKET       (BINARY_HEADER_SIZE + BINARY_MAX_PAYLOAD + BINARY_CRC_SIZE)
+#define BINARY_MAX_FRAME        (BINARY_MAX_PACKET + 2)     // COBS code byte and terminator
+
+/**
+ * @struct BinaryPacket
+ * @brief Decoded packet (payload points into the receive buffer)
+ */
+struct BinaryPacket {
+    uint8_t seq;                // Sequence number, echoed in the reply
+    uint8_t deviceId;           // Device table index or BINARY_ID_*
+    uint8_t opcode;             // BinaryOpcode
+    const uint8_t* payload;
+    uint8_t payloadLength;
+};
+
+/**
+ * @class BinaryProtocol
+ * @brief Framing, checksums and packet/command conversion
+ */
+class BinaryProtocol {
+public:
+    /**
+     * @brief Compute CRC-16/CCITT-FALSE
+     * @param data Bytes to check
+     * @param length Number of bytes
+     * @param crc Initial value (continue a previous CRC)
+     * @return CRC value
+     */
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+    /**
+     * @brief COBS encode a packet (no 0x00 terminator is added)
+     * @param input Packet bytes
+     * @param length Packet length (at most 253)
+     * @param output Buffer of at least length + 1 bytes
+     * @return Encoded length
+     */
+    static size_t cobsEncode(const uint8_t* input, size_t length, uint8_t* output);
+
+    /**
+     * @brief COBS decode a frame in place (without its 0x00 terminator)
+     * @param buffer Frame bytes, replaced by the packet
+     * @param length Frame length
+     * @return Packet length, 0 if the frame is malformed
+     */
+    static size_t cobsDecode(uint8_t* buffer, size_t length);
+
+    /**
+     * @brief Decode a received frame and check its CRC
+     * @param buffer Frame bytes (decoded in place)
+     * @param length Frame length
+     * @param packet Decoded packet
+     * @return true if the frame is well formed and the CRC matches
+     */
+    static bool decodeFrame(uint8_t* buffer, size_t length, BinaryPacket& packet);
+
+    /**
+     * @brief Build a frame (COBS encoded, 0x00 terminated)
+     * @param seq Sequence number
+     * @param deviceId Device id
+     * @param opcode Opcode
+     * @param payload Payload bytes
+     * @param payloadLength Payload length (at most BINARY_MAX_PAYLOAD)
+     * @param frame Buffer of at least BINARY_MAX_FRAME bytes
+     * @return Frame length
+     */
+    static size_t encodeFrame(uint8_t seq, uint8_t deviceId, BinaryOpcode opcode,
+                              const uint8_t* payload, uint8_t payloadLength, uint8_t* frame);
+
+    /**
+     * @brief Fill a command from a request packet
+     * @param packet Request packet
+     * @param deviceName Name of the addressed device or group
+     * @param cmd Command to fill
+     * @return true if the opcode and payload are valid
+     */
+    static bool toCommand(const BinaryPacket& packet, const char* deviceName, Command& cmd);
+
+    /**
+     * @brief Get group name of a group id
+     * @param id Device id
+     * @return Group name, or nullptr if id is not a group
+     */
+    static const char* groupName(uint8_t id);
+
+    /**
+     * @brief Convert to Q16.16
+     * @param value Value
+     * @return Fixed point value (saturated)
+     */
+    static int32_t toFixed(float value);
+
+    /**
+     * @brief Convert from Q16.16
+     * @param value Fixed point value
+     * @return Value
+     */
+    static float fromFixed(int32_t value) { return value * (1.0f / 65536.0f); }
+
+    /**
+     * @brief Read a little-endian int32
+     */
+    static int32_t readInt32(const uint8_t* data) {
+        return (int32_t)((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+    }
+
+    /**
+     * @brief Write a little-endian int32
+     */
+    static void writeInt32(uint8_t* data, int32_t value) {
+        data[0] = (uint8_t)value;
+        data[1] = (uint8_t)(value >> 8);
+        data[2] = (uint8_t)(value >> 16);
+        data[3] = (uint8_t)(value >> 24);
+    }
+};
+
+#endif // BINARY_PROTOCOL_H
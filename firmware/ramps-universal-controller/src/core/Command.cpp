@@ -6,82 +6,205 @@
 #include "Command.h"
 #include "DeviceConfig.h"
 
+static const uint8_t KEYWORD_MAX_LENGTH = 12;   // "acceleration"
+
+/**
+ * @struct CommandKeyword
+ * @brief Interface keyword and the command type it selects
+ */
+struct CommandKeyword {
+    char name[KEYWORD_MAX_LENGTH + 1];
+    uint8_t type;               // CommandType
+};
+
+/**
+ * Interface keywords grouped by length, so a lookup only compares the
+ * few keywords of the input's length.
+ */
+static const CommandKeyword COMMAND_KEYWORDS[] PROGMEM = {
+    // 2
+    {"on",           (uint8_t)CommandType::ON},
+    // 3
+    {"pos",          (uint8_t)CommandType::POSITION},
+    {"vel",          (uint8_t)CommandType::VELOCITY},
+    {"off",          (uint8_t)CommandType::OFF},
+    {"get",          (uint8_t)CommandType::GET},
+    // 4
+    {"move",         (uint8_t)CommandType::MOVE},
+    {"read",         (uint8_t)CommandType::GET},
+    {"home",         (uint8_t)CommandType::CALIBRATE},
+    {"list",         (uint8_t)CommandType::LIST},
+    {"ping",         (uint8_t)CommandType::CMD_PING},
+    {"stop",         (uint8_t)CommandType::STOP},
+    {"zero",         (uint8_t)CommandType::RESET},      // Use RESET for zero command
+    {"jerk",         (uint8_t)CommandType::CONFIG},
+    {"perf",         (uint8_t)CommandType::PERF},
+    // 5
+    {"speed",        (uint8_t)CommandType::VELOCITY},
+    {"queue",        (uint8_t)CommandType::QUEUE},
+    {"state",        (uint8_t)CommandType::STATE},
+    {"reset",        (uint8_t)CommandType::RESET},
+    {"estop",        (uint8_t)CommandType::ESTOP},
+    {"accel",        (uint8_t)CommandType::CONFIG},
+    {"tasks",        (uint8_t)CommandType::TASKS},
+    // 6
+    {"linear",       (uint8_t)CommandType::MOVE},
+    {"status",       (uint8_t)CommandType::STATUS},
+    {"config",       (uint8_t)CommandType::CONFIG},
+    {"enable",       (uint8_t)CommandType::ENABLE},
+    {"window",       (uint8_t)CommandType::WINDOW},
+    // 7
+    {"disable",      (uint8_t)CommandType::DISABLE},
+    {"service",      (uint8_t)CommandType::SERVICE},
+    {"setzero",      (uint8_t)CommandType::RESET},
+    // 8
+    {"position",     (uint8_t)CommandType::POSITION},
+    {"velocity",     (uint8_t)CommandType::VELOCITY},
+    {"protocol",     (uint8_t)CommandType::PROTOCOL},
+    // 9
+    {"configure",    (uint8_t)CommandType::CONFIG},
+    {"calibrate",    (uint8_t)CommandType::CALIBRATE},
+    {"emergency",    (uint8_t)CommandType::ESTOP},
+    {"subscribe",    (uint8_t)CommandType::SUBSCRIBE},
+    // 11
+    {"unsubscribe",  (uint8_t)CommandType::UNSUBSCRIBE},
+    // 12
+    {"acceleration", (uint8_t)CommandType::CONFIG},     // Use CONFIG for acceleration
+};
+
+/**
+ * First COMMAND_KEYWORDS entry of each keyword length; the keywords of
+ * length n are entries [n] to [n + 1] - 1.
+ */
+static constexpr uint8_t COMMAND_KEYWORD_BUCKET[KEYWORD_MAX_LENGTH + 2] = {
+    0, 0, 0, 1, 5, 14, 21, 26, 29, 32, 36, 36, 37, 38
+};
+
+static_assert(sizeof(COMMAND_KEYWORDS) / sizeof(COMMAND_KEYWORDS[0]) ==
+              COMMAND_KEYWORD_BUCKET[KEYWORD_MAX_LENGTH + 1],
+              "Keyword buckets out of date");
+
+static const char EMPTY_FIELD[] = "";
+
 /**
  * @brief Constructor
  */
 Command::Command() : Message(MessageType::COMMAND) {
+    text[0] = '\0';
     commandType = CommandType::UNKNOWN;
-    interface = "";
-    value = "";
+    device = EMPTY_FIELD;
+    interface = EMPTY_FIELD;
+    value = EMPTY_FIELD;
     isQuery = false;
     isBulk = false;
+    isTagged = false;
+    sequence = 0;
+    paramCount = 0;
 }
 
 /**
  * @brief Parse command from input string
  */
 bool Command::parse(const String& input) {
-    rawText = input;
-    String workingText = trim(input);
+    return parse(input.c_str());
+}
+
+/**
+ * @brief Parse command from a character buffer
+ */
+bool Command::parse(const char* input) {
+    // A command object may be parsed into more than once
+    text[0] = '\0';
+    commandType = CommandType::UNKNOWN;
+    device = EMPTY_FIELD;
+    interface = EMPTY_FIELD;
+    value = EMPTY_FIELD;
+    isQuery = false;
+    isBulk = false;
+    isTagged = false;
+    sequence = 0;
+    paramCount = 0;
     
-    // Check for empty command
-    if (workingText.length() == 0) {
+    size_t length = strlen(input);
+    if (length >= COMMAND_BUFFER_SIZE) {
         return false;
     }
+    memcpy(text, input, length + 1);
+    
+    char* workingText = text;
+    
+    while (isspace(*workingText)) {
+        workingText++;
+    }
+    
+    // Optional sequence tag
+    if (*workingText == COMMAND_SEQUENCE_CHAR && isdigit(workingText[1])) {
+        isTagged = true;
+        sequence = (uint16_t)strtoul(workingText + 1, &workingText, 10);
+        while (isspace(*workingText)) {
+            workingText++;
+        }
+    }
     
     // Remove command start character if present
-    if (USE_START_MARKER && workingText.startsWith(String(COMMAND_START_CHAR))) {
-        workingText = workingText.substring(1);
-        workingText = trim(workingText);
+    if (USE_START_MARKER && *workingText == COMMAND_START_CHAR) {
+        workingText++;
     }
     
     // Split command into parts
-    String parts[4];  // Maximum 4 parts: device, interface, value, extra
-    int partCount = splitString(workingText, COMMAND_DELIMITER, parts, 4);
+    char* parts[2 + COMMAND_MAX_PARAMS];  // device, interface, values...
+    uint8_t partCount = tokenize(workingText, parts, 2 + COMMAND_MAX_PARAMS);
     
-    if (partCount < 1) {
+    // Check for empty command, or more values than params can hold
+    if (partCount < 1 || partCount > 2 + COMMAND_MAX_PARAMS) {
         return false;
     }
     
     // Parse device name
-    deviceName = trim(parts[0]);
-    if (deviceName.length() == 0) {
-        return false;
-    }
+    device = parts[0];
     
     // Check if bulk command
-    isBulk = isBulkGroup(deviceName);
+    isBulk = isBulkGroup(device);
     
     // Parse interface/command if present
     if (partCount >= 2) {
-        interface = trim(parts[1]);
-        interface.toLowerCase();  // Normalize to lowercase
+        char* name = parts[1];
+        size_t nameLength = 0;
+        for (; name[nameLength] != '\0'; nameLength++) {
+            name[nameLength] = tolower(name[nameLength]);  // Normalize to lowercase
+        }
         
         // Check for query markers
-        if (interface.endsWith("?")) {
+        if (nameLength > 0 && name[nameLength - 1] == '?') {
             isQuery = true;
-            interface = interface.substring(0, interface.length() - 1);
-        } else if (interface == "get" || interface == "read" || interface == "status") {
+            name[nameLength - 1] = '\0';
+        } else if (strcmp(name, "get") == 0 || strcmp(name, "read") == 0 || strcmp(name, "status") == 0) {
             isQuery = true;
         }
         
-        // Parse command type
-        commandType = parseCommandType(interface);
+        interface = name;
     } else {
-        // Single word commands (e.g., "CONTROLLER LIST")
-        interface = deviceName;
-        interface.toLowerCase();
-        commandType = parseCommandType(interface);
+        // Single word commands (e.g., "LIST"); keyword lookup ignores case
+        interface = device;
     }
     
+    // Parse command type
+    commandType = parseCommandType(interface);
+    
     // Parse value if present
     if (partCount >= 3) {
-        value = trim(parts[2]);
+        value = parts[2];
+        
+        // Keep all values as numbers for multi-value commands
+        paramCount = partCount - 2;
+        for (uint8_t i = 0; i < paramCount; i++) {
+            params[i] = atof(parts[2 + i]);
+        }
         
         // Handle special values
-        if (value.equalsIgnoreCase("ON")) {
+        if (strcasecmp(value, "ON") == 0) {
             commandType = CommandType::ON;
-        } else if (value.equalsIgnoreCase("OFF")) {
+        } else if (strcasecmp(value, "OFF") == 0) {
             commandType = CommandType::OFF;
         }
     }
@@ -89,19 +212,44 @@ bool Command::parse(const String& input) {
     return true;
 }
 
+/**
+ * @brief Fill the command from decoded fields
+ */
+void Command::setFields(const char* deviceName, CommandType type, const char* iface,
+                        bool query, const float* values, uint8_t count) {
+    text[0] = '\0';
+    device = deviceName;
+    interface = iface;
+    value = EMPTY_FIELD;
+    commandType = type;
+    isQuery = query;
+    isBulk = isBulkGroup(device);
+    
+    paramCount = (count < COMMAND_MAX_PARAMS) ? count : COMMAND_MAX_PARAMS;
+    for (uint8_t i = 0; i < paramCount; i++) {
+        params[i] = values[i];
+    }
+}
+
 /**
  * @brief Convert command to string
  */
 String Command::toString() const {
     String result = "";
     
+    if (isTagged) {
+        result += COMMAND_SEQUENCE_CHAR;
+        result += String((unsigned int)sequence);
+        result += COMMAND_DELIMITER;
+    }
+    
     if (USE_START_MARKER) {
         result += COMMAND_START_CHAR;
     }
     
-    result += deviceName;
+    result += device;
     
-    if (interface.length() > 0) {
+    if (interface[0] != '\0' && interface != device) {
         result += COMMAND_DELIMITER;
         result += interface;
         
@@ -109,7 +257,7 @@ String Command::toString() const {
             result += "?";
         }
         
-        if (value.length() > 0) {
+        if (value[0] != '\0') {
             result += COMMAND_DELIMITER;
             result += value;
         }
@@ -122,65 +270,71 @@ String Command::toString() const {
  * @brief Check if command is valid
  */
 bool Command::isValid() const {
-    return (deviceName.length() > 0) && (commandType != CommandType::UNKNOWN);
+    return (device[0] != '\0') && (commandType != CommandType::UNKNOWN);
 }
 
 /**
- * @brief Parse command type from interface string
+ * @brief Look up command type of an interface keyword
  */
-CommandType Command::parseCommandType(const String& interfaceStr) {
-    if (interfaceStr == "position" || interfaceStr == "pos") {
-        return CommandType::POSITION;
-    } else if (interfaceStr == "velocity" || interfaceStr == "vel" || interfaceStr == "speed") {
-        return CommandType::VELOCITY;
-    } else if (interfaceStr == "state") {
-        return CommandType::STATE;
-    } else if (interfaceStr == "on") {
-        return CommandType::ON;
-    } else if (interfaceStr == "off") {
-        return CommandType::OFF;
-    } else if (interfaceStr == "get" || interfaceStr == "read") {
-        return CommandType::GET;
-    } else if (interfaceStr == "status") {
-        return CommandType::STATUS;
-    } else if (interfaceStr == "config" || interfaceStr == "configure") {
-        return CommandType::CONFIG;
-    } else if (interfaceStr == "calibrate" || interfaceStr == "home") {
-        return CommandType::CALIBRATE;
-    } else if (interfaceStr == "reset") {
-        return CommandType::RESET;
-    } else if (interfaceStr == "enable") {
-        return CommandType::ENABLE;
-    } else if (interfaceStr == "disable") {
-        return CommandType::DISABLE;
-    } else if (interfaceStr == "list") {
-        return CommandType::LIST;
-    } else if (interfaceStr == "ping") {
-        return CommandType::CMD_PING;
-    } else if (interfaceStr == "stop") {
-        return CommandType::STOP;
-    } else if (interfaceStr == "estop" || interfaceStr == "emergency") {
-        return CommandType::ESTOP;
-    } else if (interfaceStr == "service") {
-        return CommandType::SERVICE;
-    } else if (interfaceStr == "zero" || interfaceStr == "setzero") {
-        return CommandType::RESET;  // Use RESET for zero command
-    } else if (interfaceStr == "acceleration" || interfaceStr == "accel") {
-        return CommandType::CONFIG;  // Use CONFIG for acceleration
-    } else {
+CommandType Command::parseCommandType(const char* keyword) {
+    size_t length = strlen(keyword);
+    if (length > KEYWORD_MAX_LENGTH) {
         return CommandType::UNKNOWN;
     }
+    
+    for (uint8_t i = COMMAND_KEYWORD_BUCKET[length]; i < COMMAND_KEYWORD_BUCKET[length + 1]; i++) {
+        if (strcasecmp_P(keyword, COMMAND_KEYWORDS[i].name) == 0) {
+            return (CommandType)pgm_read_byte(&COMMAND_KEYWORDS[i].type);
+        }
+    }
+    return CommandType::UNKNOWN;
 }
 
 /**
  * @brief Check if device name is a bulk group
  */
-bool Command::isBulkGroup(const String& name) {
-    return (name == GROUP_ALL_STEPPERS ||
-            name == GROUP_ALL_SERVOS ||
-            name == GROUP_ALL_OUTPUTS ||
-            name == GROUP_ALL_SWITCHES ||
-            name == GROUP_ALL_SENSORS ||
-            name == GROUP_ALL_ACTUATORS ||
-            name == GROUP_ALL_DEVICES);
-}
\ No newline at end of file
+bool Command::isBulkGroup(const char* name) {
+    return (strcmp(name, GROUP_ALL_STEPPERS) == 0 ||
+            strcmp(name, GROUP_ALL_SERVOS) == 0 ||
+            strcmp(name, GROUP_ALL_OUTPUTS) == 0 ||
+            strcmp(name, GROUP_ALL_SWITCHES) == 0 ||
+            strcmp(name, GROUP_ALL_SENSORS) == 0 ||
+            strcmp(name, GROUP_ALL_ACTUATORS) == 0 ||
+            strcmp(name, GROUP_ALL_DEVICES) == 0);
+}
+
+/**
+ * @brief Split a buffer in place
+ */
+uint8_t Command::tokenize(char* str, char* tokens[], uint8_t maxTokens) {
+    uint8_t count = 0;
+    
+    while (count < maxTokens) {
+        // Skip delimiters and whitespace
+        while (*str == COMMAND_DELIMITER || isspace(*str)) {
+            str++;
+        }
+        if (*str == '\0') break;
+        
+        tokens[count++] = str;
+        
+        // Find end of token and terminate it
+        while (*str != '\0' && *str != COMMAND_DELIMITER && !isspace(*str)) {
+            str++;
+        }
+        if (*str == '\0') break;
+        *str++ = '\0';
+    }
+    
+    // Anything left is a token that did not fit
+    if (count == maxTokens) {
+        while (*str == COMMAND_DELIMITER || isspace(*str)) {
+            str++;
+        }
+        if (*str != '\0') {
+            return maxTokens + 1;
+        }
+    }
+    
+    return count;
+}
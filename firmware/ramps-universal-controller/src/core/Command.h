@@ -20,6 +20,8 @@ enum class CommandType {
     STATE,
     ON,
     OFF,
+    MOVE,           // Coordinated multi-axis move
+    QUEUE,          // Motion queue status
     
     // Query commands
     GET,
@@ -40,6 +42,12 @@ enum class CommandType {
     CMD_PING,    // Renamed from PING to avoid AVR macro conflict
     STOP,
     ESTOP,
+    PROTOCOL,       // Select text or binary protocol
+    WINDOW,         // Receive window query
+    SUBSCRIBE,      // Periodic telemetry
+    UNSUBSCRIBE,
+    TASKS,          // Scheduler task statistics
+    PERF,           // Timing histograms (ENABLE_PROFILING)
     
     // Service commands
     SERVICE,
@@ -51,14 +59,25 @@ enum class CommandType {
 /**
  * @class Command
  * @brief Represents an incoming command
+ * 
+ * Parsing copies the input into a fixed buffer and splits it in place;
+ * the device, interface and value fields point into that buffer, so a
+ * command is parsed without heap allocation. The String fields of
+ * Message (device name, raw text) are not used by commands.
  */
 class Command : public Message {
 private:
+    char text[COMMAND_BUFFER_SIZE];     // Tokenized copy of the input
     CommandType commandType;    // Type of command
-    String interface;           // Interface name (position, velocity, etc.)
-    String value;               // Command value/parameter
+    const char* device;         // Device or group name
+    const char* interface;      // Interface name (position, velocity, etc.)
+    const char* value;          // Command value/parameter
     bool isQuery;               // Is this a query command?
+    bool isTagged;              // Has a sequence tag?
+    uint16_t sequence;          // Sequence tag echoed in the reply
     bool isBulk;                // Is this a bulk command?
+    float params[COMMAND_MAX_PARAMS];   // Numeric values (value and following fields)
+    uint8_t paramCount;         // Number of numeric values
     
 public:
     /**
@@ -73,6 +92,28 @@ public:
      */
     bool parse(const String& input) override;
     
+    /**
+     * @brief Parse command from a character buffer (no heap use)
+     * @param input Null-terminated command (with or without '>' prefix)
+     * @return true if parsing successful
+     */
+    bool parse(const char* input);
+    
+    /**
+     * @brief Fill the command from already decoded fields
+     * 
+     * Used by the binary protocol. deviceName must stay valid while the
+     * command is in use (a device name or a group name literal).
+     * @param deviceName Device or group name
+     * @param type Command type
+     * @param iface Lowercase interface name
+     * @param query true for a query
+     * @param values Numeric values
+     * @param count Number of values (at most COMMAND_MAX_PARAMS)
+     */
+    void setFields(const char* deviceName, CommandType type, const char* iface,
+                   bool query, const float* values, uint8_t count);
+    
     /**
      * @brief Convert command to string
      * @return Formatted command string
@@ -91,23 +132,56 @@ public:
      */
     CommandType getCommandType() const { return commandType; }
     
+    /**
+     * @brief Get device name
+     * @return Device or group name
+     */
+    const char* getDeviceName() const { return device; }
+    
+    /**
+     * @brief Check the device name
+     * @param name Device or group name
+     * @return true if the command targets this name
+     */
+    bool isDevice(const char* name) const { return strcmp(device, name) == 0; }
+    
     /**
      * @brief Get interface name
-     * @return Interface string (position, velocity, etc.)
+     * @return Lowercase interface (position, velocity, etc.)
+     */
+    const char* getInterface() const { return interface; }
+    
+    /**
+     * @brief Check the interface name
+     * @param name Lowercase interface name
+     * @return true if the command uses this interface
      */
-    const String& getInterface() const { return interface; }
+    bool isInterface(const char* name) const { return strcmp(interface, name) == 0; }
     
     /**
      * @brief Get command value
-     * @return Value string
+     * @return Value string (empty if none)
      */
-    const String& getValue() const { return value; }
+    const char* getValue() const { return value; }
     
     /**
      * @brief Get numeric value
      * @return Value as float
      */
-    float getNumericValue() const { return value.toFloat(); }
+    float getNumericValue() const { return (paramCount > 0) ? params[0] : 0.0; }
+    
+    /**
+     * @brief Get number of values following the interface
+     * @return Value count
+     */
+    uint8_t getParamCount() const { return paramCount; }
+    
+    /**
+     * @brief Get numeric value by index
+     * @param index Value index (0 = first value)
+     * @return Value as float, 0 if absent
+     */
+    float getParam(uint8_t index) const { return (index < paramCount) ? params[index] : 0.0; }
     
     /**
      * @brief Check if this is a query
@@ -115,6 +189,18 @@ public:
      */
     bool getIsQuery() const { return isQuery; }
     
+    /**
+     * @brief Check for a sequence tag
+     * @return true if the command started with #<n>
+     */
+    bool hasSequence() const { return isTagged; }
+    
+    /**
+     * @brief Get sequence tag
+     * @return Sequence number
+     */
+    uint16_t getSequence() const { return sequence; }
+    
     /**
      * @brief Check if this is a bulk command
      * @return true if bulk command
@@ -123,18 +209,27 @@ public:
     
 private:
     /**
-     * @brief Parse command type from interface string
-     * @param interfaceStr Interface string
-     * @return Command type
+     * @brief Look up command type of an interface keyword
+     * @param keyword Interface keyword (case-insensitive)
+     * @return Command type, UNKNOWN if not a keyword
      */
-    CommandType parseCommandType(const String& interfaceStr);
+    static CommandType parseCommandType(const char* keyword);
     
     /**
      * @brief Check if device name is a bulk group
      * @param name Device/group name
      * @return true if bulk group
      */
-    bool isBulkGroup(const String& name);
+    static bool isBulkGroup(const char* name);
+    
+    /**
+     * @brief Split a buffer in place at delimiters and whitespace
+     * @param str Buffer to split (delimiters are overwritten with '\0')
+     * @param tokens Array to store token pointers
+     * @param maxTokens Maximum number of tokens
+     * @return Number of tokens found, maxTokens + 1 if there are more
+     */
+    static uint8_t tokenize(char* str, char* tokens[], uint8_t maxTokens);
 };
 
 #endif // COMMAND_H
\ No newline at end of file
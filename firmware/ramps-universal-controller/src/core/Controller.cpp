@@ -5,11 +5,15 @@
 
 #include "Controller.h"
 #include "Interface.h"
+#include "Profiler.h"
+#include "DeviceTable.h"
 #include "../devices/actuators/StepperMotor.h"
 #include "../devices/actuators/Servo.h"
 #include "../devices/actuators/MosfetOutput.h"
 #include "../devices/sensors/EndSwitch.h"
 #include "../devices/sensors/AnalogSensor.h"
+#include "../motion/StepGenerator.h"
+#include "../motion/MotionPlanner.h"
 #include "PinDefinitions.h"
 
 // Global controller instance
@@ -19,63 +23,12 @@ Controller controller;
  * @brief Constructor
  */
 Controller::Controller() {
-    steppers = nullptr;
-    servos = nullptr;
-    mosfets = nullptr;
-    switches = nullptr;
-    analogSensors = nullptr;
-    
-    numSteppers = 0;
-    numServos = 0;
-    numMosfets = 0;
-    numSwitches = 0;
-    numAnalogSensors = 0;
+    numHeaters = 0;
     
     interface = nullptr;
     initialized = false;
     emergencyStop = false;
-    lastStatusTime = 0;
-}
-
-/**
- * @brief Destructor
- */
-Controller::~Controller() {
-    // Delete all devices
-    if (steppers) {
-        for (int i = 0; i < numSteppers; i++) {
-            if (steppers[i]) delete steppers[i];
-        }
-        delete[] steppers;
-    }
-    
-    if (servos) {
-        for (int i = 0; i < numServos; i++) {
-            if (servos[i]) delete servos[i];
-        }
-        delete[] servos;
-    }
-    
-    if (mosfets) {
-        for (int i = 0; i < numMosfets; i++) {
-            if (mosfets[i]) delete mosfets[i];
-        }
-        delete[] mosfets;
-    }
-    
-    if (switches) {
-        for (int i = 0; i < numSwitches; i++) {
-            if (switches[i]) delete switches[i];
-        }
-        delete[] switches;
-    }
-    
-    if (analogSensors) {
-        for (int i = 0; i < numAnalogSensors; i++) {
-            if (analogSensors[i]) delete analogSensors[i];
-        }
-        delete[] analogSensors;
-    }
+    telemetryTaskId = TASK_NONE;
 }
 
 /**
@@ -92,142 +45,81 @@ bool Controller::init() {
         return false;
     }
     
+    // Start interrupt driven step generation
+    stepGenerator.begin();
+    
+    registerTasks();
+    
     initialized = true;
     return true;
 }
 
 /**
- * @brief Create and configure all devices
+ * @brief Register the configured devices and bind switches and heaters
  */
 void Controller::createDevices() {
-    // Create stepper motors
-    numSteppers = 0;
-    #ifdef STEPPER_X_ENABLED
-        numSteppers++;
-    #endif
-    #ifdef STEPPER_Y_ENABLED
-        numSteppers++;
-    #endif
-    #ifdef STEPPER_Z_ENABLED
-        numSteppers++;
-    #endif
-    
-    if (numSteppers > 0) {
-        steppers = new StepperMotor*[numSteppers];
-        int idx = 0;
-        
-        #ifdef STEPPER_X_ENABLED
-            steppers[idx++] = new StepperMotor(STEPPER_X_NAME, X_STEP_PIN, X_DIR_PIN, X_ENABLE_PIN, STEPPER_X_STEPS_PER_REV);
-        #endif
-        #ifdef STEPPER_Y_ENABLED
-            steppers[idx++] = new StepperMotor(STEPPER_Y_NAME, Y_STEP_PIN, Y_DIR_PIN, Y_ENABLE_PIN, STEPPER_Y_STEPS_PER_REV);
-        #endif
-        #ifdef STEPPER_Z_ENABLED
-            steppers[idx++] = new StepperMotor(STEPPER_Z_NAME, Z_STEP_PIN, Z_DIR_PIN, Z_ENABLE_PIN, STEPPER_Z_STEPS_PER_REV);
-        #endif
-    }
-    
-    // Create servo motors
-    numServos = 0;
-    #ifdef SERVO_0_ENABLED
-        numServos++;
-    #endif
-    #ifdef SERVO_1_ENABLED
-        numServos++;
-    #endif
+    DeviceTable::build(registry);
     
-    if (numServos > 0) {
-        servos = new ServoMotor*[numServos];
-        int idx = 0;
-        
-        #ifdef SERVO_0_ENABLED
-            servos[idx++] = new ServoMotor(SERVO_0_NAME, SERVO0_PIN, SERVO_0_MIN_ANGLE, SERVO_0_MAX_ANGLE);
-        #endif
-        #ifdef SERVO_1_ENABLED
-            servos[idx++] = new ServoMotor(SERVO_1_NAME, SERVO1_PIN, SERVO_1_MIN_ANGLE, SERVO_1_MAX_ANGLE);
-        #endif
-    }
-    
-    // Create MOSFET outputs
-    numMosfets = 0;
-    #ifdef MOSFET_A_ENABLED
-        numMosfets++;
-    #endif
-    #ifdef MOSFET_B_ENABLED
-        numMosfets++;
-    #endif
-    #ifdef MOSFET_C_ENABLED
-        numMosfets++;
-    #endif
-    
-    if (numMosfets > 0) {
-        mosfets = new MosfetOutput*[numMosfets];
-        int idx = 0;
-        
-        #ifdef MOSFET_A_ENABLED
-            mosfets[idx++] = new MosfetOutput(MOSFET_A_NAME, MOSFET_A_PIN, MOSFET_A_PWM);
-        #endif
-        #ifdef MOSFET_B_ENABLED
-            mosfets[idx++] = new MosfetOutput(MOSFET_B_NAME, MOSFET_B_PIN, MOSFET_B_PWM);
-        #endif
-        #ifdef MOSFET_C_ENABLED
-            mosfets[idx++] = new MosfetOutput(MOSFET_C_NAME, MOSFET_C_PIN, MOSFET_C_PWM);
-        #endif
-    }
-    
-    // Create end switches
-    numSwitches = 0;
+    // Bind switches to the axes they limit
     #ifdef SWITCH_X_MIN_ENABLED
-        numSwitches++;
+        bindSwitch(SWITCH_X_MIN_NAME, SWITCH_X_MIN_AXIS, SWITCH_X_MIN_DIRECTION);
     #endif
     #ifdef SWITCH_Y_MIN_ENABLED
-        numSwitches++;
+        bindSwitch(SWITCH_Y_MIN_NAME, SWITCH_Y_MIN_AXIS, SWITCH_Y_MIN_DIRECTION);
     #endif
     #ifdef SWITCH_Z_MIN_ENABLED
-        numSwitches++;
+        bindSwitch(SWITCH_Z_MIN_NAME, SWITCH_Z_MIN_AXIS, SWITCH_Z_MIN_DIRECTION);
+    #endif
+    #ifdef SWITCH_X_MAX_ENABLED
+        bindSwitch(SWITCH_X_MAX_NAME, SWITCH_X_MAX_AXIS, SWITCH_X_MAX_DIRECTION);
+    #endif
+    #ifdef SWITCH_Y_MAX_ENABLED
+        bindSwitch(SWITCH_Y_MAX_NAME, SWITCH_Y_MAX_AXIS, SWITCH_Y_MAX_DIRECTION);
+    #endif
+    #ifdef SWITCH_Z_MAX_ENABLED
+        bindSwitch(SWITCH_Z_MAX_NAME, SWITCH_Z_MAX_AXIS, SWITCH_Z_MAX_DIRECTION);
     #endif
     
-    if (numSwitches > 0) {
-        switches = new EndSwitch*[numSwitches];
-        int idx = 0;
-        
-        #ifdef SWITCH_X_MIN_ENABLED
-            switches[idx++] = new EndSwitch(SWITCH_X_MIN_NAME, X_MIN_PIN, SWITCH_X_MIN_INVERTED, SWITCH_PULLUP);
-        #endif
-        #ifdef SWITCH_Y_MIN_ENABLED
-            switches[idx++] = new EndSwitch(SWITCH_Y_MIN_NAME, Y_MIN_PIN, SWITCH_Y_MIN_INVERTED, SWITCH_PULLUP);
-        #endif
-        #ifdef SWITCH_Z_MIN_ENABLED
-            switches[idx++] = new EndSwitch(SWITCH_Z_MIN_NAME, Z_MIN_PIN, SWITCH_Z_MIN_INVERTED, SWITCH_PULLUP);
-        #endif
-    }
-    
-    // Create analog sensors
-    numAnalogSensors = 0;
-    #ifdef ANALOG_0_ENABLED
-        numAnalogSensors++;
+    // Bind heater loops to their sensor and output
+    numHeaters = 0;
+    #ifdef HEATER_0_ENABLED
+        bindHeater(HEATER_0_SENSOR, HEATER_0_OUTPUT, HEATER_0_KP, HEATER_0_KI, HEATER_0_KD, HEATER_0_MAX_POWER);
     #endif
-    #ifdef ANALOG_1_ENABLED
-        numAnalogSensors++;
+    #ifdef HEATER_1_ENABLED
+        bindHeater(HEATER_1_SENSOR, HEATER_1_OUTPUT, HEATER_1_KP, HEATER_1_KI, HEATER_1_KD, HEATER_1_MAX_POWER);
     #endif
+}
+
+/**
+ * @brief Bind an end switch to the axis it limits
+ */
+void Controller::bindSwitch(const char* switchName, const char* axisName, int8_t direction) {
+    Device* sw = getDeviceByName(switchName);
+    Device* axis = getDeviceByName(axisName);
+    if (!sw || sw->getType() != DeviceType::END_SWITCH ||
+        !axis || axis->getType() != DeviceType::STEPPER_MOTOR) {
+        return;     // Switch stays unbound: events only
+    }
     
-    if (numAnalogSensors > 0) {
-        analogSensors = new AnalogSensor*[numAnalogSensors];
-        int idx = 0;
-        
-        #ifdef ANALOG_0_ENABLED
-            analogSensors[idx] = new AnalogSensor(ANALOG_0_NAME, ANALOG_0_PIN, ANALOG_0_MODE);
-            // Configure thermistor if needed
-            #if ANALOG_0_MODE == SENSOR_MODE_CUSTOM
-                analogSensors[idx]->configureThermistor(ANALOG_0_R_PULLUP, ANALOG_0_THERMISTOR_R25, ANALOG_0_THERMISTOR_BETA);
-            #endif
-            idx++;
-        #endif
-        #ifdef ANALOG_1_ENABLED
-            analogSensors[idx] = new AnalogSensor(ANALOG_1_NAME, ANALOG_1_PIN, ANALOG_1_MODE);
-            idx++;
-        #endif
+    static_cast<EndSwitch*>(sw)->bindAxis(static_cast<StepperMotor*>(axis), direction);
+}
+
+/**
+ * @brief Bind a heater loop to a sensor and an output by name
+ */
+void Controller::bindHeater(const char* sensorName, const char* outputName, float kp, float ki, float kd, float power) {
+    if (numHeaters >= NUM_HEATERS) return;
+    
+    Device* sensor = getDeviceByName(sensorName);
+    Device* output = getDeviceByName(outputName);
+    if (!sensor || sensor->getType() != DeviceType::ANALOG_SENSOR ||
+        !output || output->getType() != DeviceType::MOSFET_OUTPUT) {
+        return;     // Loop stays unbound; the output remains manual
     }
+    
+    HeaterLoop& heater = heaters[numHeaters++];
+    heater.attach(static_cast<AnalogSensor*>(sensor), static_cast<MosfetOutput*>(output), power);
+    heater.getPid().setGains(kp, ki, kd);
 }
 
 /**
@@ -236,78 +128,104 @@ void Controller::createDevices() {
 bool Controller::initializeDevices() {
     bool success = true;
     
-    // Initialize steppers
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i] && !steppers[i]->init()) {
+    for (uint8_t id = 0; id < registry.getCount(); id++) {
+        if (!registry.get(id)->init()) {
             success = false;
         }
     }
     
-    // Initialize servos
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i] && !servos[i]->init()) {
-            success = false;
-        }
-    }
-    
-    // Initialize MOSFETs
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i] && !mosfets[i]->init()) {
-            success = false;
+    return success;
+}
+
+/**
+ * @brief Register the device and control loop tasks
+ *
+ * Devices run before the loops that read them; within a priority tasks
+ * run in the order they are added.
+ */
+void Controller::registerTasks() {
+    for (uint8_t id = 0; id < registry.getCount(); id++) {
+        Device* device = registry.get(id);
+        unsigned long period;
+        TaskFunction task = deviceTask;
+        
+        switch (device->getType()) {
+            case DeviceType::STEPPER_MOTOR: period = STEPPER_TASK_PERIOD; break;
+            case DeviceType::SERVO_MOTOR:   period = SERVO_TASK_PERIOD; break;
+            case DeviceType::MOSFET_OUTPUT: period = OUTPUT_TASK_PERIOD; break;
+            case DeviceType::END_SWITCH:    period = SWITCH_TASK_PERIOD; task = switchTask; break;
+            default:                        period = SENSOR_TASK_PERIOD; break;
         }
+        
+        scheduler.add(device->getName().c_str(), task, device, period, TaskPriority::DEVICE);
     }
     
-    // Initialize switches
-    for (int i = 0; i < numSwitches; i++) {
-        if (switches[i] && !switches[i]->init()) {
-            success = false;
-        }
-    }
-    
-    // Initialize analog sensors
-    for (int i = 0; i < numAnalogSensors; i++) {
-        if (analogSensors[i] && !analogSensors[i]->init()) {
-            success = false;
-        }
+    // Each heater loop and the telemetry record keep their own period
+    if (numHeaters > 0) {
+        scheduler.add("heaters", heaterTask, this, CONTROL_TASK_PERIOD, TaskPriority::CONTROL);
     }
+    scheduler.add("homing", homingTask, this, CONTROL_TASK_PERIOD, TaskPriority::CONTROL);
+    telemetryTaskId = scheduler.add("telemetry", telemetryTask, this, CONTROL_TASK_PERIOD, TaskPriority::BACKGROUND);
+    scheduleTelemetry();
+}
+
+/**
+ * @brief Scheduler task: update one device
+ */
+void Controller::deviceTask(void* device) {
+    if (controller.emergencyStop) return;
     
-    return success;
+    Device* dev = static_cast<Device*>(device);
+    PERF_START(start);
+    dev->update();
+    PERF_END(Profiler::deviceChannel(dev->getType()), start);
 }
 
 /**
- * @brief Update all devices
+ * @brief Scheduler task: update one end switch
  */
-void Controller::update() {
-    if (!initialized || emergencyStop) return;
+void Controller::switchTask(void* endSwitch) {
+    if (controller.emergencyStop) return;
     
-    // Update all actuators
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i]) steppers[i]->update();
-    }
+    EndSwitch* sw = static_cast<EndSwitch*>(endSwitch);
+    PERF_START(start);
+    sw->update();
+    PERF_END(PerfChannel::SWITCH, start);
     
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i]) servos[i]->update();
+    // Check for state changes
+    if (REPORT_SWITCH_EVENTS && sw->hasStateChanged()) {
+        controller.handleSwitchChange(sw->getName(), sw->getState());
     }
+}
+
+/**
+ * @brief Scheduler task: run the heater loops
+ */
+void Controller::heaterTask(void* self) {
+    Controller* ctrl = static_cast<Controller*>(self);
+    if (ctrl->emergencyStop) return;
     
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i]) mosfets[i]->update();
-    }
+    ctrl->updateHeaters();
+}
+
+/**
+ * @brief Scheduler task: advance homing
+ */
+void Controller::homingTask(void* self) {
+    Controller* ctrl = static_cast<Controller*>(self);
+    if (ctrl->emergencyStop) return;
     
-    // Update all sensors
-    for (int i = 0; i < numSwitches; i++) {
-        if (switches[i]) {
-            switches[i]->update();
-            
-            // Check for state changes
-            if (REPORT_SWITCH_EVENTS && switches[i]->hasStateChanged()) {
-                handleSwitchChange(switches[i]->getName(), switches[i]->getState());
-            }
-        }
-    }
+    ctrl->updateHoming();
+}
+
+/**
+ * @brief Scheduler task: send a telemetry record when one is due
+ */
+void Controller::telemetryTask(void* self) {
+    Controller* ctrl = static_cast<Controller*>(self);
+    if (ctrl->emergencyStop) return;
     
-    for (int i = 0; i < numAnalogSensors; i++) {
-        if (analogSensors[i]) analogSensors[i]->update();
-    }
+    ctrl->updateTelemetry();
 }
 
 /**
@@ -323,7 +241,7 @@ Reply Controller::executeCommand(const Command& cmd) {
     }
     
     // Handle system commands
-    if (cmd.getDeviceName() == "CONTROLLER" || cmd.getCommandType() == CommandType::LIST) {
+    if (cmd.isDevice("CONTROLLER") || cmd.getCommandType() == CommandType::LIST) {
         return executeSystemCommand(cmd);
     }
     
@@ -334,17 +252,31 @@ Reply Controller::executeCommand(const Command& cmd) {
     
     // Handle bulk commands
     if (cmd.getIsBulk()) {
-        Device* devices[20];  // Max 20 devices in a group
-        int count = getDevicesByGroup(cmd.getDeviceName(), devices, 20);
+        // Coordinated moves run as one operation, not per device
+        if (cmd.getCommandType() == CommandType::MOVE || cmd.getCommandType() == CommandType::QUEUE) {
+            if (!cmd.isDevice(GROUP_ALL_STEPPERS)) {
+                reply.setError(cmd.getDeviceName(), ERROR_UNKNOWN_COMMAND, String(cmd.getInterface()) + " requires " GROUP_ALL_STEPPERS);
+                return reply;
+            }
+            if (cmd.getCommandType() == CommandType::QUEUE) {
+                reply.setValue(GROUP_ALL_STEPPERS, "queue", getQueueState());
+                return reply;
+            }
+            return executeLinearMove(cmd);
+        }
         
-        if (count == 0) {
+        DeviceMask members = getDevicesByGroup(cmd.getDeviceName());
+        
+        if (members == 0) {
             reply.setError(cmd.getDeviceName(), ERROR_UNKNOWN_DEVICE, "Unknown group");
             return reply;
         }
         
         // Execute command on all devices in group
-        for (int i = 0; i < count; i++) {
-            executeDeviceCommand(devices[i], cmd);
+        for (uint8_t id = 0; members; id++, members >>= 1) {
+            if (members & 1) {
+                executeDeviceCommand(registry.get(id), cmd);
+            }
         }
         
         reply.setOK(cmd.getDeviceName(), cmd.getInterface());
@@ -372,6 +304,11 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
         return reply;
     }
     
+    // Subscriptions apply to every device type
+    if (cmd.getCommandType() == CommandType::SUBSCRIBE || cmd.getCommandType() == CommandType::UNSUBSCRIBE) {
+        return executeSubscription(device, cmd);
+    }
+    
     // Determine device category by type
     DeviceType devType = device->getType();
     bool isActuator = (devType == DeviceType::STEPPER_MOTOR || 
@@ -384,13 +321,26 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
     if (isActuator) {
         Actuator* actuator = static_cast<Actuator*>(device);
         
+        // Heater outputs take setpoints; manual commands take the output back
+        HeaterLoop* heater = getHeaterLoop(device);
+        if (heater) {
+            if (executeHeaterCommand(heater, cmd, reply)) {
+                return reply;
+            }
+            if (!cmd.getIsQuery() && cmd.getCommandType() != CommandType::ENABLE) {
+                heater->disable();
+            }
+        }
+        
         switch (cmd.getCommandType()) {
             case CommandType::POSITION:
                 if (cmd.getIsQuery()) {
-                    reply.setValue(device->getName(), "position", String(actuator->getPosition(), 3));
+                    reply.setValue(device->getName(), "position", actuator->getPosition(), 3);
                 } else {
                     if (actuator->setPosition(cmd.getNumericValue())) {
                         reply.setOK(device->getName(), "position", cmd.getValue());
+                    } else if (!actuator->isEnabled()) {
+                        reply.setError(device->getName(), ERROR_INVALID_PARAM, "Not enabled, send enable first");
                     } else {
                         reply.setError(device->getName(), ERROR_INVALID_PARAM, "Failed to set position");
                     }
@@ -399,10 +349,12 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
                 
             case CommandType::VELOCITY:
                 if (cmd.getIsQuery()) {
-                    reply.setValue(device->getName(), "velocity", String(actuator->getVelocity(), 3));
+                    reply.setValue(device->getName(), "velocity", actuator->getVelocity(), 3);
                 } else {
                     if (actuator->setVelocity(cmd.getNumericValue())) {
                         reply.setOK(device->getName(), "velocity", cmd.getValue());
+                    } else if (!actuator->isEnabled()) {
+                        reply.setError(device->getName(), ERROR_INVALID_PARAM, "Not enabled, send enable first");
                     } else {
                         reply.setError(device->getName(), ERROR_INVALID_PARAM, "Failed to set velocity");
                     }
@@ -446,19 +398,27 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
                 
             default:
                 // Check for device-specific commands by interface name
-                if (cmd.getInterface() == "acceleration" || cmd.getInterface() == "accel") {
+                if (cmd.isInterface("acceleration") || cmd.isInterface("accel")) {
                     if (cmd.getIsQuery()) {
-                        reply.setValue(device->getName(), "acceleration", String(actuator->getAcceleration(), 3));
+                        reply.setValue(device->getName(), "acceleration", actuator->getAcceleration(), 3);
                     } else {
                         actuator->setAcceleration(cmd.getNumericValue());
                         reply.setOK(device->getName(), "acceleration", cmd.getValue());
                     }
-                } else if ((cmd.getInterface() == "zero" || cmd.getInterface() == "setzero") && devType == DeviceType::STEPPER_MOTOR) {
+                } else if (cmd.isInterface("jerk") && devType == DeviceType::STEPPER_MOTOR) {
+                    StepperMotor* stepper = static_cast<StepperMotor*>(actuator);
+                    if (cmd.getIsQuery()) {
+                        reply.setValue(device->getName(), "jerk", stepper->getJerk(), 3);
+                    } else {
+                        stepper->setJerk(cmd.getNumericValue());
+                        reply.setOK(device->getName(), "jerk", cmd.getValue());
+                    }
+                } else if ((cmd.isInterface("zero") || cmd.isInterface("setzero")) && devType == DeviceType::STEPPER_MOTOR) {
                     StepperMotor* stepper = static_cast<StepperMotor*>(actuator);
                     stepper->setZeroPosition();
                     reply.setOK(device->getName(), "zero");
                 } else {
-                    reply.setError(device->getName(), ERROR_UNKNOWN_COMMAND, "Unknown command: " + cmd.getInterface());
+                    reply.setError(device->getName(), ERROR_UNKNOWN_COMMAND, String("Unknown command: ") + cmd.getInterface());
                 }
                 break;
         }
@@ -472,15 +432,15 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
         switch (cmd.getCommandType()) {
             case CommandType::GET:
             case CommandType::READ:
-                reply.setValue(device->getName(), "value", String(sensor->readValue(), 2));
+                reply.setValue(device->getName(), "value", sensor->readValue(), 2);
                 break;
                 
             case CommandType::STATE:
                 if (devType == DeviceType::END_SWITCH) {
                     EndSwitch* sw = static_cast<EndSwitch*>(sensor);
-                    reply.setValue(device->getName(), "state", sw->getState() ? "1" : "0");
+                    reply.setValue(device->getName(), "state", sw->getState() ? 1.0 : 0.0, 0);
                 } else {
-                    reply.setValue(device->getName(), "value", String(sensor->getValue(), 2));
+                    reply.setValue(device->getName(), "value", sensor->getValue(), 2);
                 }
                 break;
                 
@@ -510,6 +470,50 @@ Reply Controller::executeDeviceCommand(Device* device, const Command& cmd) {
     return reply;
 }
 
+/**
+ * @brief Queue a coordinated move of all steppers
+ *
+ * The motion planner blends consecutive moves; the reply reports queue
+ * depth and free slots so the host can keep the queue full.
+ */
+Reply Controller::executeLinearMove(const Command& cmd) {
+    Reply reply;
+    
+    int count = cmd.getParamCount();
+    int numSteppers = getStepperCount();
+    if (numSteppers == 0 || (count != numSteppers && count != numSteppers + 1)) {
+        reply.setError(GROUP_ALL_STEPPERS, ERROR_INVALID_PARAM, "Expected one position per stepper and optional feed");
+        return reply;
+    }
+    
+    LinearMove move;
+    move.axisMask = 0;
+    move.feed = (count > numSteppers) ? abs(cmd.getParam(numSteppers)) : 0.0;
+    
+    for (int i = 0; i < numSteppers; i++) {
+        StepperMotor* stepper = getStepper(i);
+        if (!stepper->prepareLinearMove(cmd.getParam(i), move)) {
+            reply.setError(stepper->getName(), ERROR_DEVICE_BUSY, "Stepper disabled or moving");
+            return reply;
+        }
+    }
+    
+    if (!motionPlanner.bufferLine(move)) {
+        reply.setError(GROUP_ALL_STEPPERS, ERROR_DEVICE_BUSY, "Motion queue full");
+        return reply;
+    }
+    
+    reply.setOK(GROUP_ALL_STEPPERS, "move", getQueueState());
+    return reply;
+}
+
+/**
+ * @brief Format motion queue depth and free slots
+ */
+String Controller::getQueueState() const {
+    return String(motionPlanner.getDepth()) + " " + String(motionPlanner.getFreeSlots());
+}
+
 /**
  * @brief Execute system command
  */
@@ -539,6 +543,75 @@ Reply Controller::executeSystemCommand(const Command& cmd) {
             reply.setOK("CONTROLLER", "reset");
             break;
             
+        case CommandType::WINDOW:
+            reply.setValue("CONTROLLER", "window", COMMAND_WINDOW, 0);
+            break;
+            
+        case CommandType::SUBSCRIBE:
+            if (cmd.getIsQuery()) {
+                // Period followed by the channels in record order
+                String channels = String(telemetry.getPeriod());
+                if (telemetry.getCount() > 0) {
+                    channels += " " + telemetry.describe();
+                }
+                reply.setValue("CONTROLLER", "subscribe", channels);
+            } else if (cmd.getParamCount() == 1 && cmd.getNumericValue() >= 0) {
+                telemetry.setPeriod((unsigned long)cmd.getNumericValue());
+                scheduleTelemetry();
+                reply.setOK("CONTROLLER", "subscribe", String(telemetry.getPeriod()));
+            } else {
+                reply.setError("CONTROLLER", ERROR_INVALID_PARAM, "Expected period in ms (0 pauses)");
+            }
+            break;
+            
+        case CommandType::UNSUBSCRIBE:
+            telemetry.clear();
+            scheduleTelemetry();
+            reply.setOK("CONTROLLER", "unsubscribe");
+            break;
+            
+        case CommandType::TASKS:
+            if (cmd.getIsQuery()) {
+                reply.setInfo(scheduler.getStatus());
+            } else if (strcasecmp(cmd.getValue(), "reset") == 0) {
+                scheduler.resetStatistics();
+                reply.setOK("CONTROLLER", "tasks", "reset");
+            } else {
+                reply.setError("CONTROLLER", ERROR_INVALID_PARAM, "Expected tasks? or tasks reset");
+            }
+            break;
+            
+        case CommandType::PERF:
+            #if ENABLE_PROFILING
+                if (cmd.getIsQuery()) {
+                    reply.setInfo(profiler.getReport());
+                } else if (strcasecmp(cmd.getValue(), "reset") == 0) {
+                    profiler.reset();
+                    reply.setOK("CONTROLLER", "perf", "reset");
+                } else {
+                    reply.setError("CONTROLLER", ERROR_INVALID_PARAM, "Expected perf? or perf reset");
+                }
+            #else
+                reply.setError("CONTROLLER", ERROR_UNKNOWN_COMMAND, "Profiling disabled (ENABLE_PROFILING)");
+            #endif
+            break;
+            
+        case CommandType::PROTOCOL:
+            if (cmd.getIsQuery()) {
+                bool binary = interface && interface->getProtocol() == ProtocolMode::BINARY;
+                reply.setValue("CONTROLLER", "protocol", binary ? "binary" : "text");
+            } else if (strcasecmp(cmd.getValue(), "text") == 0) {
+                if (interface) interface->setProtocol(ProtocolMode::TEXT);
+                reply.setOK("CONTROLLER", "protocol", "text");
+            } else if (strcasecmp(cmd.getValue(), "binary") == 0 && ENABLE_BINARY_MODE) {
+                // Takes effect after this reply has been sent as text
+                if (interface) interface->setProtocol(ProtocolMode::BINARY);
+                reply.setOK("CONTROLLER", "protocol", "binary");
+            } else {
+                reply.setError("CONTROLLER", ERROR_INVALID_PARAM, "Expected text or binary");
+            }
+            break;
+            
         default:
             reply.setError("CONTROLLER", ERROR_UNKNOWN_COMMAND, "Unknown system command");
             break;
@@ -565,22 +638,135 @@ Reply Controller::executeServiceCommand(const Command& cmd) {
     
     bool success = false;
     
-    if (service == "CALIBRATE_X") {
-        success = calibrateAxis("X");
-    } else if (service == "CALIBRATE_Y") {
-        success = calibrateAxis("Y");
-    } else if (service == "CALIBRATE_Z") {
-        success = calibrateAxis("Z");
-    } else if (service == "CALIBRATE_ALL") {
-        success = calibrateAxis("X") && 
-                  calibrateAxis("Y") && 
-                  calibrateAxis("Z");
+    if (service.startsWith("HOME_") || service.startsWith("CALIBRATE_")) {
+        // Homing runs in the background; completion is reported by updateHoming()
+        if (isHoming()) {
+            reply.setError("SERVICE", ERROR_DEVICE_BUSY, "Homing in progress");
+            return reply;
+        }
+        
+        String axis = service.substring(service.indexOf('_') + 1);
+        bool started = true;
+        String skipped;             // Axes without a home switch
+        if (axis == "ALL") {
+            // All axes with a home switch home in parallel
+            uint8_t homed = 0;
+            for (uint8_t i = 0; i < getStepperCount(); i++) {
+                if (getHomeSwitch(getStepper(i))) {
+                    started = started && startHoming(getStepper(i)->getName());
+                    homed++;
+                } else {
+                    skipped += " " + getStepper(i)->getName();
+                }
+            }
+            if (homed == 0) {
+                // No origin was set; DONE would tell the host otherwise
+                reply.setError("SERVICE", ERROR_HARDWARE_FAULT, "No axis has a home switch, skipped" + skipped);
+                return reply;
+            }
+        } else if (getDeviceByName(axis.c_str()) && getDeviceByName(axis.c_str())->getType() == DeviceType::STEPPER_MOTOR) {
+            started = startHoming(axis);
+        } else {
+            reply.setError("SERVICE", ERROR_UNKNOWN_COMMAND, "Unknown service: " + service);
+            return reply;
+        }
+        
+        if (!started) {
+            abortHoming();
+            reply.setError("SERVICE", ERROR_HARDWARE_FAULT, "Cannot home " + axis);
+            return reply;
+        }
+        
+        homingService = service;
+        reply.setOK("SERVICE", service, skipped.length() > 0 ? "skipped" + skipped : "");
+        return reply;
+    } else if (service.startsWith("AUTOTUNE_")) {
+        // Runs in the background; completion is reported by updateHeaters()
+        String outputName = service.substring(9);
+        HeaterLoop* heater = nullptr;
+        for (int i = 0; i < numHeaters; i++) {
+            String name = heaters[i].getOutput()->getName();
+            name.toUpperCase();
+            if (name == outputName) heater = &heaters[i];
+        }
+        
+        if (!heater) {
+            reply.setError("SERVICE", ERROR_UNKNOWN_DEVICE, "No heater loop on " + outputName);
+            return reply;
+        }
+        if (!heater->startAutotune(cmd.getParam(1))) {
+            reply.setError("SERVICE", ERROR_INVALID_PARAM, "Expected temperature up to " + String(HEATER_MAX_TEMP, 0));
+            return reply;
+        }
+        
+        reply.setOK("SERVICE", service);
+        return reply;
     } else if (service == "FULL_STATUS") {
         reply.setInfo(getSystemStatus() + "\n" + getDeviceList());
         return reply;
     } else if (service == "ESTOP") {
         emergencyStopAll();
         success = true;
+    } else if (service == "PARSE_BENCHMARK") {
+        // Typical traffic: single value, multi-value, keyword value, query, system
+        static const char* const samples[] = {
+            ">X position 3.14",
+            ">STEPPERS move 1.0 0.5 0.2 2.0",
+            ">MainLight ON",
+            ">XMin state?",
+            ">CONTROLLER STATUS"
+        };
+        const uint8_t numSamples = sizeof(samples) / sizeof(samples[0]);
+        
+        Command sample;
+        bool parsed = true;
+        unsigned long start = micros();
+        for (uint16_t n = 0; n < PARSE_BENCHMARK_ITERATIONS; n++) {
+            for (uint8_t i = 0; i < numSamples; i++) {
+                parsed &= sample.parse(samples[i]);
+            }
+        }
+        unsigned long elapsed = micros() - start;
+        
+        float perCommand = (float)elapsed / ((float)PARSE_BENCHMARK_ITERATIONS * numSamples);
+        reply.setInfo("PARSE_BENCHMARK " + String(perCommand, 2) + " us/command" +
+                      (parsed ? "" : " (parse failed)"));
+        return reply;
+    } else if (service == "STEP_BENCHMARK") {
+        uint32_t pinMicros = 0;
+        uint32_t portMicros = 0;
+        if (!stepGenerator.benchmarkOutput(STEP_BENCHMARK_ITERATIONS, pinMicros, portMicros)) {
+            reply.setError("SERVICE", ERROR_DEVICE_BUSY, "Steppers must be idle");
+            return reply;
+        }
+        
+        // Output cost per step and the step rate it alone would allow
+        float steps = (float)STEP_BENCHMARK_ITERATIONS * getStepperCount();
+        float pinCost = pinMicros / steps;
+        float portCost = portMicros / steps;
+        reply.setInfo("STEP_BENCHMARK digitalWrite " + String(pinCost, 2) + " us/step (max " +
+                      String((long)(1000000.0 / pinCost)) + " steps/s), port " +
+                      String(portCost, 2) + " us/step (max " +
+                      String((long)(1000000.0 / portCost)) + " steps/s)");
+        return reply;
+    } else if (service == "THERMISTOR_BENCHMARK") {
+        // First sensor configured as a thermistor
+        for (uint8_t id = 0; id < registry.getCount(); id++) {
+            if (registry.get(id)->getType() != DeviceType::ANALOG_SENSOR) continue;
+            AnalogSensor* sensor = static_cast<AnalogSensor*>(registry.get(id));
+            uint32_t tableMicros = 0;
+            uint32_t exactMicros = 0;
+            float maxError = 0.0;
+            if (sensor->benchmarkThermistor(THERMISTOR_BENCHMARK_ITERATIONS, tableMicros, exactMicros, maxError)) {
+                reply.setInfo("THERMISTOR_BENCHMARK " + sensor->getName() + " table " +
+                              String((float)tableMicros / THERMISTOR_BENCHMARK_ITERATIONS, 2) + " us, log() " +
+                              String((float)exactMicros / THERMISTOR_BENCHMARK_ITERATIONS, 2) +
+                              " us per conversion, max error " + String(maxError, 3) + " C");
+                return reply;
+            }
+        }
+        reply.setError("SERVICE", ERROR_UNKNOWN_DEVICE, "No thermistor configured");
+        return reply;
     } else {
         reply.setError("SERVICE", ERROR_UNKNOWN_COMMAND, "Unknown service: " + service);
         return reply;
@@ -596,105 +782,71 @@ Reply Controller::executeServiceCommand(const Command& cmd) {
 }
 
 /**
- * @brief Get device by name
+ * @brief Get numeric id of a device
  */
-Device* Controller::getDeviceByName(const String& name) {
-    // Search steppers
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i] && steppers[i]->getName() == name) {
-            return steppers[i];
-        }
-    }
-    
-    // Search servos
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i] && servos[i]->getName() == name) {
-            return servos[i];
-        }
-    }
-    
-    // Search MOSFETs
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i] && mosfets[i]->getName() == name) {
-            return mosfets[i];
-        }
-    }
+int Controller::getDeviceId(const String& name) const {
+    uint8_t id = registry.find(name.c_str());
+    return (id == DEVICE_NONE) ? -1 : id;
+}
+
+/**
+ * @brief Get the stepper of an axis slot
+ */
+StepperMotor* Controller::getStepper(uint8_t axis) const {
+    if (axis >= getStepperCount()) return nullptr;
+    return static_cast<StepperMotor*>(registry.get(axis));
+}
+
+/**
+ * @brief Execute a binary protocol request
+ *
+ * The packet is turned into a Command addressing the device by name, so
+ * binary and text commands share one execution path.
+ */
+Reply Controller::executeBinary(const BinaryPacket& packet) {
+    Reply reply;
     
-    // Search switches
-    for (int i = 0; i < numSwitches; i++) {
-        if (switches[i] && switches[i]->getName() == name) {
-            return switches[i];
+    const char* name;
+    if (packet.deviceId == BINARY_ID_CONTROLLER) {
+        name = "CONTROLLER";
+    } else if (BinaryProtocol::groupName(packet.deviceId)) {
+        name = BinaryProtocol::groupName(packet.deviceId);
+    } else {
+        Device* device = getDeviceById(packet.deviceId);
+        if (!device) {
+            reply.setError("", ERROR_UNKNOWN_DEVICE, "Unknown device id");
+            return reply;
         }
+        name = device->getName().c_str();
     }
     
-    // Search analog sensors
-    for (int i = 0; i < numAnalogSensors; i++) {
-        if (analogSensors[i] && analogSensors[i]->getName() == name) {
-            return analogSensors[i];
-        }
+    Command cmd;
+    if (!BinaryProtocol::toCommand(packet, name, cmd)) {
+        reply.setError(name, ERROR_UNKNOWN_COMMAND, "Invalid opcode or payload");
+        return reply;
     }
     
-    return nullptr;
+    return executeCommand(cmd);
 }
 
 /**
  * @brief Get devices by group
  */
-int Controller::getDevicesByGroup(const String& groupName, Device** devices, int maxDevices) {
-    int count = 0;
-    
-    if (groupName == GROUP_ALL_STEPPERS) {
-        for (int i = 0; i < numSteppers && count < maxDevices; i++) {
-            if (steppers[i]) devices[count++] = steppers[i];
-        }
-    } else if (groupName == GROUP_ALL_SERVOS) {
-        for (int i = 0; i < numServos && count < maxDevices; i++) {
-            if (servos[i]) devices[count++] = servos[i];
-        }
-    } else if (groupName == GROUP_ALL_OUTPUTS) {
-        for (int i = 0; i < numMosfets && count < maxDevices; i++) {
-            if (mosfets[i]) devices[count++] = mosfets[i];
-        }
-    } else if (groupName == GROUP_ALL_SWITCHES) {
-        for (int i = 0; i < numSwitches && count < maxDevices; i++) {
-            if (switches[i]) devices[count++] = switches[i];
-        }
-    } else if (groupName == GROUP_ALL_SENSORS) {
-        for (int i = 0; i < numSwitches && count < maxDevices; i++) {
-            if (switches[i]) devices[count++] = switches[i];
-        }
-        for (int i = 0; i < numAnalogSensors && count < maxDevices; i++) {
-            if (analogSensors[i]) devices[count++] = analogSensors[i];
-        }
-    } else if (groupName == GROUP_ALL_ACTUATORS) {
-        for (int i = 0; i < numSteppers && count < maxDevices; i++) {
-            if (steppers[i]) devices[count++] = steppers[i];
-        }
-        for (int i = 0; i < numServos && count < maxDevices; i++) {
-            if (servos[i]) devices[count++] = servos[i];
-        }
-        for (int i = 0; i < numMosfets && count < maxDevices; i++) {
-            if (mosfets[i]) devices[count++] = mosfets[i];
-        }
-    }
-    
-    return count;
+DeviceMask Controller::getDevicesByGroup(const char* groupName) const {
+    DeviceGroup group;
+    if (!DeviceRegistry::parseGroup(groupName, group)) return 0;
+    return registry.getGroup(group);
 }
 
 /**
  * @brief Stop all actuators
  */
 void Controller::stopAllActuators() {
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i]) steppers[i]->stop();
-    }
-    
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i]) servos[i]->stop();
-    }
-    
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i]) mosfets[i]->stop();
+    DeviceMask members = registry.getGroup(DeviceGroup::ACTUATORS);
+    for (uint8_t id = 0; members; id++, members >>= 1) {
+        if (members & 1) {
+            registry.get(id)->stop();
+        }
     }
 }
 
@@ -704,19 +856,25 @@ void Controller::stopAllActuators() {
 void Controller::emergencyStopAll() {
     emergencyStop = true;
     
-    // Immediately stop all steppers
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i]) steppers[i]->emergencyStop();
-    }
+    // Fail any homing in progress (the steppers are halted below)
+    abortHoming();
     
-    // Stop servos
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i]) servos[i]->stop();
+    // Drop heater setpoints so nothing restarts after a reset
+    for (int i = 0; i < numHeaters; i++) {
+        heaters[i].disable();
     }
     
-    // Turn off all outputs
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i]) mosfets[i]->turnOff();
+    // Halt steppers immediately and turn off servos and outputs now;
+    // update() does not run while e-stopped
+    DeviceMask members = registry.getGroup(DeviceGroup::ACTUATORS);
+    for (uint8_t id = 0; members; id++, members >>= 1) {
+        if (!(members & 1)) continue;
+        Device* device = registry.get(id);
+        if (device->getType() == DeviceType::STEPPER_MOTOR) {
+            static_cast<StepperMotor*>(device)->emergencyStop();
+        } else {
+            device->stop();
+        }
     }
 }
 
@@ -728,12 +886,24 @@ String Controller::getSystemStatus() const {
     status += "Controller: " + String(initialized ? "INITIALIZED" : "NOT INITIALIZED");
     status += ", E-Stop: " + String(emergencyStop ? "ACTIVE" : "INACTIVE");
     status += "\nDevices: ";
-    status += String(numSteppers) + " steppers, ";
-    status += String(numServos) + " servos, ";
-    status += String(numMosfets) + " outputs, ";
-    status += String(numSwitches) + " switches, ";
-    status += String(numAnalogSensors) + " analog sensors";
+    status += String(registry.getGroupCount(DeviceGroup::STEPPERS)) + " steppers, ";
+    status += String(registry.getGroupCount(DeviceGroup::SERVOS)) + " servos, ";
+    status += String(registry.getGroupCount(DeviceGroup::OUTPUTS)) + " outputs, ";
+    status += String(registry.getGroupCount(DeviceGroup::SWITCHES)) + " switches, ";
+    status += String(registry.getGroupCount(DeviceGroup::SENSORS) - registry.getGroupCount(DeviceGroup::SWITCHES)) + " analog sensors";
     status += "\nUptime: " + String(millis() / 1000) + " seconds";
+    for (int i = 0; i < numHeaters; i++) {
+        const HeaterLoop& heater = heaters[i];
+        status += "\nHeater " + heater.getOutput()->getName() + ": sensor " + heater.getSensor()->getName();
+        status += ", target " + String(heater.getTarget(), 1);
+        status += ", duty " + String(heater.getDuty(), 3);
+        if (heater.getAutotune().isActive()) {
+            status += ", AUTOTUNE";
+        }
+    }
+    if (interface) {
+        status += "\n" + interface->getStatistics();
+    }
     
     return status;
 }
@@ -744,53 +914,41 @@ String Controller::getSystemStatus() const {
 String Controller::getDeviceList() const {
     String list = "=== DEVICE LIST ===\n";
     
-    // List steppers
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i]) {
-            list += "- " + steppers[i]->getName() + " (" + steppers[i]->getTypeString() + "): ";
-            list += "interfaces [" + steppers[i]->getInterfaces() + "]\n";
-            list += "  Commands: >" + steppers[i]->getName() + " enable | position <rad> | velocity <rad/s> | acceleration <rad/s²> | zero | stop\n";
-        }
-    }
-    
-    // List servos
-    for (int i = 0; i < numServos; i++) {
-        if (servos[i]) {
-            list += "- " + servos[i]->getName() + " (" + servos[i]->getTypeString() + "): ";
-            list += "interfaces [" + servos[i]->getInterfaces() + "]\n";
-            list += "  Commands: >" + servos[i]->getName() + " position <rad> | velocity <rad/s> | stop\n";
-        }
-    }
-    
-    // List MOSFETs
-    for (int i = 0; i < numMosfets; i++) {
-        if (mosfets[i]) {
-            list += "- " + mosfets[i]->getName() + " (" + mosfets[i]->getTypeString() + "): ";
-            list += "interfaces [" + mosfets[i]->getInterfaces() + "]\n";
-            list += "  Commands: >" + mosfets[i]->getName() + " ON | OFF | position <0-1> | velocity <change/s>\n";
-        }
-    }
-    
-    // List switches
-    for (int i = 0; i < numSwitches; i++) {
-        if (switches[i]) {
-            list += "- " + switches[i]->getName() + " (" + switches[i]->getTypeString() + "): ";
-            list += "interfaces [" + switches[i]->getInterfaces() + "]\n";
-            list += "  Commands: >" + switches[i]->getName() + " read | state?\n";
-        }
-    }
-    
-    // List analog sensors
-    for (int i = 0; i < numAnalogSensors; i++) {
-        if (analogSensors[i]) {
-            list += "- " + analogSensors[i]->getName() + " (" + analogSensors[i]->getTypeString() + "): ";
-            list += "interfaces [" + analogSensors[i]->getInterfaces() + "]\n";
-            list += "  Commands: >" + analogSensors[i]->getName() + " read | value?\n";
+    for (uint8_t id = 0; id < registry.getCount(); id++) {
+        const Device* device = registry.get(id);
+        list += "- " + device->getName() + " (" + device->getTypeString() + ") id " + String(id) + ": ";
+        list += "interfaces [" + device->getInterfaces() + "]\n";
+        list += "  Commands: >" + device->getName();
+        
+        switch (device->getType()) {
+            case DeviceType::STEPPER_MOTOR:
+                list += " enable | position <rad> | velocity <rad/s> | acceleration <rad/s²> | jerk <rad/s³> | zero | stop";
+                break;
+            case DeviceType::SERVO_MOTOR:
+                list += " position <rad> | velocity <rad/s> | stop";
+                break;
+            case DeviceType::MOSFET_OUTPUT:
+                list += " ON | OFF | position <0-1> | velocity <change/s>";
+                for (int h = 0; h < numHeaters; h++) {
+                    if (heaters[h].getOutput() == device) {
+                        list += " | setpoint <C> | pid <kp> <ki> <kd>";
+                    }
+                }
+                break;
+            case DeviceType::END_SWITCH:
+                list += " read | state?";
+                break;
+            default:
+                list += " read | value?";
+                break;
         }
+        list += "\n";
     }
     
     list += "\nBulk commands: >STEPPERS velocity 0 | >SERVOS position 0 | >OUTPUTS OFF\n";
-    list += "System: >CONTROLLER STATUS | PING | ESTOP\n";
+    list += "Linear move: >STEPPERS move <x> <y> <z> [feed] | queue?\n";
+    list += "System: >CONTROLLER STATUS | PING | ESTOP | window? | tasks? | tasks reset | perf? | perf reset | protocol <text|binary>\n";
+    list += "Pipelining: prefix commands with #<n> to get #<n> on the reply\n";
     
     return list;
 }
@@ -807,74 +965,153 @@ void Controller::handleSwitchChange(const String& switchName, bool state) {
 }
 
 /**
- * @brief Calibrate axis (homing)
+ * @brief Start homing an axis
  */
-bool Controller::calibrateAxis(const String& axisName) {
-    // Find the stepper motor
-    StepperMotor* stepper = nullptr;
-    for (int i = 0; i < numSteppers; i++) {
-        if (steppers[i] && steppers[i]->getName() == axisName) {
-            stepper = steppers[i];
-            break;
-        }
-    }
-    
+bool Controller::startHoming(const String& axisName) {
+    // Stepper ids are their axis slots
+    uint8_t index = registry.find(axisName.c_str());
+    StepperMotor* stepper = (index < NUM_STEPPERS) ? getStepper(index) : nullptr;
     if (!stepper) return false;
     
-    // Find corresponding home switch
-    EndSwitch* homeSwitch = nullptr;
-    String switchName = "";
+    EndSwitch* homeSwitch = getHomeSwitch(stepper);
+    if (!homeSwitch) return false;
     
-    if (axisName == STEPPER_X_NAME) {
-        switchName = SWITCH_X_MIN_NAME;
-    } else if (axisName == STEPPER_Y_NAME) {
-        switchName = SWITCH_Y_MIN_NAME;
-    } else if (axisName == STEPPER_Z_NAME) {
-        switchName = SWITCH_Z_MIN_NAME;
-    }
+    if (!homing[index].begin(stepper, homeSwitch)) return false;
     
-    for (int i = 0; i < numSwitches; i++) {
-        if (switches[i] && switches[i]->getName() == switchName) {
-            homeSwitch = switches[i];
-            break;
+    reportEvent(axisName, "home", AxisHoming::getStateName(homing[index].getState()));
+    return true;
+}
+
+/**
+ * @brief Get the home switch of an axis
+ */
+EndSwitch* Controller::getHomeSwitch(const StepperMotor* stepper) const {
+    // Homing approaches in the negative direction
+    DeviceMask members = registry.getGroup(DeviceGroup::SWITCHES);
+    for (uint8_t id = 0; members; id++, members >>= 1) {
+        if (!(members & 1)) continue;
+        EndSwitch* sw = static_cast<EndSwitch*>(registry.get(id));
+        if (sw->getBoundMotor() == stepper && sw->getLimitDirection() < 0) {
+            return sw;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Advance homing sequences
+ */
+void Controller::updateHoming() {
+    bool active = false;
+    bool failed = false;
+    
+    for (int i = 0; i < getStepperCount() && i < NUM_STEPPERS; i++) {
+        if (!homing[i].isActive()) {
+            if (homing[i].getState() == HomingState::FAILED) failed = true;
+            continue;
+        }
+        
+        if (homing[i].update()) {
+            HomingState state = homing[i].getState();
+            String value = AxisHoming::getStateName(state);
+            if (state == HomingState::DONE) {
+                // Offset of the switch from the previous zero
+                value += " " + String(homing[i].getLatchedSteps());
+            }
+            reportEvent(getStepper(i)->getName(), "home", value);
+        }
+        
+        if (homing[i].isActive()) {
+            active = true;
+        } else if (homing[i].getState() == HomingState::FAILED) {
+            failed = true;
         }
     }
     
-    if (!homeSwitch) return false;
-    
-    // Enable stepper
-    stepper->enable();
-    
-    // Move slowly towards home switch
-    stepper->setVelocity(-CALIBRATION_SPEED / stepper->getStepsPerUnit());
+    // Finish the service once every axis it started has settled
+    if (active || homingService.length() == 0) return;
     
-    // Wait for switch to trigger
-    unsigned long startTime = millis();
-    while (!homeSwitch->isPressed() && (millis() - startTime) < CALIBRATION_TIMEOUT_MS) {
-        stepper->update();
-        homeSwitch->update();
-        delay(1);
+    if (SERVICE_NOTIFY_DONE && interface) {
+        Reply doneReply;
+        doneReply.setInfo("SERVICE " + homingService + (failed ? " FAILED" : " DONE"));
+        interface->sendReply(doneReply);
+    }
+    homingService = "";
+}
+
+/**
+ * @brief Check if any axis is homing
+ */
+bool Controller::isHoming() const {
+    for (int i = 0; i < NUM_STEPPERS; i++) {
+        if (homing[i].isActive()) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Abort all homing sequences
+ */
+void Controller::abortHoming() {
+    for (int i = 0; i < getStepperCount() && i < NUM_STEPPERS; i++) {
+        if (homing[i].isActive()) {
+            homing[i].abort();
+            reportEvent(getStepper(i)->getName(), "home", AxisHoming::getStateName(homing[i].getState()));
+        }
     }
     
-    // Stop motor
-    stepper->stop();
+    if (homingService.length() > 0 && SERVICE_NOTIFY_DONE && interface) {
+        Reply doneReply;
+        doneReply.setInfo("SERVICE " + homingService + " FAILED");
+        interface->sendReply(doneReply);
+    }
+    homingService = "";
+}
+
+/**
+ * @brief Subscribe or unsubscribe a device value
+ */
+Reply Controller::executeSubscription(Device* device, const Command& cmd) {
+    Reply reply;
     
-    // Check if we hit the switch
-    if (!homeSwitch->isPressed()) {
-        return false;  // Timeout
+    if (cmd.getCommandType() == CommandType::UNSUBSCRIBE) {
+        telemetry.remove(device);
+        scheduleTelemetry();
+        reply.setOK(device->getName(), "unsubscribe");
+        return reply;
     }
     
-    // Back off slightly
-    stepper->setPosition(5.0 / stepper->getStepsPerUnit());  // 5 steps back
-    while (!stepper->isAtTarget()) {
-        stepper->update();
-        delay(1);
+    TelemetrySource source = Telemetry::defaultSource(device);
+    if (cmd.getValue()[0] != '\0' && !Telemetry::parseSource(cmd.getValue(), device, source)) {
+        reply.setError(device->getName(), ERROR_INVALID_PARAM, String("Cannot subscribe to ") + cmd.getValue());
+        return reply;
     }
     
-    // Set zero position
-    stepper->setZeroPosition();
+    if (!telemetry.add(device, source)) {
+        reply.setError(device->getName(), ERROR_DEVICE_BUSY, "Telemetry channels full");
+        return reply;
+    }
+    scheduleTelemetry();
     
-    return true;
+    reply.setOK(device->getName(), "subscribe", Telemetry::getSourceName(source));
+    return reply;
+}
+
+/**
+ * @brief Send a telemetry record when one is due
+ */
+void Controller::updateTelemetry() {
+    unsigned long now = millis();
+    if (interface && telemetry.isDue(now)) {
+        interface->sendTelemetry(telemetry, now);
+    }
+}
+
+/**
+ * @brief Run the telemetry task only while channels stream
+ */
+void Controller::scheduleTelemetry() {
+    scheduler.setEnabled(telemetryTaskId, telemetry.getPeriod() > 0 && telemetry.getCount() > 0);
 }
 
 /**
@@ -886,4 +1123,88 @@ void Controller::reportEvent(const String& device, const String& eventType, cons
         event.setEvent(device, eventType, value);
         interface->sendReply(event);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Run the heater loops
+ */
+void Controller::updateHeaters() {
+    unsigned long now = millis();
+    
+    for (int i = 0; i < numHeaters; i++) {
+        bool finished = heaters[i].update(now);
+        
+        // A thermal fault stops the whole machine
+        ThermalFault fault = heaters[i].getFault();
+        if (fault != ThermalFault::NONE) {
+            if (interface) {
+                Reply event(heaters[i].getOutput()->getName());
+                event.setEvent(heaters[i].getOutput()->getName(), "thermal",
+                               String(ThermalProtection::getFaultName(fault)) + " " +
+                               String(heaters[i].getSensor()->getValue(), 1));
+                interface->sendReply(event, TxPriority::URGENT);
+            }
+            emergencyStopAll();
+            return;
+        }
+        
+        if (!finished || !SERVICE_NOTIFY_DONE || !interface) continue;
+        
+        // Autotune finished; report the gains it applied
+        const RelayAutotune& tune = heaters[i].getAutotune();
+        String service = "AUTOTUNE_" + heaters[i].getOutput()->getName();
+        service.toUpperCase();
+        
+        Reply doneReply;
+        if (tune.getState() == AutotuneState::DONE) {
+            doneReply.setInfo("SERVICE " + service + " DONE Kp " + String(tune.getKp(), 4) +
+                              " Ki " + String(tune.getKi(), 5) + " Kd " + String(tune.getKd(), 4));
+        } else {
+            doneReply.setInfo("SERVICE " + service + " FAILED");
+        }
+        interface->sendReply(doneReply);
+    }
+}
+
+/**
+ * @brief Get the heater loop driving an output
+ */
+HeaterLoop* Controller::getHeaterLoop(const Device* device) {
+    for (int i = 0; i < numHeaters; i++) {
+        if (heaters[i].getOutput() == device) return &heaters[i];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Execute a heater loop command
+ */
+bool Controller::executeHeaterCommand(HeaterLoop* heater, const Command& cmd, Reply& reply) {
+    String name = heater->getOutput()->getName();
+    
+    if (cmd.isInterface("setpoint")) {
+        if (cmd.getIsQuery()) {
+            reply.setValue(name, "setpoint", heater->getTarget(), 1);
+        } else if (cmd.getParamCount() == 1 && heater->setTarget(cmd.getNumericValue())) {
+            reply.setOK(name, "setpoint", cmd.getValue());
+        } else {
+            reply.setError(name, ERROR_INVALID_PARAM, "Expected setpoint 0-" + String(HEATER_MAX_TEMP, 0));
+        }
+        return true;
+    }
+    
+    if (cmd.isInterface("pid")) {
+        PidController& pid = heater->getPid();
+        if (cmd.getIsQuery()) {
+            reply.setValue(name, "pid", String(pid.getKp(), 4) + " " + String(pid.getKi(), 5) + " " + String(pid.getKd(), 4));
+        } else if (cmd.getParamCount() == 3 && cmd.getParam(0) >= 0 && cmd.getParam(1) >= 0 && cmd.getParam(2) >= 0) {
+            pid.setGains(cmd.getParam(0), cmd.getParam(1), cmd.getParam(2));
+            reply.setOK(name, "pid");
+        } else {
+            reply.setError(name, ERROR_INVALID_PARAM, "Expected pid <kp> <ki> <kd>");
+        }
+        return true;
+    }
+    
+    return false;
+}
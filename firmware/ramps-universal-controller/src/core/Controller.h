@@ -17,6 +17,12 @@
 #include "../devices/Sensor.h"
 #include "Command.h"
 #include "Reply.h"
+#include "BinaryProtocol.h"
+#include "Telemetry.h"
+#include "Scheduler.h"
+#include "DeviceRegistry.h"
+#include "../motion/Homing.h"
+#include "../control/HeaterLoop.h"
 
 // Forward declarations
 class StepperMotor;
@@ -34,19 +40,8 @@ class Interface;
  */
 class Controller {
 private:
-    // Device arrays
-    StepperMotor** steppers;
-    ServoMotor** servos;
-    MosfetOutput** mosfets;
-    EndSwitch** switches;
-    AnalogSensor** analogSensors;
-    
-    // Device counts
-    int numSteppers;
-    int numServos;
-    int numMosfets;
-    int numSwitches;
-    int numAnalogSensors;
+    // All devices, indexed by id (steppers first); storage is in DeviceTable
+    DeviceRegistry registry;
     
     // Interface for communication
     Interface* interface;
@@ -54,7 +49,18 @@ private:
     // System state
     bool initialized;
     bool emergencyStop;
-    unsigned long lastStatusTime;
+    
+    // Homing
+    AxisHoming homing[NUM_STEPPERS];    // One sequence per stepper slot
+    String homingService;               // Service waiting for homing to finish
+    
+    // Telemetry subscriptions
+    Telemetry telemetry;
+    uint8_t telemetryTaskId;            // Scheduler task, enabled while records stream
+    
+    // Closed-loop heaters
+    HeaterLoop heaters[NUM_HEATERS];
+    int numHeaters;
     
 public:
     /**
@@ -62,22 +68,15 @@ public:
      */
     Controller();
     
-    /**
-     * @brief Destructor
-     */
-    ~Controller();
-    
     /**
      * @brief Initialize the controller and all devices
+     *
+     * Registers one scheduler task per device and one for each of the
+     * heater, homing and telemetry loops.
      * @return true if successful
      */
     bool init();
     
-    /**
-     * @brief Update all devices (call in main loop)
-     */
-    void update();
-    
     /**
      * @brief Execute a command
      * @param cmd Command to execute
@@ -90,25 +89,35 @@ public:
      * @param name Device name
      * @return Pointer to device or nullptr
      */
-    Device* getDeviceByName(const String& name);
+    Device* getDeviceByName(const char* name) { return registry.findDevice(name); }
+    
+    /**
+     * @brief Get device by numeric id
+     * @param id Registry id (steppers, servos, outputs, switches, sensors)
+     * @return Pointer to device or nullptr
+     */
+    Device* getDeviceById(uint8_t id) { return registry.get(id); }
     
     /**
-     * @brief Get all devices of a specific type
-     * @param type Device type
-     * @param devices Array to fill with device pointers
-     * @param maxDevices Maximum array size
-     * @return Number of devices found
+     * @brief Get numeric id of a device
+     * @param name Device name
+     * @return Registry id, -1 if unknown
      */
-    int getDevicesByType(DeviceType type, Device** devices, int maxDevices);
+    int getDeviceId(const String& name) const;
     
     /**
-     * @brief Get all devices in a group
+     * @brief Execute a binary protocol request
+     * @param packet Decoded request packet
+     * @return Reply with result
+     */
+    Reply executeBinary(const BinaryPacket& packet);
+    
+    /**
+     * @brief Get the members of a bulk command group
      * @param groupName Group name (e.g., "STEPPERS")
-     * @param devices Array to fill with device pointers
-     * @param maxDevices Maximum array size
-     * @return Number of devices found
+     * @return Mask of device ids, 0 if the group is unknown or empty
      */
-    int getDevicesByGroup(const String& groupName, Device** devices, int maxDevices);
+    DeviceMask getDevicesByGroup(const char* groupName) const;
     
     /**
      * @brief Stop all actuators
@@ -159,7 +168,7 @@ public:
     
 private:
     /**
-     * @brief Create and configure all devices
+     * @brief Register the configured devices and bind switches and heaters
      */
     void createDevices();
     
@@ -169,6 +178,41 @@ private:
      */
     bool initializeDevices();
     
+    /**
+     * @brief Register the device and control loop tasks with the scheduler
+     */
+    void registerTasks();
+    
+    /**
+     * @brief Scheduler task: update one device
+     * @param device Device to update
+     */
+    static void deviceTask(void* device);
+    
+    /**
+     * @brief Scheduler task: update one end switch and report its changes
+     * @param endSwitch Switch to update
+     */
+    static void switchTask(void* endSwitch);
+    
+    /**
+     * @brief Scheduler task: run the heater loops
+     * @param self Controller
+     */
+    static void heaterTask(void* self);
+    
+    /**
+     * @brief Scheduler task: advance homing
+     * @param self Controller
+     */
+    static void homingTask(void* self);
+    
+    /**
+     * @brief Scheduler task: send a telemetry record when one is due
+     * @param self Controller
+     */
+    static void telemetryTask(void* self);
+    
     /**
      * @brief Execute device-specific command
      * @param device Target device
@@ -177,6 +221,19 @@ private:
      */
     Reply executeDeviceCommand(Device* device, const Command& cmd);
     
+    /**
+     * @brief Queue a coordinated move of all steppers
+     * @param cmd Move command (one position per stepper, optional feed)
+     * @return Reply with result and queue state
+     */
+    Reply executeLinearMove(const Command& cmd);
+    
+    /**
+     * @brief Format motion queue depth and free slots
+     * @return "<depth> <free>"
+     */
+    String getQueueState() const;
+    
     /**
      * @brief Execute system command
      * @param cmd Command to execute
@@ -191,6 +248,19 @@ private:
      */
     Reply executeServiceCommand(const Command& cmd);
     
+    /**
+     * @brief Get the stepper of an axis slot
+     * @param axis Axis slot (stepper ids start at 0)
+     * @return Stepper or nullptr
+     */
+    StepperMotor* getStepper(uint8_t axis) const;
+    
+    /**
+     * @brief Get the number of steppers
+     * @return Stepper count
+     */
+    uint8_t getStepperCount() const { return registry.getGroupCount(DeviceGroup::STEPPERS); }
+    
     /**
      * @brief Handle switch state change
      * @param switchName Switch that changed
@@ -199,11 +269,94 @@ private:
     void handleSwitchChange(const String& switchName, bool state);
     
     /**
-     * @brief Calibrate axis (homing)
-     * @param axisName Axis to calibrate
-     * @return true if successful
+     * @brief Bind an end switch to the axis it limits
+     * @param switchName End switch
+     * @param axisName Stepper
+     * @param direction Blocked travel (-1 min end, +1 max end, 0 none)
+     */
+    void bindSwitch(const char* switchName, const char* axisName, int8_t direction);
+    
+    /**
+     * @brief Get the home switch of an axis
+     * @param stepper Axis
+     * @return Switch bound to its min end, or nullptr
+     */
+    EndSwitch* getHomeSwitch(const StepperMotor* stepper) const;
+    
+    /**
+     * @brief Start homing an axis (non-blocking)
+     * @param axisName Axis to home
+     * @return true if the sequence started
+     */
+    bool startHoming(const String& axisName);
+    
+    /**
+     * @brief Advance homing sequences, report progress and finish the service
+     */
+    void updateHoming();
+    
+    /**
+     * @brief Check if any axis is homing
+     * @return true if a sequence is in progress
+     */
+    bool isHoming() const;
+    
+    /**
+     * @brief Abort all homing sequences
+     */
+    void abortHoming();
+    
+    /**
+     * @brief Subscribe or unsubscribe a device value
+     * @param device Target device
+     * @param cmd SUBSCRIBE or UNSUBSCRIBE command (value names the source)
+     * @return Reply with result
+     */
+    Reply executeSubscription(Device* device, const Command& cmd);
+    
+    /**
+     * @brief Send a telemetry record when one is due
+     */
+    void updateTelemetry();
+    
+    /**
+     * @brief Run the telemetry task only while channels stream
+     *
+     * Call after any change of the subscriptions or the record period.
+     */
+    void scheduleTelemetry();
+    
+    /**
+     * @brief Bind a heater loop to a sensor and an output by name
+     * @param sensorName Thermistor input
+     * @param outputName MOSFET output
+     * @param kp Proportional gain
+     * @param ki Integral gain
+     * @param kd Derivative gain
+     * @param power Highest duty (0.0-1.0)
+     */
+    void bindHeater(const char* sensorName, const char* outputName, float kp, float ki, float kd, float power);
+    
+    /**
+     * @brief Run the heater loops and report finished autotune runs
+     */
+    void updateHeaters();
+    
+    /**
+     * @brief Get the heater loop driving an output
+     * @param device MOSFET output
+     * @return Loop or nullptr if the output is not a heater
+     */
+    HeaterLoop* getHeaterLoop(const Device* device);
+    
+    /**
+     * @brief Execute a heater loop command (setpoint, pid)
+     * @param heater Loop of the addressed output
+     * @param cmd Command to execute
+     * @param reply Filled if the command was handled
+     * @return true if handled
      */
-    bool calibrateAxis(const String& axisName);
+    bool executeHeaterCommand(HeaterLoop* heater, const Command& cmd, Reply& reply);
 };
 
 // Global controller instance
@@ -0,0 +1,137 @@
+/**
+ * @file DeviceRegistry.cpp
+ * @brief Implementation of DeviceRegistry class
+ */
+
+#include "DeviceRegistry.h"
+
+static_assert(MAX_DEVICES <= sizeof(DeviceMask) * 8, "Device ids must fit a DeviceMask");
+static_assert(DEVICE_HASH_SLOTS > MAX_DEVICES, "Name table needs free slots");
+static_assert((DEVICE_HASH_SLOTS & (DEVICE_HASH_SLOTS - 1)) == 0, "DEVICE_HASH_SLOTS must be a power of 2");
+
+// Bulk command names in DeviceGroup order
+static const char* const GROUP_NAMES[(uint8_t)DeviceGroup::COUNT] = {
+    GROUP_ALL_STEPPERS,
+    GROUP_ALL_SERVOS,
+    GROUP_ALL_OUTPUTS,
+    GROUP_ALL_SWITCHES,
+    GROUP_ALL_SENSORS,
+    GROUP_ALL_ACTUATORS,
+    GROUP_ALL_DEVICES
+};
+
+#define GROUP_FLAG(group)       (1 << (uint8_t)DeviceGroup::group)
+
+/**
+ * @brief Constructor
+ */
+DeviceRegistry::DeviceRegistry() {
+    count = 0;
+    memset(slots, 0, sizeof(slots));
+    memset(groups, 0, sizeof(groups));
+}
+
+/**
+ * @brief Add a device
+ */
+uint8_t DeviceRegistry::add(Device* device) {
+    if (!device || count >= MAX_DEVICES) return DEVICE_NONE;
+
+    const char* name = device->getName().c_str();
+    if (find(name) != DEVICE_NONE) return DEVICE_NONE;
+
+    uint8_t id = count++;
+    uint16_t hash = hashName(name);
+    devices[id] = device;
+    nameHashes[id] = (uint8_t)hash;
+
+    // Linear probing from the home slot; the table never fills up
+    uint8_t slot = hash & (DEVICE_HASH_SLOTS - 1);
+    while (slots[slot] != 0) {
+        slot = (slot + 1) & (DEVICE_HASH_SLOTS - 1);
+    }
+    slots[slot] = id + 1;
+
+    uint8_t member = groupsOf(device->getType());
+    for (uint8_t g = 0; g < (uint8_t)DeviceGroup::COUNT; g++) {
+        if (member & (1 << g)) groups[g] |= DEVICE_BIT(id);
+    }
+
+    return id;
+}
+
+/**
+ * @brief Find a device id by name
+ */
+uint8_t DeviceRegistry::find(const char* name) const {
+    uint16_t hash = hashName(name);
+    uint8_t slot = hash & (DEVICE_HASH_SLOTS - 1);
+
+    while (slots[slot] != 0) {
+        uint8_t id = slots[slot] - 1;
+        if (nameHashes[id] == (uint8_t)hash && strcmp(devices[id]->getName().c_str(), name) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & (DEVICE_HASH_SLOTS - 1);
+    }
+
+    return DEVICE_NONE;
+}
+
+/**
+ * @brief Get the number of devices in a group
+ */
+uint8_t DeviceRegistry::getGroupCount(DeviceGroup group) const {
+    DeviceMask mask = groups[(uint8_t)group];
+    uint8_t members = 0;
+    while (mask) {
+        mask &= mask - 1;
+        members++;
+    }
+    return members;
+}
+
+/**
+ * @brief Look up a group by name
+ */
+bool DeviceRegistry::parseGroup(const char* name, DeviceGroup& group) {
+    for (uint8_t g = 0; g < (uint8_t)DeviceGroup::COUNT; g++) {
+        if (strcmp(name, GROUP_NAMES[g]) == 0) {
+            group = (DeviceGroup)g;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Hash a device name (FNV-1a, folded to 16 bits)
+ */
+uint16_t DeviceRegistry::hashName(const char* name) {
+    uint32_t hash = 2166136261UL;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+/**
+ * @brief Get the groups a device type belongs to
+ */
+uint8_t DeviceRegistry::groupsOf(DeviceType type) {
+    switch (type) {
+        case DeviceType::STEPPER_MOTOR:
+            return GROUP_FLAG(STEPPERS) | GROUP_FLAG(ACTUATORS) | GROUP_FLAG(ALL);
+        case DeviceType::SERVO_MOTOR:
+            return GROUP_FLAG(SERVOS) | GROUP_FLAG(ACTUATORS) | GROUP_FLAG(ALL);
+        case DeviceType::MOSFET_OUTPUT:
+            return GROUP_FLAG(OUTPUTS) | GROUP_FLAG(ACTUATORS) | GROUP_FLAG(ALL);
+        case DeviceType::END_SWITCH:
+            return GROUP_FLAG(SWITCHES) | GROUP_FLAG(SENSORS) | GROUP_FLAG(ALL);
+        case DeviceType::ANALOG_SENSOR:
+            return GROUP_FLAG(SENSORS) | GROUP_FLAG(ALL);
+        default:
+            return GROUP_FLAG(ALL);
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * @file DeviceRegistry.h
+ * @brief Fixed table of all devices with O(1) lookup by id, name and group
+ *
+ * Every device gets a compact numeric id in registration order; the id
+ * indexes the table directly and is the device id of the binary
+ * protocol. Names are found through an open addressing hash table built
+ * as devices are added, and each bulk group (STEPPERS, SENSORS, ...) is a
+ * bitmask of ids computed once, so a group command visits its members
+ * without searching.
+ */
+
+#ifndef DEVICE_REGISTRY_H
+#define DEVICE_REGISTRY_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "DeviceConfig.h"
+#include "../devices/Device.h"
+
+#define DEVICE_NONE             0xFF    // Returned for unknown names or a full table
+
+/**
+ * @brief Set of device ids, one bit per id
+ */
+typedef uint32_t DeviceMask;
+
+#define DEVICE_BIT(id)          ((DeviceMask)1 << (id))
+
+/**
+ * @enum DeviceGroup
+ * @brief Bulk command groups
+ */
+enum class DeviceGroup : uint8_t {
+    STEPPERS,       // GROUP_ALL_STEPPERS
+    SERVOS,         // GROUP_ALL_SERVOS
+    OUTPUTS,        // GROUP_ALL_OUTPUTS
+    SWITCHES,       // GROUP_ALL_SWITCHES
+    SENSORS,        // GROUP_ALL_SENSORS
+    ACTUATORS,      // GROUP_ALL_ACTUATORS
+    ALL,            // GROUP_ALL_DEVICES
+    COUNT
+};
+
+/**
+ * @class DeviceRegistry
+ * @brief Device table, name index and group membership
+ */
+class DeviceRegistry {
+private:
+    Device* devices[MAX_DEVICES];           // Indexed by id
+    uint8_t nameHashes[MAX_DEVICES];        // Low byte of each name's hash
+    uint8_t slots[DEVICE_HASH_SLOTS];       // id + 1 per name slot (0 = empty)
+    DeviceMask groups[(uint8_t)DeviceGroup::COUNT];
+    uint8_t count;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    DeviceRegistry();
+
+    /**
+     * @brief Add a device
+     *
+     * Ids are handed out in call order. Controller registers the steppers
+     * first, so a stepper's id is also its axis slot.
+     * @param device Device (must outlive the registry)
+     * @return Device id, DEVICE_NONE if the table is full or the name is taken
+     */
+    uint8_t add(Device* device);
+
+    /**
+     * @brief Get a device by id
+     * @param id Device id
+     * @return Device or nullptr
+     */
+    Device* get(uint8_t id) const { return (id < count) ? devices[id] : nullptr; }
+
+    /**
+     * @brief Find a device id by name (case-sensitive)
+     * @param name Device name
+     * @return Device id, DEVICE_NONE if unknown
+     */
+    uint8_t find(const char* name) const;
+
+    /**
+     * @brief Find a device by name
+     * @param name Device name
+     * @return Device or nullptr
+     */
+    Device* findDevice(const char* name) const { return get(find(name)); }
+
+    /**
+     * @brief Get the members of a group
+     * @param group Group
+     * @return Mask of device ids
+     */
+    DeviceMask getGroup(DeviceGroup group) const { return groups[(uint8_t)group]; }
+
+    /**
+     * @brief Get the number of devices in a group
+     * @param group Group
+     * @return Member count
+     */
+    uint8_t getGroupCount(DeviceGroup group) const;
+
+    /**
+     * @brief Get the number of devices
+     * @return Device count (ids are 0 to count - 1)
+     */
+    uint8_t getCount() const { return count; }
+
+    /**
+     * @brief Look up a group by its bulk command name
+     * @param name Group name (e.g. "STEPPERS")
+     * @param group Set to the group if found
+     * @return true if the name is a group
+     */
+    static bool parseGroup(const char* name, DeviceGroup& group);
+
+    /**
+     * @brief Hash a device name (FNV-1a)
+     * @param name Device name
+     * @return 16-bit hash
+     */
+    static uint16_t hashName(const char* name);
+
+private:
+    /**
+     * @brief Get the groups a device type belongs to
+     * @param type Device type
+     * @return Bit per DeviceGroup
+     */
+    static uint8_t groupsOf(DeviceType type);
+};
+
+#endif // DEVICE_REGISTRY_H
@@ -0,0 +1,119 @@
+/**
+ * @file DeviceTable.cpp
+ * @brief Implementation of DeviceTable class
+ */
+
+#include "DeviceTable.h"
+#include "../devices/actuators/StepperMotor.h"
+#include "../devices/actuators/Servo.h"
+#include "../devices/actuators/MosfetOutput.h"
+#include "../devices/sensors/EndSwitch.h"
+#include "../devices/sensors/AnalogSensor.h"
+
+static_assert(DeviceTable::STEPPERS <= NUM_STEPPERS, "More steppers enabled than NUM_STEPPERS axis slots");
+static_assert(DeviceTable::SERVOS <= NUM_SERVOS, "More servos enabled than NUM_SERVOS");
+static_assert(DeviceTable::OUTPUTS <= NUM_MOSFETS, "More outputs enabled than NUM_MOSFETS");
+static_assert(DeviceTable::SWITCHES <= NUM_ENDSWITCHES, "More switches enabled than NUM_ENDSWITCHES");
+static_assert(DeviceTable::SENSORS <= NUM_ANALOG_SENSORS, "More analog sensors enabled than ADC channels");
+static_assert(DeviceTable::HEATERS <= NUM_HEATERS, "More heater loops enabled than NUM_HEATERS");
+static_assert(DeviceTable::DEVICES <= MAX_DEVICES, "Device table larger than the registry");
+
+#ifdef STEPPER_X_ENABLED
+static_assert(STEPPER_X_MAX_SPEED <= STEP_MAX_RATE, "STEPPER_X_MAX_SPEED above STEP_MAX_RATE");
+#endif
+#ifdef STEPPER_Y_ENABLED
+static_assert(STEPPER_Y_MAX_SPEED <= STEP_MAX_RATE, "STEPPER_Y_MAX_SPEED above STEP_MAX_RATE");
+#endif
+#ifdef STEPPER_Z_ENABLED
+static_assert(STEPPER_Z_MAX_SPEED <= STEP_MAX_RATE, "STEPPER_Z_MAX_SPEED above STEP_MAX_RATE");
+#endif
+
+/**
+ * @brief Construct the configured devices and add them to a registry
+ *
+ * Function statics get their storage at link time but are constructed
+ * here, so the StepperMotor and AnalogSensor constructors never run
+ * before the globals of other files they register with.
+ */
+void DeviceTable::build(DeviceRegistry& registry) {
+    // Steppers first, so a stepper's id is also its axis slot
+    #ifdef STEPPER_X_ENABLED
+        static StepperMotor stepperX(STEPPER_X_NAME, X_STEP_PIN, X_DIR_PIN, X_ENABLE_PIN, STEPPER_X_STEPS_PER_REV,
+                                     STEPPER_X_MAX_SPEED, STEPPER_X_ACCELERATION);
+        registry.add(&stepperX);
+    #endif
+    #ifdef STEPPER_Y_ENABLED
+        static StepperMotor stepperY(STEPPER_Y_NAME, Y_STEP_PIN, Y_DIR_PIN, Y_ENABLE_PIN, STEPPER_Y_STEPS_PER_REV,
+                                     STEPPER_Y_MAX_SPEED, STEPPER_Y_ACCELERATION);
+        registry.add(&stepperY);
+    #endif
+    #ifdef STEPPER_Z_ENABLED
+        static StepperMotor stepperZ(STEPPER_Z_NAME, Z_STEP_PIN, Z_DIR_PIN, Z_ENABLE_PIN, STEPPER_Z_STEPS_PER_REV,
+                                     STEPPER_Z_MAX_SPEED, STEPPER_Z_ACCELERATION);
+        registry.add(&stepperZ);
+    #endif
+
+    // Servo motors
+    #ifdef SERVO_0_ENABLED
+        static ServoMotor servo0(SERVO_0_NAME, SERVO0_PIN, SERVO_0_MIN_ANGLE, SERVO_0_MAX_ANGLE);
+        registry.add(&servo0);
+    #endif
+    #ifdef SERVO_1_ENABLED
+        static ServoMotor servo1(SERVO_1_NAME, SERVO1_PIN, SERVO_1_MIN_ANGLE, SERVO_1_MAX_ANGLE);
+        registry.add(&servo1);
+    #endif
+
+    // MOSFET outputs
+    #ifdef MOSFET_A_ENABLED
+        static MosfetOutput mosfetA(MOSFET_A_NAME, MOSFET_A_PIN, MOSFET_A_PWM);
+        registry.add(&mosfetA);
+    #endif
+    #ifdef MOSFET_B_ENABLED
+        static MosfetOutput mosfetB(MOSFET_B_NAME, MOSFET_B_PIN, MOSFET_B_PWM);
+        registry.add(&mosfetB);
+    #endif
+    #ifdef MOSFET_C_ENABLED
+        static MosfetOutput mosfetC(MOSFET_C_NAME, MOSFET_C_PIN, MOSFET_C_PWM);
+        registry.add(&mosfetC);
+    #endif
+
+    // End switches
+    #ifdef SWITCH_X_MIN_ENABLED
+        static EndSwitch switchXMin(SWITCH_X_MIN_NAME, X_MIN_PIN, SWITCH_X_MIN_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchXMin);
+    #endif
+    #ifdef SWITCH_Y_MIN_ENABLED
+        static EndSwitch switchYMin(SWITCH_Y_MIN_NAME, Y_MIN_PIN, SWITCH_Y_MIN_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchYMin);
+    #endif
+    #ifdef SWITCH_Z_MIN_ENABLED
+        static EndSwitch switchZMin(SWITCH_Z_MIN_NAME, Z_MIN_PIN, SWITCH_Z_MIN_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchZMin);
+    #endif
+    #ifdef SWITCH_X_MAX_ENABLED
+        static EndSwitch switchXMax(SWITCH_X_MAX_NAME, X_MAX_PIN, SWITCH_X_MAX_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchXMax);
+    #endif
+    #ifdef SWITCH_Y_MAX_ENABLED
+        static EndSwitch switchYMax(SWITCH_Y_MAX_NAME, Y_MAX_PIN, SWITCH_Y_MAX_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchYMax);
+    #endif
+    #ifdef SWITCH_Z_MAX_ENABLED
+        static EndSwitch switchZMax(SWITCH_Z_MAX_NAME, Z_MAX_PIN, SWITCH_Z_MAX_INVERTED, SWITCH_PULLUP);
+        registry.add(&switchZMax);
+    #endif
+
+    // Analog sensors; a thermistor also gets its lookup table
+    #ifdef ANALOG_0_ENABLED
+        static AnalogSensor analog0(ANALOG_0_NAME, ANALOG_0_PIN, ANALOG_0_MODE);
+        #if ANALOG_0_MODE == SENSOR_MODE_CUSTOM
+            static uint16_t analog0Table[THERMISTOR_TABLE_SIZE];
+            analog0.configureThermistor(ANALOG_0_R_PULLUP, ANALOG_0_THERMISTOR_R25, ANALOG_0_THERMISTOR_BETA, analog0Table);
+        #endif
+        registry.add(&analog0);
+    #endif
+    #ifdef ANALOG_1_ENABLED
+        static AnalogSensor analog1(ANALOG_1_NAME, ANALOG_1_PIN, ANALOG_1_MODE);
+        registry.add(&analog1);
+    #endif
+}
@@ -0,0 +1,112 @@
+/**
+ * @file DeviceTable.h
+ * @brief The devices enabled in DeviceConfig.h, sized at compile time
+ *
+ * Every enabled device is a static object, so its RAM shows up in the
+ * .bss total of the linker map (avr-size) instead of being taken from
+ * the heap at startup. The per-type counts are constants and are checked
+ * against the slots the step generator, ADC sampler and registry reserve
+ * (NUM_* in Config.h), so a configuration that does not fit fails to
+ * compile.
+ */
+
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "DeviceConfig.h"
+#include "DeviceRegistry.h"
+
+/**
+ * @class DeviceTable
+ * @brief Static storage and registration of the configured devices
+ */
+class DeviceTable {
+public:
+    static constexpr uint8_t STEPPERS = 0
+    #ifdef STEPPER_X_ENABLED
+        + 1
+    #endif
+    #ifdef STEPPER_Y_ENABLED
+        + 1
+    #endif
+    #ifdef STEPPER_Z_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t SERVOS = 0
+    #ifdef SERVO_0_ENABLED
+        + 1
+    #endif
+    #ifdef SERVO_1_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t OUTPUTS = 0
+    #ifdef MOSFET_A_ENABLED
+        + 1
+    #endif
+    #ifdef MOSFET_B_ENABLED
+        + 1
+    #endif
+    #ifdef MOSFET_C_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t SWITCHES = 0
+    #ifdef SWITCH_X_MIN_ENABLED
+        + 1
+    #endif
+    #ifdef SWITCH_Y_MIN_ENABLED
+        + 1
+    #endif
+    #ifdef SWITCH_Z_MIN_ENABLED
+        + 1
+    #endif
+    #ifdef SWITCH_X_MAX_ENABLED
+        + 1
+    #endif
+    #ifdef SWITCH_Y_MAX_ENABLED
+        + 1
+    #endif
+    #ifdef SWITCH_Z_MAX_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t SENSORS = 0
+    #ifdef ANALOG_0_ENABLED
+        + 1
+    #endif
+    #ifdef ANALOG_1_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t HEATERS = 0
+    #ifdef HEATER_0_ENABLED
+        + 1
+    #endif
+    #ifdef HEATER_1_ENABLED
+        + 1
+    #endif
+        ;
+
+    static constexpr uint8_t DEVICES = STEPPERS + SERVOS + OUTPUTS + SWITCHES + SENSORS;
+
+    /**
+     * @brief Construct the configured devices and add them to a registry
+     *
+     * Registration order sets the device ids: steppers, servos, outputs,
+     * switches, sensors. The objects are built on the first call, after
+     * the step generator and ADC sampler globals they attach to.
+     * @param registry Registry to fill
+     */
+    static void build(DeviceRegistry& registry);
+};
+
+#endif // DEVICE_TABLE_H
@@ -5,17 +5,59 @@
 
 #include "Interface.h"
 #include "Controller.h"
+#include "Profiler.h"
+
+static_assert(BINARY_MAX_FRAME + 2 <= TX_OVERFLOW_SIZE, "A binary frame must fit the overflow store whole");
+
+/**
+ * @brief Copy part of a message given as data followed by a suffix
+ */
+static void copyPart(uint8_t* out, const uint8_t* data, uint16_t length, const uint8_t* suffix,
+                     uint16_t offset, uint16_t count) {
+    if (offset < length) {
+        uint16_t fromData = (count < length - offset) ? count : length - offset;
+        memcpy(out, data + offset, fromData);
+        out += fromData;
+        offset += fromData;
+        count -= fromData;
+    }
+    if (count > 0) memcpy(out, suffix + (offset - length), count);
+}
 
 /**
  * @brief Constructor
  */
-Interface::Interface(Controller* ctrl) {
+Interface::Interface(Controller* ctrl)
+    : txUrgent(txUrgentStorage, TX_QUEUE_URGENT_SIZE),
+      txNormal(txNormalStorage, TX_QUEUE_NORMAL_SIZE),
+      txTelemetry(txTelemetryStorage, TX_QUEUE_TELEMETRY_SIZE) {
     controller = ctrl;
-    inputBuffer = "";
+    inputLength = 0;
+    inputBuffer[0] = '\0';
     lastCharTime = millis();
     ackMode = DEFAULT_ACK_MODE;
     commandCount = 0;
     errorCount = 0;
+    frameErrors = 0;
+    protocol = ProtocolMode::TEXT;
+    pendingProtocol = ProtocolMode::TEXT;
+    inputOverflow = false;
+    waitingForOutput = false;
+    pendingStopLength = 0;
+    queueHead = 0;
+    queueUsed = 0;
+    queuedCommands = 0;
+    windowOverruns = 0;
+    
+    txQueues[(uint8_t)TxPriority::URGENT] = &txUrgent;
+    txQueues[(uint8_t)TxPriority::NORMAL] = &txNormal;
+    txQueues[(uint8_t)TxPriority::TELEMETRY] = &txTelemetry;
+    txBytesQueued = 0;
+    txBytesDropped = 0;
+    txStalls = 0;
+    txWaits = 0;
+    txOverflowHead = 0;
+    txOverflowUsed = 0;
 }
 
 /**
@@ -45,11 +87,24 @@ bool Interface::init(unsigned long baudRate) {
  * @brief Update interface
  */
 void Interface::update() {
+    // Keep the UART busy with queued output
+    flushOutput();
+    
     // Process incoming serial data
     processSerialInput();
+    executePendingStop();
+    
+    // Execute queued commands, draining the UART between them so input
+    // does not overflow while a command runs. While replies are backed up
+    // commands stay queued, and the receive window pushes back on the host.
+    for (uint8_t i = 0; i < COMMAND_WINDOW && queuedCommands > 0 && !isOutputBlocked(); i++) {
+        executeQueued();
+        processSerialInput();
+        executePendingStop();
+    }
     
     // Check for command timeout
-    if (inputBuffer.length() > 0 && checkTimeout()) {
+    if (inputLength > 0 && checkTimeout()) {
         if (DEBUG_ENABLED && DEBUG_LEVEL >= 2) {
             sendMessage("WARNING: Command timeout, buffer cleared");
         }
@@ -65,23 +120,28 @@ void Interface::processSerialInput() {
         char c = Serial.read();
         lastCharTime = millis();
         
+        if (protocol == ProtocolMode::BINARY) {
+            processBinaryByte((uint8_t)c);
+            continue;
+        }
+        
         // Check for command terminator
         if (c == COMMAND_TERMINATOR) {
-            if (inputBuffer.length() > 0) {
-                processCommand(inputBuffer);
-                clearBuffer();
+            char line[COMMAND_BUFFER_SIZE];
+            bool overflow = inputOverflow;
+            uint8_t length = takeInput(line);
+            if (overflow) {
+                rejectInput(line, length, ERROR_INVALID_PARAM, "Command too long");
+            } else if (length > 0) {
+                queueInput(line, length);
             }
         } else if (c >= 32 && c < 127) {  // Printable ASCII
             // Add to buffer if not full
-            if (inputBuffer.length() < COMMAND_BUFFER_SIZE - 1) {
-                inputBuffer += c;
+            if (inputLength < COMMAND_BUFFER_SIZE - 1) {
+                inputBuffer[inputLength++] = c;
             } else {
-                // Buffer overflow
-                if (DEBUG_ENABLED && DEBUG_LEVEL >= 1) {
-                    sendMessage("ERROR: Command buffer overflow");
-                }
-                errorCount++;
-                clearBuffer();
+                // Keep the start (sequence tag) and reject at the terminator
+                inputOverflow = true;
             }
         }
         // Ignore other characters (CR, control chars, etc.)
@@ -91,14 +151,20 @@ void Interface::processSerialInput() {
 /**
  * @brief Process complete command
  */
-void Interface::processCommand(const String& commandStr) {
+void Interface::processCommand(const char* commandStr) {
     commandCount++;
     
     // Parse command
     Command cmd;
-    if (!cmd.parse(commandStr)) {
+    PERF_START(parseStart);
+    bool parsed = cmd.parse(commandStr);
+    PERF_END(PerfChannel::PARSE, parseStart);
+    if (!parsed) {
         Reply reply;
         reply.setError("", ERROR_INVALID_PARAM, "Invalid command format");
+        if (cmd.hasSequence()) {
+            reply.setSequence(cmd.getSequence());
+        }
         sendReply(reply);
         errorCount++;
         return;
@@ -106,17 +172,28 @@ void Interface::processCommand(const String& commandStr) {
     
     // Execute command
     if (controller) {
+        PERF_START(executeStart);
         Reply reply = controller->executeCommand(cmd);
+        PERF_END(PerfChannel::EXECUTE, executeStart);
+        
+        // Tagged commands get a tagged reply so the host can match it
+        if (cmd.hasSequence()) {
+            reply.setSequence(cmd.getSequence());
+        }
         
         // Send reply if not empty or if ACK mode is on
         if (reply.isValid() && (reply.toString().length() > 0 || ackMode)) {
-            sendReply(reply);
+            bool estop = cmd.getCommandType() == CommandType::ESTOP;
+            sendReply(reply, estop ? TxPriority::URGENT : TxPriority::NORMAL);
         }
         
         // Count errors
         if (reply.getErrorCode() != ERROR_NONE) {
             errorCount++;
         }
+        
+        // Switch protocol once the acknowledgement is out
+        protocol = pendingProtocol;
     } else {
         Reply reply;
         reply.setError("", ERROR_HARDWARE_FAULT, "Controller not initialized");
@@ -125,21 +202,581 @@ void Interface::processCommand(const String& commandStr) {
     }
 }
 
+/**
+ * @brief Move the received command out of inputBuffer
+ */
+uint8_t Interface::takeInput(char* line) {
+    uint8_t length = inputLength;
+    memcpy(line, inputBuffer, length);
+    line[length] = '\0';
+    clearBuffer();
+    return length;
+}
+
+/**
+ * @brief Queue a received command
+ *
+ * Text lines and binary frames contain no '\0', so both are stored
+ * '\0' terminated. A command beyond the receive window gets an explicit
+ * busy reply instead of being dropped. An emergency stop bypasses the
+ * queue: it runs as soon as it arrives, even with the window full or
+ * replies backed up, and the commands queued before it are refused.
+ */
+void Interface::queueInput(char* command, uint8_t length) {
+    if (isEmergencyStop(command, length)) {
+        if (waitingForOutput) {
+            // The waiting command may still be starting motion: stop
+            // right after it, ahead of the queued commands
+            memcpy(pendingStop, command, length + 1);
+            pendingStopLength = length;
+            return;
+        }
+        executeInput(command, length);
+        return;
+    }
+    
+    uint16_t needed = length + 1;
+    if (queuedCommands >= COMMAND_WINDOW || queueUsed + needed > COMMAND_QUEUE_SIZE) {
+        windowOverruns++;
+        rejectInput(command, length, ERROR_DEVICE_BUSY, "Receive window full");
+        return;
+    }
+    
+    uint16_t tail = (queueHead + queueUsed) % COMMAND_QUEUE_SIZE;
+    for (uint16_t i = 0; i < needed; i++) {
+        rxQueue[tail] = command[i];
+        tail = (tail + 1) % COMMAND_QUEUE_SIZE;
+    }
+    queueUsed += needed;
+    queuedCommands++;
+}
+
+/**
+ * @brief Check if a received command is an emergency stop
+ */
+bool Interface::isEmergencyStop(const char* command, uint8_t length) const {
+    if (protocol == ProtocolMode::BINARY) {
+        // Decode a copy; the frame is queued as received otherwise
+        uint8_t frame[COMMAND_BUFFER_SIZE];
+        memcpy(frame, command, length);
+        BinaryPacket packet;
+        return BinaryProtocol::decodeFrame(frame, length, packet) &&
+               packet.opcode == (uint8_t)BinaryOpcode::ESTOP;
+    }
+    
+    // Only lines naming a stop are parsed here
+    if (!strcasestr(command, "estop") && !strcasestr(command, "emergency")) {
+        return false;
+    }
+    Command cmd;
+    return cmd.parse(command) && cmd.getCommandType() == CommandType::ESTOP;
+}
+
+/**
+ * @brief Execute the oldest queued command
+ */
+void Interface::executeQueued() {
+    char command[COMMAND_BUFFER_SIZE];
+    uint8_t length = 0;
+    
+    while (rxQueue[queueHead] != '\0') {
+        command[length++] = rxQueue[queueHead];
+        queueHead = (queueHead + 1) % COMMAND_QUEUE_SIZE;
+    }
+    command[length] = '\0';
+    queueHead = (queueHead + 1) % COMMAND_QUEUE_SIZE;
+    queueUsed -= length + 1;
+    queuedCommands--;
+    
+    executeInput(command, length);
+}
+
+/**
+ * @brief Execute an emergency stop received while output waited
+ */
+void Interface::executePendingStop() {
+    if (pendingStopLength == 0) return;
+    
+    uint8_t length = pendingStopLength;
+    pendingStopLength = 0;
+    executeInput(pendingStop, length);
+}
+
+/**
+ * @brief Execute a text command or binary frame
+ */
+void Interface::executeInput(char* command, uint8_t length) {
+    if (protocol == ProtocolMode::BINARY) {
+        processBinaryFrame((uint8_t*)command, length);
+    } else {
+        processCommand(command);
+    }
+}
+
+/**
+ * @brief Reject a received command
+ */
+void Interface::rejectInput(char* command, uint8_t length, ErrorCode code, const String& message) {
+    errorCount++;
+    
+    Reply reply;
+    reply.setError("", code, message);
+    
+    if (protocol == ProtocolMode::BINARY) {
+        // Answer with the request's sequence number if the frame is intact
+        BinaryPacket packet;
+        if (BinaryProtocol::decodeFrame((uint8_t*)command, length, packet)) {
+            sendBinaryReply(reply, packet.seq, packet.deviceId, packet.opcode);
+        } else {
+            frameErrors++;
+        }
+        return;
+    }
+    
+    // Only the sequence tag is needed from the command
+    Command cmd;
+    cmd.parse(command);
+    if (cmd.hasSequence()) {
+        reply.setSequence(cmd.getSequence());
+    }
+    sendReply(reply);
+}
+
+/**
+ * @brief Add a received byte in binary mode
+ */
+void Interface::processBinaryByte(uint8_t c) {
+    if (c == 0) {
+        // Frame delimiter
+        if (inputOverflow) {
+            frameErrors++;
+            errorCount++;
+            clearBuffer();
+        } else if (inputLength > 0) {
+            char frame[COMMAND_BUFFER_SIZE];
+            uint8_t length = takeInput(frame);
+            queueInput(frame, length);
+        }
+    } else if (inputLength < COMMAND_BUFFER_SIZE - 1) {
+        inputBuffer[inputLength++] = (char)c;
+    } else {
+        // Too long for a request - drop it and resync at the next delimiter
+        inputOverflow = true;
+    }
+}
+
+/**
+ * @brief Decode and execute a complete binary frame
+ */
+void Interface::processBinaryFrame(uint8_t* frame, uint8_t length) {
+    BinaryPacket packet;
+    PERF_START(parseStart);
+    bool decoded = BinaryProtocol::decodeFrame(frame, length, packet);
+    PERF_END(PerfChannel::PARSE, parseStart);
+    if (!decoded) {
+        // Line noise or a truncated frame; the host retries on timeout
+        frameErrors++;
+        errorCount++;
+        return;
+    }
+    
+    commandCount++;
+    
+    if (packet.opcode == (uint8_t)BinaryOpcode::TEXT) {
+        uint8_t op = packet.opcode;
+        sendFrame(packet.seq, packet.deviceId, BinaryOpcode::REPLY_OK, &op, 1);
+        protocol = pendingProtocol = ProtocolMode::TEXT;
+        return;
+    }
+    
+    if (!controller) {
+        Reply reply;
+        reply.setError("", ERROR_HARDWARE_FAULT, "Controller not initialized");
+        sendBinaryReply(reply, packet.seq, packet.deviceId, packet.opcode);
+        errorCount++;
+        return;
+    }
+    
+    PERF_START(executeStart);
+    Reply reply = controller->executeBinary(packet);
+    PERF_END(PerfChannel::EXECUTE, executeStart);
+    bool estop = packet.opcode == (uint8_t)BinaryOpcode::ESTOP;
+    sendBinaryReply(reply, packet.seq, packet.deviceId, packet.opcode,
+                    estop ? TxPriority::URGENT : TxPriority::NORMAL);
+    
+    if (reply.getErrorCode() != ERROR_NONE) {
+        errorCount++;
+    }
+    
+    protocol = pendingProtocol;
+}
+
+/**
+ * @brief Send a reply as binary frame(s)
+ */
+void Interface::sendBinaryReply(const Reply& reply, uint8_t seq, uint8_t deviceId, uint8_t requestOpcode,
+                                TxPriority priority) {
+    uint8_t payload[BINARY_MAX_PAYLOAD];
+    uint8_t length = 0;
+    const String* text = nullptr;
+    BinaryOpcode opcode;
+    
+    switch (reply.getStatus()) {
+        case ReplyStatus::VALUE:
+            payload[length++] = requestOpcode;
+            if (reply.hasNumber()) {
+                opcode = BinaryOpcode::REPLY_VALUE;
+                BinaryProtocol::writeInt32(payload + length, BinaryProtocol::toFixed(reply.getNumber()));
+                length += 4;
+            } else {
+                // Non-numeric values (e.g. queue state) travel as text
+                opcode = BinaryOpcode::REPLY_OK;
+                text = &reply.getValue();
+            }
+            break;
+            
+        case ReplyStatus::ERROR:
+            opcode = BinaryOpcode::REPLY_ERROR;
+            priority = TxPriority::URGENT;
+            payload[length++] = requestOpcode;
+            payload[length++] = (uint8_t)reply.getErrorCode();
+            text = &reply.getErrorMessage();
+            break;
+            
+        case ReplyStatus::EVENT: {
+            // Events come from the controller and name their source device
+            int id = controller ? controller->getDeviceId(reply.getDeviceName()) : -1;
+            String event = reply.getInterface() + " " + reply.getValue();
+            sendFrame(0, (id >= 0) ? id : BINARY_ID_CONTROLLER, BinaryOpcode::REPLY_EVENT,
+                      (const uint8_t*)event.c_str(), min(event.length(), (unsigned int)BINARY_MAX_PAYLOAD), priority);
+            return;
+        }
+            
+        case ReplyStatus::INFO:
+            sendBinaryText(reply.getValue(), priority);
+            return;
+            
+        default:
+            opcode = BinaryOpcode::REPLY_OK;
+            payload[length++] = requestOpcode;
+            text = &reply.getValue();
+            break;
+    }
+    
+    if (text) {
+        unsigned int textLength = min(text->length(), (unsigned int)(BINARY_MAX_PAYLOAD - length));
+        memcpy(payload + length, text->c_str(), textLength);
+        length += textLength;
+    }
+    
+    sendFrame(seq, deviceId, opcode, payload, length, priority);
+}
+
+/**
+ * @brief Send one binary frame
+ */
+void Interface::sendFrame(uint8_t seq, uint8_t deviceId, BinaryOpcode opcode, const uint8_t* payload, uint8_t length,
+                          TxPriority priority, uint8_t key) {
+    uint8_t frame[BINARY_MAX_FRAME];
+    size_t frameLength = BinaryProtocol::encodeFrame(seq, deviceId, opcode, payload, length, frame);
+    queueOutput(frame, frameLength, priority, key);
+}
+
+/**
+ * @brief Send text as INFO frames
+ */
+void Interface::sendBinaryText(const String& text, TxPriority priority, uint8_t key) {
+    const uint8_t* data = (const uint8_t*)text.c_str();
+    unsigned int remaining = text.length();
+    
+    do {
+        uint8_t length = min(remaining, (unsigned int)BINARY_MAX_PAYLOAD);
+        remaining -= length;
+        sendFrame(0, BINARY_ID_CONTROLLER,
+                  remaining > 0 ? BinaryOpcode::REPLY_INFO_PART : BinaryOpcode::REPLY_INFO,
+                  data, length, priority, key);
+        data += length;
+    } while (remaining > 0);
+}
+
 /**
  * @brief Send a reply
  */
-void Interface::sendReply(const Reply& reply) {
+void Interface::sendReply(const Reply& reply, TxPriority priority) {
+    if (protocol == ProtocolMode::BINARY) {
+        // Unsolicited replies (events, service notifications)
+        sendBinaryReply(reply, 0, BINARY_ID_CONTROLLER, 0, priority);
+        return;
+    }
+    
+    if (reply.getStatus() == ReplyStatus::ERROR) {
+        priority = TxPriority::URGENT;
+    }
+    
     String replyStr = reply.toString();
     if (replyStr.length() > 0) {
-        sendMessage(replyStr);
+        sendMessage(replyStr, priority);
     }
 }
 
 /**
  * @brief Send raw message
  */
-void Interface::sendMessage(const String& message) {
-    Serial.println(message);
+void Interface::sendMessage(const String& message, TxPriority priority, uint8_t key) {
+    if (protocol == ProtocolMode::BINARY) {
+        sendBinaryText(message, priority, key);
+        return;
+    }
+    
+    static const uint8_t lineEnd[] = { '\r', '\n' };
+    queueOutput((const uint8_t*)message.c_str(), message.length(), priority, key, lineEnd, sizeof(lineEnd));
+}
+
+/**
+ * @brief Queue bytes as one message
+ */
+void Interface::queueOutput(const uint8_t* data, uint16_t length, TxPriority priority, uint8_t key,
+                            const uint8_t* suffix, uint8_t suffixLength) {
+    TxBuffer* queue = txQueues[(uint8_t)priority];
+    uint16_t total = length + suffixLength;
+    
+    // Only the newest sample of a telemetry key is worth sending
+    if (key != TX_KEY_NONE) {
+        txBytesDropped += queue->coalesce(key);
+    }
+    
+    if (priority == TxPriority::NORMAL && isOutputBlocked()) {
+        // Keep NORMAL messages in order behind the backed up ones
+        addOverflow(data, length, suffix, suffixLength);
+        flushOutput();
+        return;
+    }
+    
+    if (!queue->begin(total, key)) {
+        if (priority == TxPriority::TELEMETRY) {
+            // Make room by dropping old samples
+            bool queued = false;
+            while (!queued) {
+                uint16_t dropped = queue->dropOldest();
+                if (dropped == 0) break;
+                txBytesDropped += dropped;
+                queued = queue->begin(total, key);
+            }
+            if (!queued) {
+                txBytesDropped += total;
+                return;
+            }
+        } else if (priority == TxPriority::URGENT) {
+            // A burst of busy replies: wait for the UART, not behind NORMAL output
+            txStalls++;
+            addUrgent(data, length, suffix, suffixLength);
+            flushOutput();
+            return;
+        } else {
+            txStalls++;
+            addOverflow(data, length, suffix, suffixLength);
+            flushOutput();
+            return;
+        }
+    }
+    
+    queue->write(data, length);
+    if (suffixLength > 0) {
+        queue->write(suffix, suffixLength);
+    }
+    txBytesQueued += total;
+    
+    flushOutput();
+}
+
+/**
+ * @brief Move queued output to the UART as far as it has room
+ */
+void Interface::flushOutput() {
+    moveOverflow();
+    
+    int room = Serial.availableForWrite();
+    
+    while (room > 0) {
+        // Finish a message on the wire before starting a higher priority one
+        TxBuffer* active = nullptr;
+        for (uint8_t i = 0; i < TX_PRIORITIES && !active; i++) {
+            if (txQueues[i]->isSending()) active = txQueues[i];
+        }
+        for (uint8_t i = 0; i < TX_PRIORITIES && !active; i++) {
+            if (!txQueues[i]->isEmpty()) active = txQueues[i];
+        }
+        if (!active) break;
+        
+        uint16_t sent = active->drain(room);
+        if (sent == 0 && !active->isEmpty()) break;
+        room -= sent;
+        
+        if (active == txQueues[(uint8_t)TxPriority::NORMAL]) moveOverflow();
+    }
+}
+
+/**
+ * @brief Send the message on the wire, then URGENT output only
+ */
+void Interface::flushUrgent() {
+    int room = Serial.availableForWrite();
+    
+    for (uint8_t i = 0; i < TX_PRIORITIES && room > 0; i++) {
+        uint16_t rest = txQueues[i]->getSending();
+        if (rest > 0) room -= txQueues[i]->drain(rest < room ? rest : room);
+    }
+    if (room > 0) {
+        txQueues[(uint8_t)TxPriority::URGENT]->drain(room);
+    }
+}
+
+/**
+ * @brief Receive input while a message waits for the UART
+ */
+void Interface::receiveWhileWaiting() {
+    if (waitingForOutput) return;
+    
+    waitingForOutput = true;
+    processSerialInput();
+    waitingForOutput = false;
+}
+
+/**
+ * @brief Queue an URGENT message once its queue has room
+ */
+void Interface::addUrgent(const uint8_t* data, uint16_t length, const uint8_t* suffix, uint8_t suffixLength) {
+    TxBuffer* queue = txQueues[(uint8_t)TxPriority::URGENT];
+    uint16_t total = length + suffixLength;
+    bool split = (uint32_t)total + TxBuffer::HEADER_SIZE > queue->getSize();
+    uint8_t part[TX_QUEUE_URGENT_SIZE];
+    
+    txWaits++;
+    for (uint16_t offset = 0; offset < total; ) {
+        uint16_t piece = total - offset;
+        if (split && piece > queue->getFree()) piece = queue->getFree();
+        if (piece == 0 || !queue->begin(piece, TX_KEY_NONE)) {
+            flushUrgent();
+            // Input received now could queue a reply between the pieces
+            if (!split) receiveWhileWaiting();
+            continue;
+        }
+        copyPart(part, data, length, suffix, offset, piece);
+        queue->write(part, piece);
+        offset += piece;
+    }
+    txBytesQueued += total;
+}
+
+/**
+ * @brief Keep a NORMAL message that does not fit its queue
+ */
+void Interface::addOverflow(const uint8_t* data, uint16_t length, const uint8_t* suffix, uint8_t suffixLength) {
+    uint16_t total = length + suffixLength;
+    bool waited = false;
+    
+    for (uint16_t offset = 0; offset < total; ) {
+        // Reuse the space of messages already moved to the queue
+        if (txOverflowHead > 0) {
+            memmove(txOverflow, txOverflow + txOverflowHead, txOverflowUsed - txOverflowHead);
+            txOverflowUsed -= txOverflowHead;
+            txOverflowHead = 0;
+        }
+        
+        uint16_t room = TX_OVERFLOW_SIZE - txOverflowUsed;
+        uint16_t piece = total - offset;
+        if (piece + 2 > room) {
+            if (piece + 2 <= TX_OVERFLOW_SIZE) {
+                // Kept whole once the store has room
+                piece = 0;
+            } else {
+                // Longer than the store: the longest part that ends a line,
+                // or whatever fits if the store is empty and there is none
+                uint16_t fits = (room > 2) ? room - 2 : 0;
+                piece = (txOverflowUsed > 0) ? 0 : fits;
+                for (uint16_t i = fits; i > 0; i--) {
+                    uint16_t at = offset + i - 1;
+                    if ((at < length ? data[at] : suffix[at - length]) == '\n') {
+                        piece = i;
+                        break;
+                    }
+                }
+            }
+        }
+        
+        if (piece == 0) {
+            // The store is full: hold the command that produced the output,
+            // still receiving so the host's commands are not overrun
+            if (!waited) txWaits++;
+            waited = true;
+            flushOutput();
+            receiveWhileWaiting();
+            continue;
+        }
+        
+        uint8_t* message = txOverflow + txOverflowUsed;
+        message[0] = piece & 0xFF;
+        message[1] = piece >> 8;
+        copyPart(message + 2, data, length, suffix, offset, piece);
+        txOverflowUsed += 2 + piece;
+        offset += piece;
+    }
+    txBytesQueued += total;
+}
+
+/**
+ * @brief Move overflow messages into the NORMAL queue as far as it has room
+ */
+void Interface::moveOverflow() {
+    if (!isOutputBlocked()) return;
+    
+    TxBuffer* queue = txQueues[(uint8_t)TxPriority::NORMAL];
+    
+    while (txOverflowHead < txOverflowUsed) {
+        uint8_t* message = txOverflow + txOverflowHead;
+        uint16_t length = message[0] | ((uint16_t)message[1] << 8);
+        uint16_t piece = length;
+        
+        if ((uint32_t)length + TxBuffer::HEADER_SIZE > queue->getSize()) {
+            // Too long for the queue: wait until it is empty, then send the
+            // longest part that ends a line
+            if (!queue->isEmpty()) return;
+            piece = queue->getFree();
+            for (uint16_t i = piece; i > 0; i--) {
+                if (message[2 + i - 1] == '\n') {
+                    piece = i;
+                    break;
+                }
+            }
+        }
+        
+        if (!queue->begin(piece, TX_KEY_NONE)) return;
+        queue->write(message + 2, piece);
+        
+        if (piece < length) {
+            // The rest stays as a shorter message; its header overwrites sent bytes
+            txOverflowHead += piece;
+            length -= piece;
+            txOverflow[txOverflowHead] = length & 0xFF;
+            txOverflow[txOverflowHead + 1] = length >> 8;
+        } else {
+            txOverflowHead += 2 + length;
+        }
+    }
+    
+    txOverflowHead = 0;
+    txOverflowUsed = 0;
+}
+
+/**
+ * @brief Send all queued output, waiting for the UART
+ */
+void Interface::flush() {
+    for (uint8_t i = 0; i < TX_PRIORITIES; i++) {
+        while (!txQueues[i]->isEmpty() || (i == (uint8_t)TxPriority::NORMAL && isOutputBlocked())) {
+            flushOutput();
+        }
+    }
 }
 
 /**
@@ -162,11 +799,54 @@ String Interface::getStatistics() const {
     } else {
         stats += "N/A";
     }
+    stats += "\nFrame errors: " + String(frameErrors);
+    stats += "\nWindow overruns: " + String(windowOverruns);
+    stats += "\nTX bytes queued: " + String(txBytesQueued);
+    stats += "\nTX bytes dropped: " + String(txBytesDropped);
+    stats += "\nTX stalls: " + String(txStalls);
+    stats += "\nTX waits: " + String(txWaits);
+    stats += "\nTX peak: " + String(txQueues[(uint8_t)TxPriority::URGENT]->getPeak()) + "/" +
+             String(txQueues[(uint8_t)TxPriority::NORMAL]->getPeak()) + "/" +
+             String(txQueues[(uint8_t)TxPriority::TELEMETRY]->getPeak()) + " bytes (urgent/normal/telemetry)";
     stats += "\nACK mode: " + String(ackMode ? "ON" : "OFF");
+    stats += "\nProtocol: " + String(protocol == ProtocolMode::BINARY ? "binary" : "text");
     
     return stats;
 }
 
+/**
+ * @brief Queue a telemetry record
+ */
+void Interface::sendTelemetry(const Telemetry& telemetry, unsigned long timestamp) {
+    static_assert(4 + 4 * TELEMETRY_MAX_CHANNELS <= BINARY_MAX_PAYLOAD,
+                  "Telemetry record does not fit a binary frame");
+    
+    if (protocol == ProtocolMode::BINARY) {
+        uint8_t payload[4 + 4 * TELEMETRY_MAX_CHANNELS];
+        uint8_t length = 0;
+        BinaryProtocol::writeInt32(payload, (int32_t)timestamp);
+        length += 4;
+        for (uint8_t i = 0; i < telemetry.getCount(); i++) {
+            BinaryProtocol::writeInt32(payload + length, BinaryProtocol::toFixed(telemetry.sample(i)));
+            length += 4;
+        }
+        sendFrame(0, BINARY_ID_CONTROLLER, BinaryOpcode::REPLY_TELEMETRY, payload, length,
+                  TxPriority::TELEMETRY, TELEMETRY_TX_KEY);
+        return;
+    }
+    
+    String record = "TLM " + String(timestamp);
+    for (uint8_t i = 0; i < telemetry.getCount(); i++) {
+        uint8_t decimals = telemetry.getDecimals(i);
+        if (decimals == 0) {
+            record += " " + String((long)round(telemetry.sample(i)));
+        } else {
+            record += " " + String(telemetry.sample(i), decimals);
+        }
+    }
+    sendMessage(record, TxPriority::TELEMETRY, TELEMETRY_TX_KEY);
+}
+
 /**
  * @brief Send startup message
  */
@@ -178,5 +858,6 @@ void Interface::sendStartupMessage() {
     sendMessage("Ready for commands.");
     sendMessage("Type 'CONTROLLER LIST' for device list");
     sendMessage("Commands start with '" + String(COMMAND_START_CHAR) + "'");
+    sendMessage("Receive window: " + String(COMMAND_WINDOW) + " commands");
     sendMessage("===========================================");
 }
\ No newline at end of file
@@ -13,6 +13,9 @@
 #include "Config.h"
 #include "Command.h"
 #include "Reply.h"
+#include "BinaryProtocol.h"
+#include "TxBuffer.h"
+#include "Telemetry.h"
 
 // Forward declaration
 class Controller;
@@ -26,11 +29,44 @@ class Controller;
 class Interface {
 private:
     Controller* controller;         // Reference to controller
-    String inputBuffer;             // Command input buffer
+    char inputBuffer[COMMAND_BUFFER_SIZE];  // Command input buffer
+    uint8_t inputLength;            // Characters in inputBuffer
+    bool inputOverflow;             // Discarding input until the next terminator
+    bool waitingForOutput;          // A message waits for the UART (no room left)
+    char pendingStop[COMMAND_BUFFER_SIZE];  // Emergency stop received while waiting
+    uint8_t pendingStopLength;      // Bytes in pendingStop (0 = none)
+    
+    // Received commands waiting for execution ('\0' separated)
+    char rxQueue[COMMAND_QUEUE_SIZE];
+    uint16_t queueHead;             // Next byte to execute
+    uint16_t queueUsed;             // Bytes in rxQueue
+    uint8_t queuedCommands;         // Complete commands in rxQueue
+    unsigned long windowOverruns;   // Commands rejected as busy
     unsigned long lastCharTime;     // Time of last received character
     bool ackMode;                   // Acknowledgment mode
     unsigned long commandCount;     // Total commands processed
     unsigned long errorCount;       // Total errors
+    unsigned long frameErrors;      // Binary frames dropped (CRC, framing, overflow)
+    ProtocolMode protocol;          // Active wire format
+    ProtocolMode pendingProtocol;   // Wire format after the current reply
+    
+    // Outgoing messages, one queue per priority
+    uint8_t txUrgentStorage[TX_QUEUE_URGENT_SIZE];
+    uint8_t txNormalStorage[TX_QUEUE_NORMAL_SIZE];
+    uint8_t txTelemetryStorage[TX_QUEUE_TELEMETRY_SIZE];
+    TxBuffer txUrgent;
+    TxBuffer txNormal;
+    TxBuffer txTelemetry;
+    TxBuffer* txQueues[TX_PRIORITIES];
+    unsigned long txBytesQueued;    // Bytes accepted for sending
+    unsigned long txBytesDropped;   // Bytes dropped (full queue or superseded telemetry)
+    unsigned long txStalls;         // Messages that did not fit their queue
+    unsigned long txWaits;          // Messages that waited for the UART (no room left)
+    
+    // NORMAL messages waiting for queue space, as [length lo] [length hi] [bytes]
+    uint8_t txOverflow[TX_OVERFLOW_SIZE];
+    uint16_t txOverflowHead;        // First unsent message
+    uint16_t txOverflowUsed;        // Bytes stored (0 = none)
     
 public:
     /**
@@ -52,16 +88,37 @@ public:
     void update();
     
     /**
-     * @brief Send a reply
-     * @param reply Reply to send
+     * @brief Queue a reply for sending
+     * @param reply Reply to send (errors are always URGENT)
+     * @param priority Output queue
      */
-    void sendReply(const Reply& reply);
+    void sendReply(const Reply& reply, TxPriority priority = TxPriority::NORMAL);
     
     /**
-     * @brief Send raw message
+     * @brief Queue a raw message for sending
      * @param message Message string
+     * @param priority Output queue
+     * @param key Telemetry key; a newer message with the same key replaces
+     *            a queued one (TX_KEY_NONE to disable)
+     */
+    void sendMessage(const String& message, TxPriority priority = TxPriority::NORMAL, uint8_t key = TX_KEY_NONE);
+    
+    /**
+     * @brief Send all queued output, waiting for the UART
+     * 
+     * Only for paths that cannot return to the main loop (fatal errors).
+     */
+    void flush();
+    
+    /**
+     * @brief Queue a telemetry record
+     * 
+     * Text: "TLM <millis> <value> ...", binary: REPLY_TELEMETRY frame.
+     * A record still queued when the next one is sent is replaced.
+     * @param telemetry Subscribed channels (sampled now)
+     * @param timestamp Record time (millis)
      */
-    void sendMessage(const String& message);
+    void sendTelemetry(const Telemetry& telemetry, unsigned long timestamp);
     
     /**
      * @brief Set acknowledgment mode
@@ -75,6 +132,27 @@ public:
      */
     bool getAckMode() const { return ackMode; }
     
+    /**
+     * @brief Select wire format
+     * 
+     * Takes effect once the reply to the current command has been sent,
+     * so the acknowledgement still uses the old format.
+     * @param mode Text or binary protocol
+     */
+    void setProtocol(ProtocolMode mode) { pendingProtocol = mode; }
+    
+    /**
+     * @brief Get number of commands a host may have in flight
+     * @return Receive window (commands)
+     */
+    uint8_t getWindow() const { return COMMAND_WINDOW; }
+    
+    /**
+     * @brief Get active wire format
+     * @return Protocol mode
+     */
+    ProtocolMode getProtocol() const { return protocol; }
+    
     /**
      * @brief Get command statistics
      * @return Statistics string
@@ -93,10 +171,185 @@ private:
     void processSerialInput();
     
     /**
-     * @brief Process complete command
-     * @param commandStr Command string
+     * @brief Process complete text command
+     * @param commandStr Null-terminated command string
+     */
+    void processCommand(const char* commandStr);
+    
+    /**
+     * @brief Add a received byte in binary mode
+     * @param c Received byte
+     */
+    void processBinaryByte(uint8_t c);
+    
+    /**
+     * @brief Decode and execute a complete binary frame
+     * @param frame Frame bytes without the delimiter (decoded in place)
+     * @param length Frame length
+     */
+    void processBinaryFrame(uint8_t* frame, uint8_t length);
+    
+    /**
+     * @brief Move the received command out of inputBuffer
+     * 
+     * Done before the command is handled, so output that waits for the
+     * UART meanwhile can receive the next one.
+     * @param line Buffer of COMMAND_BUFFER_SIZE bytes for the command ('\0' terminated)
+     * @return Command length
+     */
+    uint8_t takeInput(char* line);
+    
+    /**
+     * @brief Queue a received command, or reject it as busy
+     *
+     * An emergency stop is executed at once instead.
+     * @param command Text command or binary frame ('\0' terminated)
+     * @param length Command length
+     */
+    void queueInput(char* command, uint8_t length);
+    
+    /**
+     * @brief Check if a received command is an emergency stop
+     * @param command Text command or binary frame ('\0' terminated)
+     * @param length Command length
+     * @return true for a text ESTOP command or a binary ESTOP request
+     */
+    bool isEmergencyStop(const char* command, uint8_t length) const;
+    
+    /**
+     * @brief Execute the oldest queued command
+     */
+    void executeQueued();
+    
+    /**
+     * @brief Execute an emergency stop received while output waited
+     */
+    void executePendingStop();
+    
+    /**
+     * @brief Execute a text command or binary frame
+     * @param command Command ('\0' terminated) or frame (decoded in place)
+     * @param length Command length
+     */
+    void executeInput(char* command, uint8_t length);
+    
+    /**
+     * @brief Reject a received command
+     * @param command Text command or binary frame (decoded in place)
+     * @param length Command length
+     * @param code Error code
+     * @param message Error message
+     */
+    void rejectInput(char* command, uint8_t length, ErrorCode code, const String& message);
+    
+    /**
+     * @brief Send a reply as binary frame(s)
+     * @param reply Reply to send
+     * @param seq Sequence number of the request (0 for events)
+     * @param deviceId Device id of the request or event source
+     * @param requestOpcode Opcode being answered
+     * @param priority Output queue
+     */
+    void sendBinaryReply(const Reply& reply, uint8_t seq, uint8_t deviceId, uint8_t requestOpcode,
+                         TxPriority priority = TxPriority::NORMAL);
+    
+    /**
+     * @brief Send one binary frame
+     * @param seq Sequence number
+     * @param deviceId Device id
+     * @param opcode Reply opcode
+     * @param payload Payload bytes
+     * @param length Payload length
+     * @param priority Output queue
+     * @param key Telemetry key
+     */
+    void sendFrame(uint8_t seq, uint8_t deviceId, BinaryOpcode opcode, const uint8_t* payload, uint8_t length,
+                   TxPriority priority = TxPriority::NORMAL, uint8_t key = TX_KEY_NONE);
+    
+    /**
+     * @brief Send text as INFO frames (split at BINARY_MAX_PAYLOAD)
+     * @param text Text to send
+     * @param priority Output queue
+     * @param key Telemetry key
+     */
+    void sendBinaryText(const String& text, TxPriority priority = TxPriority::NORMAL, uint8_t key = TX_KEY_NONE);
+    
+    /**
+     * @brief Queue bytes as one message
+     * 
+     * A full TELEMETRY queue drops its oldest message. A NORMAL message
+     * that does not fit (a stall) is kept in the overflow store until the
+     * NORMAL queue has room, so long replies such as CONTROLLER LIST are
+     * not truncated; queued commands are held back meanwhile. Only when
+     * the store is full does the caller wait for the UART. An URGENT
+     * message that does not fit waits for its own queue instead, so it
+     * never falls behind NORMAL output.
+     * @param data Message bytes
+     * @param length Number of bytes
+     * @param priority Output queue
+     * @param key Telemetry key
+     * @param suffix Bytes appended to the message (line end)
+     * @param suffixLength Number of suffix bytes
+     */
+    void queueOutput(const uint8_t* data, uint16_t length, TxPriority priority, uint8_t key,
+                     const uint8_t* suffix = nullptr, uint8_t suffixLength = 0);
+    
+    /**
+     * @brief Move queued output to the UART as far as it has room
+     */
+    void flushOutput();
+    
+    /**
+     * @brief Send the message on the wire, then URGENT output only
+     */
+    void flushUrgent();
+    
+    /**
+     * @brief Receive input while a message waits for the UART
+     * 
+     * Commands are queued or rejected as usual; an emergency stop is kept
+     * until the waiting command has returned. Waits within this one do not
+     * receive.
+     */
+    void receiveWhileWaiting();
+    
+    /**
+     * @brief Queue an URGENT message once its queue has room
+     * 
+     * Waits for the UART. A message longer than the queue is queued in
+     * pieces; no other output is started until the last one is queued.
+     * @param data Message bytes
+     * @param length Number of bytes
+     * @param suffix Bytes appended to the message
+     * @param suffixLength Number of suffix bytes
+     */
+    void addUrgent(const uint8_t* data, uint16_t length, const uint8_t* suffix, uint8_t suffixLength);
+    
+    /**
+     * @brief Keep a NORMAL message that does not fit its queue
+     * 
+     * Waits for the UART while the overflow store is full. A message
+     * longer than the store is kept in pieces, split at line ends if
+     * possible.
+     * @param data Message bytes
+     * @param length Number of bytes
+     * @param suffix Bytes appended to the message
+     * @param suffixLength Number of suffix bytes
+     */
+    void addOverflow(const uint8_t* data, uint16_t length, const uint8_t* suffix, uint8_t suffixLength);
+    
+    /**
+     * @brief Move overflow messages into the NORMAL queue as far as it has room
+     * 
+     * A message longer than the queue is split, at a line end if possible.
+     */
+    void moveOverflow();
+    
+    /**
+     * @brief Check if NORMAL output is backed up
+     * @return true while messages wait in the overflow store
      */
-    void processCommand(const String& commandStr);
+    bool isOutputBlocked() const { return txOverflowUsed > 0; }
     
     /**
      * @brief Check for command timeout
@@ -108,7 +361,9 @@ private:
      * @brief Clear input buffer
      */
     void clearBuffer() { 
-        inputBuffer = ""; 
+        inputLength = 0;
+        inputBuffer[0] = '\0';
+        inputOverflow = false;
         lastCharTime = millis(); 
     }
 };
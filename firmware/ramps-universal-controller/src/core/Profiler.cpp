@@ -0,0 +1,111 @@
+/**
+ * @file Profiler.cpp
+ * @brief Implementation of Profiler class
+ */
+
+#include "Profiler.h"
+
+#if ENABLE_PROFILING
+
+// Global profiler instance
+Profiler profiler;
+
+static const char* const PERF_CHANNEL_NAMES[(uint8_t)PerfChannel::COUNT] = {
+    "loop", "stepper", "servo", "mosfet", "switch", "sensor", "parse", "execute"
+};
+
+/**
+ * @brief Constructor
+ */
+Profiler::Profiler() {
+    reset();
+}
+
+/**
+ * @brief Record a duration
+ */
+void Profiler::record(PerfChannel channel, uint32_t us) {
+    if (channel >= PerfChannel::COUNT) return;
+    PerfStat& stat = stats[(uint8_t)channel];
+
+    if (stat.count == 0 || us < stat.min) stat.min = us;
+    if (us > stat.max) stat.max = us;
+    stat.count++;
+    stat.total += us;
+
+    // Bucket = bit length of the duration
+    uint8_t bucket = 0;
+    while (us > 0 && bucket < PERF_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    // Halve all buckets instead of saturating so the shape is kept
+    if (stat.histogram[bucket] == 0xFFFF) {
+        for (uint8_t i = 0; i < PERF_BUCKETS; i++) {
+            stat.histogram[i] >>= 1;
+        }
+    }
+    stat.histogram[bucket]++;
+}
+
+/**
+ * @brief Record the time since the previous loop pass
+ */
+void Profiler::markPass() {
+    unsigned long now = micros();
+    if (running) {
+        record(PerfChannel::LOOP, now - lastPass);
+    }
+    lastPass = now;
+    running = true;
+}
+
+/**
+ * @brief Get the update channel of a device type
+ */
+PerfChannel Profiler::deviceChannel(DeviceType type) {
+    switch (type) {
+        case DeviceType::STEPPER_MOTOR: return PerfChannel::STEPPER;
+        case DeviceType::SERVO_MOTOR:   return PerfChannel::SERVO;
+        case DeviceType::MOSFET_OUTPUT: return PerfChannel::MOSFET;
+        case DeviceType::END_SWITCH:    return PerfChannel::SWITCH;
+        case DeviceType::ANALOG_SENSOR: return PerfChannel::SENSOR;
+        default:                        return PerfChannel::COUNT;
+    }
+}
+
+/**
+ * @brief Clear all channels
+ */
+void Profiler::reset() {
+    memset(stats, 0, sizeof(stats));
+    running = false;    // The pass in progress is not a full period
+}
+
+/**
+ * @brief Get statistics of all channels
+ */
+String Profiler::getReport() const {
+    String report = "=== PERF (us) ===";
+    for (uint8_t c = 0; c < (uint8_t)PerfChannel::COUNT; c++) {
+        const PerfStat& stat = stats[c];
+        if (stat.count == 0) continue;
+
+        report += "\n" + String(PERF_CHANNEL_NAMES[c]) + ": n " + String(stat.count);
+        report += " min " + String(stat.min);
+        report += " avg " + String((uint32_t)(stat.total / stat.count));
+        report += " max " + String(stat.max);
+
+        // Non-empty buckets as <lower bound>:<count>
+        report += " |";
+        for (uint8_t i = 0; i < PERF_BUCKETS; i++) {
+            if (stat.histogram[i] == 0) continue;
+            uint32_t lower = (i == 0) ? 0 : (1UL << (i - 1));
+            report += " " + String(lower) + ":" + String(stat.histogram[i]);
+        }
+    }
+    return report;
+}
+
+#endif // ENABLE_PROFILING
@@ -0,0 +1,114 @@
+/**
+ * @file Profiler.h
+ * @brief micros() timing statistics for the main loop and commands
+ *
+ * Each channel keeps min/avg/max and a log2 histogram of durations:
+ * bucket 0 counts 0 us, bucket k counts 2^(k-1) to 2^k - 1 us and the
+ * last bucket everything longer. Enabled with ENABLE_PROFILING; when it
+ * is false the class is not built and the PERF_* macros expand to
+ * nothing.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+#if ENABLE_PROFILING
+
+#include "../devices/Device.h"
+
+#define PERF_BUCKETS            16      // Last bucket: 16384 us and longer
+
+/**
+ * @enum PerfChannel
+ * @brief Measured quantity
+ */
+enum class PerfChannel : uint8_t {
+    LOOP,           // Time between main loop passes
+    STEPPER,        // Device update times, by type
+    SERVO,
+    MOSFET,
+    SWITCH,
+    SENSOR,
+    PARSE,          // Command parse (text) or frame decode (binary)
+    EXECUTE,        // Command execution
+    COUNT
+};
+
+/**
+ * @struct PerfStat
+ * @brief Statistics of one channel
+ */
+struct PerfStat {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;                     // Sum for the average
+    uint16_t histogram[PERF_BUCKETS];   // Halved together when one fills up
+};
+
+/**
+ * @class Profiler
+ * @brief Timing statistics of all channels
+ */
+class Profiler {
+private:
+    PerfStat stats[(uint8_t)PerfChannel::COUNT];
+    unsigned long lastPass;         // micros() of the previous loop pass
+    bool running;                   // lastPass is valid
+
+public:
+    /**
+     * @brief Constructor
+     */
+    Profiler();
+
+    /**
+     * @brief Record a duration
+     * @param channel Measured quantity
+     * @param us Duration in microseconds
+     */
+    void record(PerfChannel channel, uint32_t us);
+
+    /**
+     * @brief Record the time since the previous loop pass
+     */
+    void markPass();
+
+    /**
+     * @brief Get the update channel of a device type
+     * @param type Device type
+     * @return Channel, COUNT if the type is not profiled
+     */
+    static PerfChannel deviceChannel(DeviceType type);
+
+    /**
+     * @brief Clear all channels
+     */
+    void reset();
+
+    /**
+     * @brief Get statistics of all channels that have samples
+     * @return Multi-line report
+     */
+    String getReport() const;
+};
+
+// Global profiler instance
+extern Profiler profiler;
+
+#define PERF_START(var)             unsigned long var = micros()
+#define PERF_END(channel, var)      profiler.record(channel, micros() - (var))
+#define PERF_PASS()                 profiler.markPass()
+
+#else
+
+#define PERF_START(var)
+#define PERF_END(channel, var)
+#define PERF_PASS()
+
+#endif // ENABLE_PROFILING
+
+#endif // PROFILER_H
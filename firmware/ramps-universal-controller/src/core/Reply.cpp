@@ -15,6 +15,11 @@ Reply::Reply() : Message(MessageType::REPLY) {
     errorMessage = "";
     errorCode = ERROR_NONE;
     isEvent = false;
+    number = 0.0;
+    decimals = 0;
+    isNumeric = false;
+    isTagged = false;
+    sequence = 0;
 }
 
 /**
@@ -28,6 +33,11 @@ Reply::Reply(const String& eventDevice) : Message(MessageType::EVENT) {
     errorMessage = "";
     errorCode = ERROR_NONE;
     isEvent = true;
+    number = 0.0;
+    decimals = 0;
+    isNumeric = false;
+    isTagged = false;
+    sequence = 0;
 }
 
 /**
@@ -48,7 +58,7 @@ String Reply::toString() const {
     
     switch (status) {
         case ReplyStatus::OK:
-            if (DEFAULT_ACK_MODE || value.length() > 0) {
+            if (DEFAULT_ACK_MODE || value.length() > 0 || isTagged) {
                 result = deviceName;
                 if (interface.length() > 0) {
                     result += " " + interface;
@@ -77,7 +87,13 @@ String Reply::toString() const {
             if (interface.length() > 0) {
                 result += " " + interface;
             }
-            result += " " + value;
+            if (!isNumeric) {
+                result += " " + value;
+            } else if (decimals == 0) {
+                result += " " + String((long)round(number));
+            } else {
+                result += " " + String(number, decimals);
+            }
             break;
             
         case ReplyStatus::EVENT:
@@ -105,6 +121,10 @@ String Reply::toString() const {
             break;
     }
     
+    if (isTagged && result.length() > 0) {
+        result = String(COMMAND_SEQUENCE_CHAR) + String((unsigned int)sequence) + " " + result;
+    }
+    
     return result;
 }
 
@@ -118,6 +138,7 @@ bool Reply::isValid() const {
         case ReplyStatus::INFO:
             return value.length() > 0;
         case ReplyStatus::VALUE:
+            return deviceName.length() > 0 && (isNumeric || value.length() > 0);
         case ReplyStatus::EVENT:
             return deviceName.length() > 0 && value.length() > 0;
         default:
@@ -193,6 +214,22 @@ void Reply::setValue(const String& device, const String& iface, const String& va
     deviceName = device;
     interface = iface;
     value = val;
+    isNumeric = false;
+    errorCode = ERROR_NONE;
+    isEvent = false;
+}
+
+/**
+ * @brief Set as numeric value reply
+ */
+void Reply::setValue(const String& device, const String& iface, float val, uint8_t digits) {
+    status = ReplyStatus::VALUE;
+    deviceName = device;
+    interface = iface;
+    value = "";
+    number = val;
+    decimals = digits;
+    isNumeric = true;
     errorCode = ERROR_NONE;
     isEvent = false;
 }
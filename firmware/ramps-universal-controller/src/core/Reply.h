@@ -34,6 +34,11 @@ private:
     String errorMessage;        // Error description
     ErrorCode errorCode;        // Error code
     bool isEvent;               // Is this an unsolicited event?
+    float number;               // Numeric value (formatted on output)
+    uint8_t decimals;           // Decimals used when formatting number
+    bool isNumeric;             // Value is held in number
+    bool isTagged;              // Answers a command with a sequence tag
+    uint16_t sequence;          // Sequence tag of that command
     
 public:
     /**
@@ -90,6 +95,18 @@ public:
      */
     void setValue(const String& device, const String& iface, const String& val);
     
+    /**
+     * @brief Set as numeric value reply
+     * 
+     * The value is only formatted by toString(), so binary replies carry
+     * it without a float-to-text round trip.
+     * @param device Device name
+     * @param iface Interface name
+     * @param val Value
+     * @param digits Decimals in the text reply
+     */
+    void setValue(const String& device, const String& iface, float val, uint8_t digits);
+    
     /**
      * @brief Set as event notification
      * @param device Device name
@@ -104,12 +121,51 @@ public:
      */
     void setInfo(const String& info);
     
+    /**
+     * @brief Tag the reply with the command's sequence number
+     * 
+     * Tagged replies are always sent (also OK in quiet mode) and start
+     * with #<n>, so a host with several commands in flight can match them.
+     * @param seq Sequence number
+     */
+    void setSequence(uint16_t seq) { sequence = seq; isTagged = true; }
+    
     /**
      * @brief Get reply status
      * @return Reply status enum
      */
     ReplyStatus getStatus() const { return status; }
     
+    /**
+     * @brief Get interface name
+     * @return Interface string
+     */
+    const String& getInterface() const { return interface; }
+    
+    /**
+     * @brief Get text value
+     * @return Value string (empty for numeric values)
+     */
+    const String& getValue() const { return value; }
+    
+    /**
+     * @brief Check if the value is numeric
+     * @return true if set with a numeric value
+     */
+    bool hasNumber() const { return isNumeric; }
+    
+    /**
+     * @brief Get numeric value
+     * @return Value
+     */
+    float getNumber() const { return number; }
+    
+    /**
+     * @brief Get error message
+     * @return Error description
+     */
+    const String& getErrorMessage() const { return errorMessage; }
+    
     /**
      * @brief Get error code
      * @return Error code
@@ -0,0 +1,126 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Implementation of Scheduler class
+ */
+
+#include "Scheduler.h"
+
+// Global scheduler instance
+Scheduler scheduler;
+
+/**
+ * @brief Constructor
+ */
+Scheduler::Scheduler() {
+    taskCount = 0;
+    passCount = 0;
+    statsStart = 0;
+}
+
+/**
+ * @brief Add a task
+ */
+uint8_t Scheduler::add(const char* name, TaskFunction function, void* context,
+                       unsigned long period, TaskPriority priority) {
+    if (taskCount >= SCHEDULER_MAX_TASKS || !function) {
+        return TASK_NONE;
+    }
+
+    uint8_t id = taskCount;
+    Task& task = tasks[id];
+    task.name = name;
+    task.function = function;
+    task.context = context;
+    task.period = period;
+    task.lastRun = millis();
+    task.priority = priority;
+    task.enabled = true;
+    task.runCount = 0;
+    task.wcet = 0;
+
+    // Insert after the tasks of the same or higher priority
+    uint8_t slot = taskCount;
+    while (slot > 0 && tasks[order[slot - 1]].priority > priority) {
+        order[slot] = order[slot - 1];
+        slot--;
+    }
+    order[slot] = id;
+
+    taskCount++;
+    return id;
+}
+
+/**
+ * @brief Run the tasks that are due
+ */
+void Scheduler::run() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& task = tasks[order[i]];
+        if (!task.enabled) continue;
+
+        if (task.period > 0) {
+            unsigned long elapsed = millis() - task.lastRun;
+            if (elapsed < task.period) continue;
+
+            if (elapsed >= 2 * task.period) {
+                task.lastRun = millis();    // Missed a slot; restart the grid
+            } else {
+                task.lastRun += task.period;
+            }
+        }
+
+        unsigned long start = micros();
+        task.function(task.context);
+        uint32_t duration = micros() - start;
+
+        task.runCount++;
+        if (duration > task.wcet) {
+            task.wcet = duration;
+        }
+    }
+    passCount++;
+}
+
+/**
+ * @brief Enable or disable a task
+ */
+void Scheduler::setEnabled(uint8_t id, bool enabled) {
+    if (id >= taskCount) return;
+    if (enabled && !tasks[id].enabled) {
+        tasks[id].lastRun = millis();
+    }
+    tasks[id].enabled = enabled;
+}
+
+/**
+ * @brief Clear run counts and worst case times
+ */
+void Scheduler::resetStatistics() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].runCount = 0;
+        tasks[i].wcet = 0;
+    }
+    passCount = 0;
+    statsStart = millis();
+}
+
+/**
+ * @brief Get task table
+ */
+String Scheduler::getStatus() const {
+    unsigned long elapsed = millis() - statsStart;
+
+    String status = "=== TASKS ===\n";
+    status += "Passes: " + String(passCount) + " in " + String(elapsed) + " ms";
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const Task& task = tasks[order[i]];
+        status += "\n" + String(task.name) + ": period " + String(task.period) + " ms";
+        status += ", priority " + String((uint8_t)task.priority);
+        status += ", runs " + String(task.runCount);
+        status += ", wcet " + String(task.wcet) + " us";
+        if (!task.enabled) {
+            status += ", DISABLED";
+        }
+    }
+    return status;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file Scheduler.h
+ * @brief Cooperative task scheduler for the main loop
+ *
+ * Subsystems register a task with a period and a priority instead of
+ * being called from loop() in a fixed order. Each pass runs the tasks
+ * that are due, highest priority first; a task must return quickly and
+ * never block. The loop spins freely, so the shortest period (or a
+ * period of 0, every pass) sets the rate.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+#define TASK_NONE               0xFF    // Returned when the task table is full
+
+/**
+ * @enum TaskPriority
+ * @brief Order of tasks that are due in the same pass
+ */
+enum class TaskPriority : uint8_t {
+    IO,             // Serial input and output
+    DEVICE,         // Device updates
+    CONTROL,        // Loops fed by device values (heaters, homing)
+    BACKGROUND      // Telemetry, heartbeat
+};
+
+/**
+ * @brief Task function
+ * @param context Pointer given when the task was added
+ */
+typedef void (*TaskFunction)(void* context);
+
+/**
+ * @struct Task
+ * @brief One scheduled task and its statistics
+ */
+struct Task {
+    const char* name;
+    TaskFunction function;
+    void* context;
+    unsigned long period;           // ms between runs (0 = every pass)
+    unsigned long lastRun;          // Scheduled time of the last run
+    TaskPriority priority;
+    bool enabled;
+    uint32_t runCount;
+    uint32_t wcet;                  // Longest run in us
+};
+
+/**
+ * @class Scheduler
+ * @brief Fixed table of periodic tasks
+ */
+class Scheduler {
+private:
+    Task tasks[SCHEDULER_MAX_TASKS];    // Indexed by task id
+    uint8_t order[SCHEDULER_MAX_TASKS]; // Task ids by priority
+    uint8_t taskCount;
+    uint32_t passCount;             // Loop passes since the last reset
+    unsigned long statsStart;       // millis() of the last reset
+
+public:
+    /**
+     * @brief Constructor
+     */
+    Scheduler();
+
+    /**
+     * @brief Add a task
+     * @param name Task name (must outlive the task)
+     * @param function Function to run
+     * @param context Passed to the function
+     * @param period ms between runs (0 = every pass)
+     * @param priority Order among tasks due in the same pass
+     * @return Task id, TASK_NONE if the table is full
+     */
+    uint8_t add(const char* name, TaskFunction function, void* context,
+                unsigned long period, TaskPriority priority);
+
+    /**
+     * @brief Run the tasks that are due (call from loop())
+     */
+    void run();
+
+    /**
+     * @brief Enable or disable a task
+     * @param id Task id
+     * @param enabled true to run the task
+     */
+    void setEnabled(uint8_t id, bool enabled);
+
+    /**
+     * @brief Clear run counts and worst case times
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Get number of tasks
+     * @return Task count
+     */
+    uint8_t getCount() const { return taskCount; }
+
+    /**
+     * @brief Get task table with run counts and worst case times
+     * @return Multi-line status
+     */
+    String getStatus() const;
+};
+
+// Global scheduler instance
+extern Scheduler scheduler;
+
+#endif // SCHEDULER_H
@@ -0,0 +1,186 @@
+/**
+ * @file Telemetry.cpp
+ * @brief Implementation of Telemetry class
+ */
+
+#include "Telemetry.h"
+#include "../devices/Device.h"
+#include "../devices/Actuator.h"
+#include "../devices/Sensor.h"
+#include "../devices/sensors/EndSwitch.h"
+
+/**
+ * @brief Check if a device is an actuator
+ */
+static bool isActuator(const Device* device) {
+    DeviceType type = device->getType();
+    return type == DeviceType::STEPPER_MOTOR ||
+           type == DeviceType::SERVO_MOTOR ||
+           type == DeviceType::MOSFET_OUTPUT;
+}
+
+/**
+ * @brief Constructor
+ */
+Telemetry::Telemetry() {
+    channelCount = 0;
+    period = STATUS_UPDATE_INTERVAL;
+    lastRecord = 0;
+}
+
+/**
+ * @brief Subscribe to a device value
+ */
+bool Telemetry::add(Device* device, TelemetrySource source) {
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].device == device && channels[i].source == source) {
+            return true;
+        }
+    }
+
+    if (channelCount >= TELEMETRY_MAX_CHANNELS) {
+        return false;
+    }
+
+    channels[channelCount].device = device;
+    channels[channelCount].source = source;
+    channelCount++;
+    return true;
+}
+
+/**
+ * @brief Remove all channels of a device
+ */
+uint8_t Telemetry::remove(Device* device) {
+    uint8_t kept = 0;
+
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (channels[i].device != device) {
+            channels[kept++] = channels[i];
+        }
+    }
+
+    uint8_t removed = channelCount - kept;
+    channelCount = kept;
+    return removed;
+}
+
+/**
+ * @brief Set the record period
+ */
+void Telemetry::setPeriod(unsigned long ms) {
+    period = ms;
+    lastRecord = millis();
+}
+
+/**
+ * @brief Check if a record is due
+ */
+bool Telemetry::isDue(unsigned long now) {
+    if (period == 0 || channelCount == 0) {
+        return false;
+    }
+
+    unsigned long elapsed = now - lastRecord;
+    if (elapsed < period) {
+        return false;
+    }
+
+    if (elapsed >= 2 * period) {
+        lastRecord = now;       // Missed a slot; restart the grid
+    } else {
+        lastRecord += period;
+    }
+    return true;
+}
+
+/**
+ * @brief Sample one channel
+ */
+float Telemetry::sample(uint8_t index) const {
+    const TelemetryChannel& channel = channels[index];
+
+    switch (channel.source) {
+        case TelemetrySource::POSITION:
+            return static_cast<const Actuator*>(channel.device)->getPosition();
+        case TelemetrySource::VELOCITY:
+            return static_cast<const Actuator*>(channel.device)->getVelocity();
+        case TelemetrySource::VALUE:
+            return static_cast<const Sensor*>(channel.device)->getValue();
+        case TelemetrySource::STATE:
+            return static_cast<const EndSwitch*>(channel.device)->getState() ? 1.0 : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+/**
+ * @brief Get decimals used for a channel in text records
+ */
+uint8_t Telemetry::getDecimals(uint8_t index) const {
+    switch (channels[index].source) {
+        case TelemetrySource::STATE: return 0;
+        case TelemetrySource::VALUE: return 2;
+        default:                     return 3;
+    }
+}
+
+/**
+ * @brief Describe the channels in record order
+ */
+String Telemetry::describe() const {
+    String list = "";
+
+    for (uint8_t i = 0; i < channelCount; i++) {
+        if (i > 0) list += " ";
+        list += channels[i].device->getName() + "." + getSourceName(channels[i].source);
+    }
+    return list;
+}
+
+/**
+ * @brief Get the default source of a device type
+ */
+TelemetrySource Telemetry::defaultSource(const Device* device) {
+    if (isActuator(device)) return TelemetrySource::POSITION;
+    if (device->getType() == DeviceType::END_SWITCH) return TelemetrySource::STATE;
+    return TelemetrySource::VALUE;
+}
+
+/**
+ * @brief Look up a source by name
+ */
+bool Telemetry::parseSource(const char* name, const Device* device, TelemetrySource& source) {
+    bool actuator = isActuator(device);
+
+    if (strcasecmp(name, "position") == 0 || strcasecmp(name, "pos") == 0) {
+        source = TelemetrySource::POSITION;
+        return actuator;
+    }
+    if (strcasecmp(name, "velocity") == 0 || strcasecmp(name, "vel") == 0) {
+        source = TelemetrySource::VELOCITY;
+        return actuator;
+    }
+    if (strcasecmp(name, "value") == 0 || strcasecmp(name, "read") == 0) {
+        source = TelemetrySource::VALUE;
+        return !actuator;
+    }
+    if (strcasecmp(name, "state") == 0) {
+        source = TelemetrySource::STATE;
+        return device->getType() == DeviceType::END_SWITCH;
+    }
+    return false;
+}
+
+/**
+ * @brief Get name of a source
+ */
+const char* Telemetry::getSourceName(TelemetrySource source) {
+    switch (source) {
+        case TelemetrySource::POSITION: return "position";
+        case TelemetrySource::VELOCITY: return "velocity";
+        case TelemetrySource::VALUE:    return "value";
+        case TelemetrySource::STATE:    return "state";
+        default:                        return "unknown";
+    }
+}
@@ -0,0 +1,151 @@
+/**
+ * @file Telemetry.h
+ * @brief Periodic telemetry subscriptions
+ *
+ * The host subscribes to device values (`>X subscribe position`) and the
+ * controller sends one record with all of them every period, instead of
+ * the host polling each value. Records go to the TELEMETRY output queue,
+ * where a late record is replaced by the next one.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Forward declaration
+class Device;
+
+#define TELEMETRY_TX_KEY        0x01    // Output queue key of telemetry records
+
+/**
+ * @enum TelemetrySource
+ * @brief Device value sampled by a channel
+ */
+enum class TelemetrySource : uint8_t {
+    POSITION,       // Actuator position
+    VELOCITY,       // Actuator velocity
+    VALUE,          // Last sensor reading
+    STATE           // End switch state (0/1)
+};
+
+/**
+ * @struct TelemetryChannel
+ * @brief One subscribed device value
+ */
+struct TelemetryChannel {
+    Device* device;
+    TelemetrySource source;
+};
+
+/**
+ * @class Telemetry
+ * @brief Subscribed channels and the record period
+ */
+class Telemetry {
+private:
+    TelemetryChannel channels[TELEMETRY_MAX_CHANNELS];
+    uint8_t channelCount;
+    unsigned long period;           // ms between records (0 = paused)
+    unsigned long lastRecord;       // Scheduled time of the last record
+
+public:
+    /**
+     * @brief Constructor
+     */
+    Telemetry();
+
+    /**
+     * @brief Subscribe to a device value
+     * @param device Device to sample
+     * @param source Value to sample
+     * @return false if the table is full (already subscribed counts as success)
+     */
+    bool add(Device* device, TelemetrySource source);
+
+    /**
+     * @brief Remove all channels of a device
+     * @param device Device
+     * @return Number of channels removed
+     */
+    uint8_t remove(Device* device);
+
+    /**
+     * @brief Remove all channels
+     */
+    void clear() { channelCount = 0; }
+
+    /**
+     * @brief Set the record period
+     * @param ms Milliseconds between records (0 pauses)
+     */
+    void setPeriod(unsigned long ms);
+
+    /**
+     * @brief Get the record period
+     * @return Milliseconds between records
+     */
+    unsigned long getPeriod() const { return period; }
+
+    /**
+     * @brief Get number of channels
+     * @return Channel count
+     */
+    uint8_t getCount() const { return channelCount; }
+
+    /**
+     * @brief Check if a record is due and advance the schedule
+     *
+     * Records are scheduled on a fixed grid so samples stay evenly
+     * spaced; after a long stall the grid restarts instead of bursting.
+     * @param now Current millis()
+     * @return true if a record should be sent now
+     */
+    bool isDue(unsigned long now);
+
+    /**
+     * @brief Sample one channel
+     * @param index Channel index
+     * @return Current value
+     */
+    float sample(uint8_t index) const;
+
+    /**
+     * @brief Get decimals used for a channel in text records
+     * @param index Channel index
+     * @return Number of decimals
+     */
+    uint8_t getDecimals(uint8_t index) const;
+
+    /**
+     * @brief Describe the channels in record order
+     * @return "<device>.<source> ..." list
+     */
+    String describe() const;
+
+    /**
+     * @brief Get the default source of a device type
+     * @param device Device
+     * @return Position for actuators, state for switches, value for sensors
+     */
+    static TelemetrySource defaultSource(const Device* device);
+
+    /**
+     * @brief Look up a source by name
+     * @param name "position", "velocity", "value"/"read" or "state"
+     * @param device Device the source must apply to
+     * @param source Result
+     * @return false if the name is unknown or not available on the device
+     */
+    static bool parseSource(const char* name, const Device* device, TelemetrySource& source);
+
+    /**
+     * @brief Get name of a source
+     * @param source Source
+     * @return Source name
+     */
+    static const char* getSourceName(TelemetrySource source);
+};
+
+#endif // TELEMETRY_H
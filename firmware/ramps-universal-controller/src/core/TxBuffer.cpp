@@ -0,0 +1,140 @@
+/**
+ * @file TxBuffer.cpp
+ * @brief Implementation of TxBuffer class
+ */
+
+#include "TxBuffer.h"
+
+/**
+ * @brief Constructor
+ */
+TxBuffer::TxBuffer(uint8_t* storage, uint16_t capacity) {
+    buffer = storage;
+    size = capacity;
+    head = 0;
+    used = 0;
+    peak = 0;
+    sending = 0;
+    tail = 0;
+}
+
+/**
+ * @brief Start a message
+ */
+bool TxBuffer::begin(uint16_t length, uint8_t key) {
+    if ((uint32_t)used + HEADER_SIZE + length > size) {
+        return false;
+    }
+
+    tail = (head + used) % size;
+    uint8_t header[HEADER_SIZE] = { key, (uint8_t)length, (uint8_t)(length >> 8) };
+    used += HEADER_SIZE + length;
+    if (used > peak) peak = used;
+
+    write(header, HEADER_SIZE);
+    return true;
+}
+
+/**
+ * @brief Add bytes to the current message
+ */
+void TxBuffer::write(const uint8_t* data, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        buffer[tail] = data[i];
+        tail = (tail + 1 == size) ? 0 : tail + 1;
+    }
+}
+
+/**
+ * @brief Mark queued messages with this key as superseded
+ */
+uint16_t TxBuffer::coalesce(uint8_t key) {
+    uint16_t superseded = 0;
+    uint16_t offset = 0;
+
+    // The head message may already be on the wire
+    if (sending > 0 && used > 0) {
+        offset = HEADER_SIZE + lengthAt(0);
+    }
+
+    while (offset < used) {
+        uint16_t length = lengthAt(offset);
+        if (at(offset) == key) {
+            buffer[(head + offset) % size] = TX_KEY_DEAD;
+            superseded += length;
+        }
+        offset += HEADER_SIZE + length;
+    }
+    return superseded;
+}
+
+/**
+ * @brief Drop the oldest message that has not started sending
+ */
+uint16_t TxBuffer::dropOldest() {
+    if (used == 0) return 0;
+
+    if (sending == 0) {
+        uint16_t length = lengthAt(0);
+        pop();
+        return length;
+    }
+
+    // Mark the next message instead; it is skipped when reached
+    uint16_t offset = HEADER_SIZE + lengthAt(0);
+    while (offset < used) {
+        uint16_t length = lengthAt(offset);
+        if (at(offset) != TX_KEY_DEAD) {
+            buffer[(head + offset) % size] = TX_KEY_DEAD;
+            return length;
+        }
+        offset += HEADER_SIZE + length;
+    }
+    return 0;
+}
+
+/**
+ * @brief Send queued bytes without blocking
+ */
+uint16_t TxBuffer::drain(uint16_t budget) {
+    uint16_t sent = 0;
+
+    while (used > 0 && sent < budget) {
+        if (sending == 0) {
+            // Skip superseded messages without sending them
+            if (at(0) == TX_KEY_DEAD) {
+                pop();
+                continue;
+            }
+            sending = lengthAt(0);
+            if (sending == 0) {
+                pop();
+                continue;
+            }
+        }
+
+        // Send the contiguous part of the message body
+        uint16_t start = (head + HEADER_SIZE + lengthAt(0) - sending) % size;
+        uint16_t chunk = sending;
+        if (chunk > size - start) chunk = size - start;
+        if (chunk > budget - sent) chunk = budget - sent;
+
+        Serial.write(buffer + start, chunk);
+        sent += chunk;
+        sending -= chunk;
+
+        if (sending == 0) {
+            pop();
+        }
+    }
+    return sent;
+}
+
+/**
+ * @brief Remove the head message
+ */
+void TxBuffer::pop() {
+    uint16_t total = HEADER_SIZE + lengthAt(0);
+    head = (head + total) % size;
+    used -= total;
+}
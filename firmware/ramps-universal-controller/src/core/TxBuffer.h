@@ -0,0 +1,141 @@
+/**
+ * @file TxBuffer.h
+ * @brief Ring buffer of outgoing messages
+ *
+ * Messages are stored whole as [key] [length lo] [length hi] [bytes] so
+ * the interface can send them in priority order without interleaving
+ * two messages, and can replace or drop queued telemetry.
+ */
+
+#ifndef TX_BUFFER_H
+#define TX_BUFFER_H
+
+#include <Arduino.h>
+
+/**
+ * @enum TxPriority
+ * @brief Output queue of a message (sent in this order)
+ */
+enum class TxPriority : uint8_t {
+    URGENT,         // Errors and ESTOP acknowledgements
+    NORMAL,         // Replies, events and information
+    TELEMETRY       // Periodic data; coalesced or dropped when late
+};
+
+#define TX_PRIORITIES           3
+#define TX_KEY_NONE             0x00    // Message is never coalesced
+#define TX_KEY_DEAD             0xFF    // Superseded message, skipped when sending
+
+/**
+ * @class TxBuffer
+ * @brief Byte ring holding complete messages
+ */
+class TxBuffer {
+private:
+    uint8_t* buffer;
+    uint16_t size;
+    uint16_t head;                  // First byte of the oldest message
+    uint16_t used;                  // Bytes in the ring (headers included)
+    uint16_t peak;                  // Highest value of used
+    uint16_t sending;               // Bytes of the head message still to send (0 = not started)
+    uint16_t tail;                  // Write position of the message being added
+
+public:
+    static const uint8_t HEADER_SIZE = 3;
+
+    /**
+     * @brief Constructor
+     * @param storage Ring storage (owned by the caller)
+     * @param capacity Ring size in bytes
+     */
+    TxBuffer(uint8_t* storage, uint16_t capacity);
+
+    /**
+     * @brief Start a message
+     * @param length Message length
+     * @param key Coalescing key (TX_KEY_NONE if none)
+     * @return false if there is no room (nothing is written)
+     */
+    bool begin(uint16_t length, uint8_t key);
+
+    /**
+     * @brief Add bytes to the message started with begin()
+     * @param data Bytes
+     * @param length Number of bytes
+     */
+    void write(const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief Mark queued messages with this key as superseded
+     * @param key Coalescing key
+     * @return Bytes superseded
+     */
+    uint16_t coalesce(uint8_t key);
+
+    /**
+     * @brief Drop the oldest message that has not started sending
+     * @return Bytes dropped (0 if none)
+     */
+    uint16_t dropOldest();
+
+    /**
+     * @brief Send queued bytes to the serial port without blocking
+     * @param budget Maximum bytes to send
+     * @return Bytes sent
+     */
+    uint16_t drain(uint16_t budget);
+
+    /**
+     * @brief Check if a message is partly sent
+     * @return true if the head message has started
+     */
+    bool isSending() const { return sending > 0; }
+
+    /**
+     * @brief Get the rest of the message on the wire
+     * @return Bytes of the head message still to send (0 = not started)
+     */
+    uint16_t getSending() const { return sending; }
+
+    /**
+     * @brief Check for queued messages
+     * @return true if empty
+     */
+    bool isEmpty() const { return used == 0; }
+
+    /**
+     * @brief Get free space for a message body
+     * @return Bytes available after the header
+     */
+    uint16_t getFree() const { return (size - used > HEADER_SIZE) ? size - used - HEADER_SIZE : 0; }
+
+    /**
+     * @brief Get ring size
+     * @return Capacity in bytes
+     */
+    uint16_t getSize() const { return size; }
+
+    /**
+     * @brief Get peak occupancy
+     * @return Highest number of bytes queued
+     */
+    uint16_t getPeak() const { return peak; }
+
+private:
+    /**
+     * @brief Byte at an offset from head
+     */
+    uint8_t at(uint16_t offset) const { return buffer[(head + offset) % size]; }
+
+    /**
+     * @brief Length of the message starting at an offset from head
+     */
+    uint16_t lengthAt(uint16_t offset) const { return at(offset + 1) | ((uint16_t)at(offset + 2) << 8); }
+
+    /**
+     * @brief Remove the head message
+     */
+    void pop();
+};
+
+#endif // TX_BUFFER_H
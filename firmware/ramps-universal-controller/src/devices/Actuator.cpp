@@ -25,12 +25,12 @@ String Actuator::getStatus() const {
     String status = Device::getStatus();
     
     status += ", Pos: ";
-    status += String(currentPosition, 2);
+    status += String(getPosition(), 2);
     status += "/";
     status += String(targetPosition, 2);
     
     status += ", Vel: ";
-    status += String(currentVelocity, 2);
+    status += String(getVelocity(), 2);
     status += "/";
     status += String(targetVelocity, 2);
     
@@ -10,45 +10,44 @@
 /**
  * @brief Constructor
  */
-StepperMotor::StepperMotor(const String& name, int step, int dir, int enable, float stepsRev) 
+StepperMotor::StepperMotor(const String& name, int step, int dir, int enable, float stepsRev,
+                           float maxRate, float accel)
     : Actuator(name, DeviceType::STEPPER_MOTOR) {
     stepPin = step;
     dirPin = dir;
     enablePin = enable;
+    enableOutput.attach(enable);
     stepsPerRev = stepsRev;
     stepsPerUnit = stepsRev / (2.0 * PI);  // Default: steps per radian
     velocityMode = false;
     invertDirection = false;
+    jerk = DEFAULT_JERK;
     
-    // Create AccelStepper instance
-    stepper = new AccelStepper(AccelStepper::DRIVER, stepPin, dirPin);
-}
+    // Configured limits are in steps; the interface works in units
+    if (maxRate > 0.0) maxVelocity = stepsToSpeedUnits(maxRate);
+    if (accel > 0.0) acceleration = stepsToSpeedUnits(accel);
 
-/**
- * @brief Destructor
- */
-StepperMotor::~StepperMotor() {
-    if (stepper) {
-        delete stepper;
-    }
+    // Register with the step generator
+    axis = stepGenerator.attachAxis(stepPin, dirPin);
 }
 
 /**
  * @brief Initialize the stepper motor
  */
 bool StepperMotor::init() {
-    if (!stepper) return false;
-    
+    if (axis == StepGenerator::NO_AXIS) return false;
+
     // Configure enable pin
     pinMode(enablePin, OUTPUT);
-    digitalWrite(enablePin, STEPPER_ENABLE_OFF);  // Start disabled
-    
-    // Configure stepper parameters
-    stepper->setMaxSpeed(speedUnitsToSteps(maxVelocity));
-    stepper->setAcceleration(speedUnitsToSteps(acceleration));
-    stepper->setPinsInverted(invertDirection, false, true);  // dir, step, enable
-    stepper->setCurrentPosition(0);
-    
+    enableOutput.write(STEPPER_ENABLE_OFF);  // Start disabled
+
+    // Configure step generation
+    stepGenerator.initAxis(axis);
+    stepGenerator.setInvertDirection(axis, invertDirection);
+    stepGenerator.setAcceleration(axis, speedUnitsToSteps(acceleration));
+    stepGenerator.setJerk(axis, speedUnitsToSteps(jerk));
+    stepGenerator.setPosition(axis, 0);
+
     // Initialize state
     currentPosition = 0.0;
     targetPosition = 0.0;
@@ -57,48 +56,56 @@ bool StepperMotor::init() {
     velocityMode = false;
     enabled = false;  // Start disabled
     state = DeviceState::DISABLED;
-    
+
     return true;
 }
 
 /**
  * @brief Update motor state
+ *
+ * Steps are generated by the timer interrupt; this only keeps continuous
+ * rotation going. Position and velocity stay in steps until a reply asks
+ * for them (getPosition()/getVelocity()).
  */
 void StepperMotor::update() {
-    if (!stepper || !enabled) return;
-    
-    // Handle velocity mode
+    if (axis == StepGenerator::NO_AXIS || !enabled) return;
+
+    long position = stepGenerator.getPosition(axis);
+    bool moving = stepGenerator.isRunning(axis);
+
     if (velocityMode) {
-        // In velocity mode, continuously adjust target to maintain speed
-        if (abs(stepper->speed()) < abs(speedUnitsToSteps(targetVelocity)) * 0.95) {
-            // Still accelerating or need to adjust
-            long target = (targetVelocity > 0) ? LONG_MAX_STEPS : LONG_MIN_STEPS;
-            stepper->moveTo(target);
+        // A limit switch ended the run
+        if (targetVelocity != 0.0 && stepGenerator.isLimited(axis, targetVelocity > 0)) {
+            targetVelocity = 0.0;
         }
         
-        // Check if we need to stop
-        if (targetVelocity == 0.0 && stepper->speed() == 0.0) {
-            velocityMode = false;
-            state = DeviceState::IDLE;
-        } else {
-            state = DeviceState::ACTIVE;
+        // Keep the target far ahead of the motor
+        if (targetVelocity != 0.0 &&
+            abs(stepGenerator.getTarget(axis) - position) < VELOCITY_MODE_DISTANCE / 2) {
+            MoveSegment segment;
+            segment.target = position + ((targetVelocity > 0) ? VELOCITY_MODE_DISTANCE : -VELOCITY_MODE_DISTANCE);
+            segment.maxRate = speedUnitsToSteps(targetVelocity);
+            stepGenerator.submit(axis, segment);
         }
-    } else {
-        // Position mode
-        if (stepper->distanceToGo() != 0) {
-            state = DeviceState::ACTIVE;
-        } else {
-            state = DeviceState::IDLE;
+
+        // Check if we have stopped
+        if (targetVelocity == 0.0 && !moving) {
+            velocityMode = false;
         }
     }
-    
-    // Run the stepper
-    bool moving = stepper->run();
-    
-    // Update current values
-    currentPosition = stepsToUnits(stepper->currentPosition());
-    currentVelocity = stepsToSpeedUnits(stepper->speed());
-    
+
+    // An S-curve move that had to come to rest first (reversal or a
+    // target moved behind the motor) continues from here
+    if (!moving && stepGenerator.getTarget(axis) != position) {
+        MoveSegment segment;
+        segment.target = stepGenerator.getTarget(axis);
+        segment.maxRate = speedUnitsToSteps(velocityMode ? targetVelocity : maxVelocity);
+        stepGenerator.submit(axis, segment);
+        moving = stepGenerator.isRunning(axis);
+    }
+
+    state = moving ? DeviceState::ACTIVE : DeviceState::IDLE;
+
     updateTimestamp();
 }
 
@@ -106,11 +113,11 @@ void StepperMotor::update() {
  * @brief Stop the motor
  */
 void StepperMotor::stop() {
-    if (!stepper) return;
-    
+    if (axis == StepGenerator::NO_AXIS) return;
+
     velocityMode = false;
     targetVelocity = 0.0;
-    stepper->stop();  // Decelerate to stop
+    stepGenerator.stop(axis);  // Decelerate to stop
     state = DeviceState::IDLE;
 }
 
@@ -119,8 +126,8 @@ void StepperMotor::stop() {
  */
 void StepperMotor::reset() {
     stop();
-    if (stepper) {
-        stepper->setCurrentPosition(0);
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setPosition(axis, 0);
     }
     currentPosition = 0.0;
     targetPosition = 0.0;
@@ -134,68 +141,76 @@ void StepperMotor::reset() {
  * @brief Set target position
  */
 bool StepperMotor::setPosition(float position) {
-    if (!stepper) {
-        if (DEBUG_ENABLED) {
-            Serial.println("ERROR: StepperMotor::setPosition() - Stepper object is null");
-        }
+    // The controller's error reply tells the host why
+    if (axis == StepGenerator::NO_AXIS || !enabled) {
         return false;
     }
-    
-    if (!enabled) {
-        if (DEBUG_ENABLED) {
-            Serial.print("ERROR: StepperMotor::setPosition() - Motor '");
-            Serial.print(name);
-            Serial.println("' is not enabled. Use 'enable' command first.");
-        }
-        return false;
-    }
-    
+
     velocityMode = false;
     targetPosition = position;
-    long targetSteps = unitsToSteps(position);
-    stepper->moveTo(targetSteps);
-    
-    return true;
+
+    MoveSegment segment;
+    segment.target = unitsToSteps(position);
+    segment.maxRate = speedUnitsToSteps(maxVelocity);
+
+    return stepGenerator.submit(axis, segment);
 }
 
 /**
  * @brief Set target velocity
  */
 bool StepperMotor::setVelocity(float velocity) {
-    if (!stepper) {
-        if (DEBUG_ENABLED) {
-            Serial.println("ERROR: StepperMotor::setVelocity() - Stepper object is null");
-        }
-        return false;
-    }
-    
-    if (!enabled) {
-        if (DEBUG_ENABLED) {
-            Serial.print("ERROR: StepperMotor::setVelocity() - Motor '");
-            Serial.print(name);
-            Serial.println("' is not enabled. Use 'enable' command first.");
-        }
+    // The controller's error reply tells the host why
+    if (axis == StepGenerator::NO_AXIS || !enabled) {
         return false;
     }
-    
+
     // Constrain velocity
     velocity = constrainValue(velocity, -maxVelocity, maxVelocity);
     targetVelocity = velocity;
-    
+
     if (velocity == 0.0) {
         // Stop command
         velocityMode = false;
-        stepper->stop();
+        stepGenerator.stop(axis);
     } else {
-        // Enter velocity mode
-        velocityMode = true;
-        stepper->setMaxSpeed(speedUnitsToSteps(abs(velocity)));
+        // Refuse to run into a triggered limit switch
+        if (stepGenerator.isLimited(axis, velocity > 0)) {
+            targetVelocity = 0.0;
+            return false;
+        }
         
-        // Set target far in the direction of motion
-        long target = (velocity > 0) ? LONG_MAX_STEPS : LONG_MIN_STEPS;
-        stepper->moveTo(target);
+        // Enter velocity mode: set target far in the direction of motion
+        velocityMode = true;
+
+        MoveSegment segment;
+        segment.target = stepGenerator.getPosition(axis) +
+                         ((velocity > 0) ? VELOCITY_MODE_DISTANCE : -VELOCITY_MODE_DISTANCE);
+        segment.maxRate = speedUnitsToSteps(velocity);
+        stepGenerator.submit(axis, segment);
     }
-    
+
+    return true;
+}
+
+/**
+ * @brief Add this axis to a coordinated linear move
+ */
+bool StepperMotor::prepareLinearMove(float position, LinearMove& move) {
+    if (axis == StepGenerator::NO_AXIS || !enabled) return false;
+
+    // Independent motion must finish before the axis can join the queue
+    if (motionPlanner.isEmpty() && stepGenerator.isRunning(axis)) return false;
+
+    velocityMode = false;
+    targetVelocity = 0.0;
+    targetPosition = position;
+
+    move.target[axis] = unitsToSteps(position);
+    move.stepsPerUnit[axis] = stepsPerUnit;
+    move.maxRate[axis] = speedUnitsToSteps(maxVelocity);
+    move.maxAccel[axis] = speedUnitsToSteps(acceleration);
+    move.axisMask |= (1 << axis);
     return true;
 }
 
@@ -203,16 +218,16 @@ bool StepperMotor::setVelocity(float velocity) {
  * @brief Get current position
  */
 float StepperMotor::getPosition() const {
-    if (!stepper) return 0.0;
-    return stepsToUnits(stepper->currentPosition());
+    if (axis == StepGenerator::NO_AXIS) return 0.0;
+    return stepsToUnits(stepGenerator.getPosition(axis));
 }
 
 /**
  * @brief Get current velocity
  */
 float StepperMotor::getVelocity() const {
-    if (!stepper) return 0.0;
-    return stepsToSpeedUnits(stepper->speed());
+    if (axis == StepGenerator::NO_AXIS) return 0.0;
+    return stepsToSpeedUnits(stepGenerator.getRate(axis));
 }
 
 /**
@@ -220,8 +235,13 @@ float StepperMotor::getVelocity() const {
  */
 void StepperMotor::setMaxVelocity(float velocity) {
     Actuator::setMaxVelocity(velocity);
-    if (stepper) {
-        stepper->setMaxSpeed(speedUnitsToSteps(maxVelocity));
+
+    // Apply to a move in progress
+    if (axis != StepGenerator::NO_AXIS && !velocityMode && stepGenerator.isRunning(axis)) {
+        MoveSegment segment;
+        segment.target = stepGenerator.getTarget(axis);
+        segment.maxRate = speedUnitsToSteps(maxVelocity);
+        stepGenerator.submit(axis, segment);
     }
 }
 
@@ -230,8 +250,28 @@ void StepperMotor::setMaxVelocity(float velocity) {
  */
 void StepperMotor::setAcceleration(float accel) {
     Actuator::setAcceleration(accel);
-    if (stepper) {
-        stepper->setAcceleration(speedUnitsToSteps(acceleration));
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setAcceleration(axis, speedUnitsToSteps(acceleration));
+    }
+}
+
+/**
+ * @brief Set jerk limit
+ */
+void StepperMotor::setJerk(float value) {
+    jerk = abs(value);
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setJerk(axis, speedUnitsToSteps(jerk));
+    }
+}
+
+/**
+ * @brief Invert motor direction
+ */
+void StepperMotor::setInvertDirection(bool invert) {
+    invertDirection = invert;
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setInvertDirection(axis, invert);
     }
 }
 
@@ -239,14 +279,15 @@ void StepperMotor::setAcceleration(float accel) {
  * @brief Check if motor is at target
  */
 bool StepperMotor::isAtTarget() const {
-    if (!stepper) return true;
-    
+    if (axis == StepGenerator::NO_AXIS) return true;
+
     if (velocityMode) {
         // In velocity mode, we're "at target" if we're at the target speed
-        return abs(currentVelocity - targetVelocity) < 0.1;
+        return abs(getVelocity() - targetVelocity) < 0.1;
     } else {
         // In position mode, check if we're at the target position
-        return stepper->distanceToGo() == 0;
+        return !stepGenerator.isRunning(axis) &&
+               stepGenerator.getPosition(axis) == stepGenerator.getTarget(axis);
     }
 }
 
@@ -254,7 +295,7 @@ bool StepperMotor::isAtTarget() const {
  * @brief Enable the motor driver
  */
 void StepperMotor::enable() {
-    digitalWrite(enablePin, STEPPER_ENABLE_ON);
+    enableOutput.write(STEPPER_ENABLE_ON);
     enabled = true;
     state = DeviceState::IDLE;
 }
@@ -264,7 +305,7 @@ void StepperMotor::enable() {
  */
 void StepperMotor::disable() {
     stop();
-    digitalWrite(enablePin, STEPPER_ENABLE_OFF);
+    enableOutput.write(STEPPER_ENABLE_OFF);
     enabled = false;
     state = DeviceState::DISABLED;
 }
@@ -273,30 +314,38 @@ void StepperMotor::disable() {
  * @brief Get current step position
  */
 long StepperMotor::getCurrentSteps() const {
-    if (!stepper) return 0;
-    return stepper->currentPosition();
+    if (axis == StepGenerator::NO_AXIS) return 0;
+    return stepGenerator.getPosition(axis);
 }
 
 /**
  * @brief Set current position as zero
  */
 void StepperMotor::setZeroPosition() {
-    if (stepper) {
-        stepper->setCurrentPosition(0);
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setPosition(axis, 0);
         currentPosition = 0.0;
     }
 }
 
+/**
+ * @brief Overwrite current step position
+ */
+void StepperMotor::setCurrentSteps(long steps) {
+    if (axis != StepGenerator::NO_AXIS) {
+        stepGenerator.setPosition(axis, steps);
+        currentPosition = steps / stepsPerUnit;
+    }
+}
+
 /**
  * @brief Emergency stop (immediate)
  */
 void StepperMotor::emergencyStop() {
-    if (stepper) {
+    if (axis != StepGenerator::NO_AXIS) {
         velocityMode = false;
         targetVelocity = 0.0;
-        stepper->setSpeed(0);
-        stepper->stop();
-        stepper->runToPosition();  // Forces immediate stop
+        stepGenerator.halt(axis);  // No deceleration ramp
     }
     state = DeviceState::IDLE;
 }
@@ -327,4 +376,4 @@ float StepperMotor::speedUnitsToSteps(float speed) const {
  */
 float StepperMotor::stepsToSpeedUnits(float stepsPerSec) const {
     return stepsPerSec / stepsPerUnit;
-}
\ No newline at end of file
+}
@@ -2,7 +2,7 @@
  * @file StepperMotor.h
  * @brief Stepper motor control class
  * 
- * Controls stepper motors using AccelStepper library
+ * Controls stepper motors through the interrupt driven StepGenerator
  * Supports position and velocity control with acceleration
  */
 
@@ -10,7 +10,8 @@
 #define STEPPER_MOTOR_H
 
 #include "../Actuator.h"
-#include <AccelStepper.h>
+#include "../../motion/StepGenerator.h"
+#include "../../motion/MotionPlanner.h"
 
 /**
  * @class StepperMotor
@@ -20,18 +21,19 @@
  */
 class StepperMotor : public Actuator {
 private:
-    AccelStepper* stepper;      // AccelStepper instance
+    uint8_t axis;               // StepGenerator axis index
     int stepPin;                // Step pin number
     int dirPin;                 // Direction pin number
     int enablePin;              // Enable pin number
+    FastPin enableOutput;       // Enable pin resolved to its port
     float stepsPerRev;          // Steps per revolution
     float stepsPerUnit;         // Steps per unit (for conversions)
     bool velocityMode;          // true = velocity mode, false = position mode
     bool invertDirection;       // Invert motor direction
+    float jerk;                 // Jerk limit (0 = trapezoid ramps)
     
-    // For continuous rotation
-    static constexpr long LONG_MAX_STEPS = 2147483647L;
-    static constexpr long LONG_MIN_STEPS = -2147483648L;
+    // For continuous rotation: target distance kept ahead of the motor
+    static constexpr long VELOCITY_MODE_DISTANCE = 1000000000L;
     
 public:
     /**
@@ -41,13 +43,11 @@ public:
      * @param dir Direction pin
      * @param enable Enable pin
      * @param stepsRev Steps per revolution
+     * @param maxRate Maximum speed in steps/sec (0 = DEFAULT_MAX_SPEED units/sec)
+     * @param accel Acceleration in steps/sec² (0 = DEFAULT_ACCELERATION units/sec²)
      */
-    StepperMotor(const String& name, int step, int dir, int enable, float stepsRev = 200.0);
-    
-    /**
-     * @brief Destructor
-     */
-    ~StepperMotor();
+    StepperMotor(const String& name, int step, int dir, int enable, float stepsRev = 200.0,
+                 float maxRate = 0.0, float accel = 0.0);
     
     /**
      * @brief Initialize the stepper motor
@@ -84,6 +84,14 @@ public:
      */
     bool setVelocity(float velocity) override;
     
+    /**
+     * @brief Add this axis to a coordinated linear move
+     * @param position Target position in radians or meters
+     * @param move Move to fill (target, axis mask and limits)
+     * @return true if the axis is enabled and not moving on its own
+     */
+    bool prepareLinearMove(float position, LinearMove& move);
+    
     /**
      * @brief Get current position
      * @return Position in radians or meters
@@ -108,6 +116,18 @@ public:
      */
     void setAcceleration(float accel) override;
     
+    /**
+     * @brief Set jerk limit (S-curve ramps), used from the next move
+     * @param value Jerk in rad/sec³ or m/sec³, 0 for trapezoid ramps
+     */
+    void setJerk(float value);
+    
+    /**
+     * @brief Get jerk limit
+     * @return Jerk in rad/sec³ or m/sec³
+     */
+    float getJerk() const { return jerk; }
+    
     /**
      * @brief Set steps per unit conversion
      * @param steps Steps per radian or meter
@@ -120,11 +140,17 @@ public:
      */
     float getStepsPerUnit() const { return stepsPerUnit; }
     
+    /**
+     * @brief Get step generator axis index
+     * @return Axis index or StepGenerator::NO_AXIS
+     */
+    uint8_t getAxis() const { return axis; }
+    
     /**
      * @brief Invert motor direction
      * @param invert true to invert
      */
-    void setInvertDirection(bool invert) { invertDirection = invert; }
+    void setInvertDirection(bool invert);
     
     /**
      * @brief Check if motor is at target
@@ -153,6 +179,12 @@ public:
      */
     void setZeroPosition();
     
+    /**
+     * @brief Overwrite current step position (axis must be stopped)
+     * @param steps New position in steps
+     */
+    void setCurrentSteps(long steps);
+    
     /**
      * @brief Emergency stop (immediate)
      */
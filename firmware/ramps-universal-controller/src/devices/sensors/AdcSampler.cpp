@@ -0,0 +1,180 @@
+/**
+ * @file AdcSampler.cpp
+ * @brief Implementation of AdcSampler class
+ */
+
+#include "AdcSampler.h"
+#include <util/atomic.h>
+
+// Global ADC sampler instance
+AdcSampler adcSampler;
+
+#if defined(__AVR__)
+/**
+ * @brief ADC conversion complete - store sample, select next channel
+ */
+ISR(ADC_vect) {
+    adcSampler.handleInterrupt();
+}
+#endif
+
+/**
+ * @brief Constructor
+ */
+AdcSampler::AdcSampler() {
+    numChannels = 0;
+    current = 0;
+    started = false;
+}
+
+/**
+ * @brief Add an analog input to the round robin
+ */
+uint8_t AdcSampler::attachChannel(uint8_t pin) {
+    uint8_t adcChannel = (pin >= A0) ? pin - A0 : pin;
+
+    // Sensors sharing an input share its ring
+    for (uint8_t i = 0; i < numChannels; i++) {
+        if (channels[i].adcChannel == adcChannel) return i;
+    }
+
+    if (numChannels >= MAX_CHANNELS) return NO_CHANNEL;
+
+    Channel& c = channels[numChannels];
+    c.adcChannel = adcChannel;
+    c.index = 0;
+    c.count = 0;
+    c.sum = 0;
+    c.latest = 0;
+    c.sequence = 0;
+
+    // Adding a channel while sampling would race the ISR's round robin
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        numChannels++;
+    }
+    return numChannels - 1;
+}
+
+/**
+ * @brief Configure the ADC and start sampling
+ */
+void AdcSampler::begin() {
+    if (started || numChannels == 0) return;
+
+    current = 0;
+
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        selectChannel(channels[0].adcChannel);
+        // Auto trigger on Timer0 overflow
+        ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2);
+        // Enable, auto trigger, interrupt, prescaler 128 (125 kHz at 16 MHz)
+        ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    }
+#endif
+
+    started = true;
+}
+
+/**
+ * @brief Convert the next channel without the interrupt
+ */
+void AdcSampler::poll() {
+#if !defined(__AVR__)
+    if (!started) return;
+
+    uint8_t adcChannel = channels[current].adcChannel;
+    store(analogRead(A0 + adcChannel));
+    current = (current + 1) % numChannels;
+#endif
+}
+
+/**
+ * @brief Average of the channel's sample ring
+ */
+float AdcSampler::getAverage(uint8_t channel) const {
+    if (channel >= numChannels) return 0.0;
+
+    uint16_t sum;
+    uint8_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        sum = channels[channel].sum;
+        count = channels[channel].count;
+    }
+    return (count > 0) ? (float)sum / count : 0.0;
+}
+
+/**
+ * @brief Last conversion of a channel
+ */
+uint16_t AdcSampler::getLatest(uint8_t channel) const {
+    if (channel >= numChannels) return 0;
+
+    uint16_t latest;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        latest = channels[channel].latest;
+    }
+    return latest;
+}
+
+/**
+ * @brief Conversion counter of a channel
+ */
+uint8_t AdcSampler::getSequence(uint8_t channel) const {
+    if (channel >= numChannels) return 0;
+    return channels[channel].sequence;     // Single byte, read atomically
+}
+
+/**
+ * @brief Store a conversion and select the next channel
+ */
+void AdcSampler::handleInterrupt() {
+#if defined(__AVR__)
+    store(ADC);
+
+    uint8_t next = current + 1;
+    if (next >= numChannels) next = 0;
+    current = next;
+
+    // Takes effect at the next trigger, a full Timer0 period away
+    selectChannel(channels[next].adcChannel);
+#endif
+}
+
+/**
+ * @brief Add a sample to the ring of the current channel
+ */
+void AdcSampler::store(uint16_t value) {
+    Channel& c = channels[current];
+
+    if (c.count == ANALOG_SAMPLES) {
+        c.sum -= c.ring[c.index];
+    } else {
+        c.count++;
+    }
+    c.ring[c.index] = value;
+    c.sum += value;
+    c.latest = value;
+    c.sequence++;
+
+    c.index++;
+    if (c.index >= ANALOG_SAMPLES) c.index = 0;
+}
+
+/**
+ * @brief Route the ADC multiplexer to a channel
+ */
+void AdcSampler::selectChannel(uint8_t adcChannel) {
+#if defined(__AVR__)
+    ADMUX = _BV(REFS0) | (adcChannel & 0x07);   // AVcc reference
+#if defined(MUX5)
+    if (adcChannel & 0x08) {
+        ADCSRB |= _BV(MUX5);
+    } else {
+        ADCSRB &= ~_BV(MUX5);
+    }
+#endif
+#else
+    (void)adcChannel;
+#endif
+}
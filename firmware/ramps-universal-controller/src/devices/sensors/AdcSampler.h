@@ -0,0 +1,124 @@
+/**
+ * @file AdcSampler.h
+ * @brief Interrupt driven round-robin sampling of the analog inputs
+ *
+ * The ADC converts continuously, started by the Timer0 overflow that
+ * already drives millis() (about 1 kHz). The conversion-complete
+ * interrupt stores the result in the channel's sample ring, keeps the
+ * ring's running sum and switches the multiplexer to the next channel,
+ * so sensors read an up to date average without waiting ~110 us for
+ * analogRead(). The multiplexer settles for a whole period before the
+ * next conversion.
+ *
+ * Other boards (and host builds) fall back to one analogRead() per
+ * poll() call.
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+static_assert(ANALOG_SAMPLES > 0 && (uint32_t)ANALOG_SAMPLES * ANALOG_MAX_VALUE <= 0xFFFF,
+              "ANALOG_SAMPLES ring sum must fit 16 bits");
+
+/**
+ * @class AdcSampler
+ * @brief Per-channel sample rings filled from the ADC interrupt
+ */
+class AdcSampler {
+public:
+    static constexpr uint8_t MAX_CHANNELS = NUM_ANALOG_SENSORS;
+    static constexpr uint8_t NO_CHANNEL = 0xFF;
+
+private:
+    /**
+     * @struct Channel
+     * @brief Sample ring of one analog input
+     */
+    struct Channel {
+        uint8_t adcChannel;             // ADC multiplexer channel (0-15)
+        uint16_t ring[ANALOG_SAMPLES];
+        uint8_t index;                  // Next ring slot
+        uint8_t count;                  // Valid samples in the ring
+        uint16_t sum;                   // Sum of the valid samples
+        uint16_t latest;                // Last conversion
+        uint8_t sequence;               // Incremented per conversion
+    };
+
+    Channel channels[MAX_CHANNELS];
+    uint8_t numChannels;
+    volatile uint8_t current;           // Channel being converted
+    bool started;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    AdcSampler();
+
+    /**
+     * @brief Add an analog input to the round robin
+     * @param pin Analog pin (A0-A15 or channel number 0-15)
+     * @return Channel handle, or NO_CHANNEL if the table is full
+     */
+    uint8_t attachChannel(uint8_t pin);
+
+    /**
+     * @brief Configure the ADC and start sampling (idempotent)
+     */
+    void begin();
+
+    /**
+     * @brief Convert the next channel without the interrupt (non-AVR builds)
+     */
+    void poll();
+
+    /**
+     * @brief Average of the channel's sample ring
+     * @param channel Channel handle
+     * @return Averaged raw ADC value (0 before the first conversion)
+     */
+    float getAverage(uint8_t channel) const;
+
+    /**
+     * @brief Last conversion of a channel
+     * @param channel Channel handle
+     * @return Raw ADC value
+     */
+    uint16_t getLatest(uint8_t channel) const;
+
+    /**
+     * @brief Conversion counter of a channel
+     *
+     * Changes whenever a new sample arrives, so callers can skip
+     * recomputing derived values when nothing is new.
+     * @param channel Channel handle
+     * @return Counter (wraps at 256)
+     */
+    uint8_t getSequence(uint8_t channel) const;
+
+    /**
+     * @brief Store a conversion and select the next channel (ADC ISR)
+     */
+    void handleInterrupt();
+
+private:
+    /**
+     * @brief Add a sample to the ring of the current channel
+     * @param value Raw ADC value
+     */
+    void store(uint16_t value);
+
+    /**
+     * @brief Route the ADC multiplexer to a channel
+     * @param adcChannel ADC channel (0-15)
+     */
+    void selectChannel(uint8_t adcChannel);
+};
+
+// Global ADC sampler instance
+extern AdcSampler adcSampler;
+
+#endif // ADC_SAMPLER_H
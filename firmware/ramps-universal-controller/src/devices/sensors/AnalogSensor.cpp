@@ -4,29 +4,27 @@
  */
 
 #include "AnalogSensor.h"
+#include "AdcSampler.h"
 #include <math.h>
 
+// Thermistor table: ADC value (x16) at THERMISTOR_TABLE_MAX - i * THERMISTOR_TABLE_STEP
+static const uint8_t THERMISTOR_RAW_SHIFT = 4;     // Fractional bits of table ADC values
+
+// Absolute zero offset and Beta reference temperature
+static const float KELVIN = 273.15;
+static const float T25_KELVIN = 273.15 + 25.0;
+
 /**
  * @brief Constructor
  */
 AnalogSensor::AnalogSensor(const String& name, int pin, int mode)
     : Sensor(name, DeviceType::ANALOG_SENSOR) {
     analogPin = pin;
+    adcChannel = adcSampler.attachChannel(pin);
+    lastSequence = 0;
     sensorMode = mode;
     vref = 5.0;  // Default 5V reference
     
-    // Smoothing setup
-    if (ANALOG_SMOOTHING) {
-        sampleBuffer = new float[ANALOG_SAMPLES];
-        for (int i = 0; i < ANALOG_SAMPLES; i++) {
-            sampleBuffer[i] = 0.0;
-        }
-    } else {
-        sampleBuffer = nullptr;
-    }
-    bufferIndex = 0;
-    sampleCount = 0;
-    
     // Conversion defaults
     scale = 1.0;
     offset = 0.0;
@@ -35,15 +33,7 @@ AnalogSensor::AnalogSensor(const String& name, int pin, int mode)
     pullupResistor = 10000.0;
     thermistorR25 = 10000.0;
     thermistorBeta = 3950.0;
-}
-
-/**
- * @brief Destructor
- */
-AnalogSensor::~AnalogSensor() {
-    if (sampleBuffer) {
-        delete[] sampleBuffer;
-    }
+    thermistorTable = nullptr;
 }
 
 /**
@@ -51,9 +41,13 @@ AnalogSensor::~AnalogSensor() {
  */
 bool AnalogSensor::init() {
     // Analog pins don't need pinMode configuration
+    if (adcChannel == AdcSampler::NO_CHANNEL) {
+        state = DeviceState::ERROR;
+        return false;
+    }
     
-    // Take initial reading
-    readValue();
+    // Start background sampling (shared by all analog sensors)
+    adcSampler.begin();
     
     // Initialize state
     state = DeviceState::IDLE;
@@ -68,8 +62,14 @@ bool AnalogSensor::init() {
 void AnalogSensor::update() {
     if (!enabled) return;
     
-    // Check if we should take a new reading
-    // (Could implement periodic reading here)
+    adcSampler.poll();
+    
+    // Convert only when the sampler has new data
+    uint8_t sequence = adcSampler.getSequence(adcChannel);
+    if (sequence != lastSequence) {
+        lastSequence = sequence;
+        readValue();
+    }
     
     updateTimestamp();
 }
@@ -115,7 +115,64 @@ float AnalogSensor::readValue() {
  * @brief Get raw ADC value
  */
 int AnalogSensor::getRawValue() {
-    return analogRead(analogPin);
+    return adcSampler.getLatest(adcChannel);
+}
+
+/**
+ * @brief Configure as thermistor
+ */
+void AnalogSensor::configureThermistor(float pullup, float r25, float beta, uint16_t* table) {
+    pullupResistor = pullup;
+    thermistorR25 = r25;
+    thermistorBeta = beta;
+    sensorMode = SENSOR_MODE_CUSTOM;
+    thermistorTable = table;
+    
+    // Invert the Beta equation at each table temperature, hottest first so
+    // the ADC values rise: R = R25 * exp(B * (1/T - 1/T25)), and with the
+    // thermistor below the pullup, raw = MAX / (1 + pullup / R)
+    for (uint8_t i = 0; i < THERMISTOR_TABLE_SIZE; i++) {
+        float t = THERMISTOR_TABLE_MAX - (float)i * THERMISTOR_TABLE_STEP + KELVIN;
+        float resistance = r25 * exp(beta * (1.0 / t - 1.0 / T25_KELVIN));
+        float raw = ANALOG_MAX_VALUE / (1.0 + pullup / resistance);
+        thermistorTable[i] = (uint16_t)(raw * (1 << THERMISTOR_RAW_SHIFT) + 0.5);
+    }
+}
+
+/**
+ * @brief Time and check the thermistor table against the Beta equation
+ */
+bool AnalogSensor::benchmarkThermistor(uint16_t iterations, uint32_t& tableMicros, uint32_t& exactMicros, float& maxError) {
+    if (!thermistorTable || iterations == 0) return false;
+    
+    // Spread the inputs over the table range
+    float low = (float)thermistorTable[0] / (1 << THERMISTOR_RAW_SHIFT);
+    float high = (float)thermistorTable[THERMISTOR_TABLE_SIZE - 1] / (1 << THERMISTOR_RAW_SHIFT);
+    float stride = (high - low) / iterations;
+    
+    volatile float sink = 0.0;  // Keep the conversions from being optimized out
+    
+    unsigned long start = micros();
+    for (uint16_t i = 0; i < iterations; i++) {
+        sink = rawToTemperature(low + i * stride);
+    }
+    tableMicros = micros() - start;
+    
+    start = micros();
+    for (uint16_t i = 0; i < iterations; i++) {
+        sink = rawToTemperatureExact(low + i * stride);
+    }
+    exactMicros = micros() - start;
+    (void)sink;
+    
+    // Accuracy over every ADC step in the table range (quarter-count resolution)
+    maxError = 0.0;
+    for (float raw = ceil(low); raw <= high; raw += 0.25) {
+        float error = fabs(rawToTemperature(raw) - rawToTemperatureExact(raw));
+        if (error > maxError) maxError = error;
+    }
+    
+    return true;
 }
 
 /**
@@ -141,47 +198,65 @@ String AnalogSensor::getStatus() const {
 }
 
 /**
- * @brief Read and smooth analog value
+ * @brief Get smoothed analog value from the sample ring
  */
 float AnalogSensor::readSmoothed() {
-    float raw = (float)analogRead(analogPin);
-    
-    if (ANALOG_SMOOTHING && sampleBuffer) {
-        // Add to circular buffer
-        sampleBuffer[bufferIndex] = raw;
-        bufferIndex = (bufferIndex + 1) % ANALOG_SAMPLES;
-        
-        if (sampleCount < ANALOG_SAMPLES) {
-            sampleCount++;
-        }
-        
-        // Calculate average
-        float sum = 0.0;
-        for (int i = 0; i < sampleCount; i++) {
-            sum += sampleBuffer[i];
+    if (ANALOG_SMOOTHING) {
+        return adcSampler.getAverage(adcChannel);
+    }
+    return (float)adcSampler.getLatest(adcChannel);
+}
+
+/**
+ * @brief Convert raw ADC to temperature (thermistor table)
+ */
+float AnalogSensor::rawToTemperature(float raw) const {
+    if (!thermistorTable) {
+        return rawToTemperatureExact(raw);
+    }
+    
+    uint16_t x = (uint16_t)(raw * (1 << THERMISTOR_RAW_SHIFT));
+    if (raw <= 0 || x < thermistorTable[0] || x > thermistorTable[THERMISTOR_TABLE_SIZE - 1]) {
+        return -999.0;  // Open or shorted sensor, or beyond the table
+    }
+    
+    // Binary search for the segment table[low] <= x < table[high]
+    uint8_t low = 0;
+    uint8_t high = THERMISTOR_TABLE_SIZE - 1;
+    while (high - low > 1) {
+        uint8_t mid = (low + high) / 2;
+        if (thermistorTable[mid] <= x) {
+            low = mid;
+        } else {
+            high = mid;
         }
-        raw = sum / sampleCount;
     }
     
-    return raw;
+    // Interpolate in 1/16°C steps; temperature falls as the reading rises
+    uint16_t span = thermistorTable[high] - thermistorTable[low];
+    int16_t t = (THERMISTOR_TABLE_MAX - (int16_t)low * THERMISTOR_TABLE_STEP) * 16;
+    if (span > 0) {
+        t -= (int16_t)(((uint32_t)(x - thermistorTable[low]) * (THERMISTOR_TABLE_STEP * 16)) / span);
+    }
+    
+    return t * (1.0 / 16.0);
 }
 
 /**
- * @brief Convert raw ADC to temperature
+ * @brief Convert raw ADC to temperature with the Beta equation
  */
-float AnalogSensor::rawToTemperature(float raw) const {
+float AnalogSensor::rawToTemperatureExact(float raw) const {
     if (raw <= 0 || raw >= ANALOG_MAX_VALUE) {
         return -999.0;  // Error value
     }
     
-    // Calculate resistance of thermistor
-    float resistance = pullupResistor * (ANALOG_MAX_VALUE / raw - 1.0);
+    // Thermistor resistance; it is the low side of the divider
+    float resistance = pullupResistor / (ANALOG_MAX_VALUE / raw - 1.0);
     
     // Use simplified Steinhart-Hart equation (Beta equation)
     // 1/T = 1/T0 + (1/B) * ln(R/R0)
-    const float T0 = 273.15 + 25.0;  // 25°C in Kelvin
-    float T = 1.0 / (1.0/T0 + (1.0/thermistorBeta) * log(resistance/thermistorR25));
+    float T = 1.0 / (1.0/T25_KELVIN + (1.0/thermistorBeta) * log(resistance/thermistorR25));
     
     // Convert to Celsius
-    return T - 273.15;
+    return T - KELVIN;
 }
\ No newline at end of file
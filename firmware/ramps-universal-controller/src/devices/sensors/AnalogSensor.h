@@ -2,7 +2,9 @@
  * @file AnalogSensor.h
  * @brief Analog sensor class for ADC inputs
  * 
- * Reads analog values with optional smoothing and conversion
+ * Reads analog values with optional smoothing and conversion. Samples
+ * come from the interrupt driven AdcSampler, so reading never waits
+ * for a conversion.
  */
 
 #ifndef ANALOG_SENSOR_H
@@ -15,19 +17,16 @@
  * @brief Analog sensor with smoothing and conversion options
  * 
  * Can read raw ADC values or convert to voltage/custom units
- * Supports moving average smoothing
+ * Supports moving average smoothing (over the sampler's ring)
  */
 class AnalogSensor : public Sensor {
 private:
     int analogPin;              // Analog input pin
+    uint8_t adcChannel;         // AdcSampler channel handle
+    uint8_t lastSequence;       // Sampler counter at the last conversion
     int sensorMode;             // Reading mode (raw/voltage/custom)
     float vref;                 // Reference voltage (5.0V default)
     
-    // Smoothing
-    float* sampleBuffer;        // Circular buffer for samples
-    int bufferIndex;            // Current buffer position
-    int sampleCount;            // Number of samples collected
-    
     // Conversion parameters
     float scale;                // Scale factor for custom conversion
     float offset;               // Offset for custom conversion
@@ -36,6 +35,7 @@ private:
     float pullupResistor;       // Pullup resistor value
     float thermistorR25;        // Thermistor resistance at 25°C
     float thermistorBeta;       // Thermistor beta value
+    uint16_t* thermistorTable;  // ADC value (x16) from the hottest table temperature down, rising (caller owned)
     
 public:
     /**
@@ -46,11 +46,6 @@ public:
      */
     AnalogSensor(const String& name, int pin, int mode = SENSOR_MODE_RAW);
     
-    /**
-     * @brief Destructor
-     */
-    ~AnalogSensor();
-    
     /**
      * @brief Initialize the sensor
      * @return true if successful
@@ -58,7 +53,7 @@ public:
     bool init() override;
     
     /**
-     * @brief Update sensor (read if needed)
+     * @brief Update sensor (convert new samples)
      */
     void update() override;
     
@@ -70,7 +65,7 @@ public:
     
     /**
      * @brief Get raw ADC value (0-1023)
-     * @return Raw ADC reading
+     * @return Latest raw ADC sample
      */
     int getRawValue();
     
@@ -104,16 +99,25 @@ public:
     
     /**
      * @brief Configure as thermistor
+     * 
+     * Builds the ADC-to-temperature table for these parameters, so reads
+     * interpolate instead of evaluating log().
      * @param pullup Pullup resistor value
      * @param r25 Resistance at 25°C
      * @param beta Beta coefficient
+     * @param table Storage for THERMISTOR_TABLE_SIZE entries, kept by the sensor
      */
-    void configureThermistor(float pullup, float r25, float beta) {
-        pullupResistor = pullup;
-        thermistorR25 = r25;
-        thermistorBeta = beta;
-        sensorMode = SENSOR_MODE_CUSTOM;
-    }
+    void configureThermistor(float pullup, float r25, float beta, uint16_t* table);
+    
+    /**
+     * @brief Time and check the thermistor table against the Beta equation
+     * @param iterations Conversions to time with each method
+     * @param tableMicros Time spent by table lookups
+     * @param exactMicros Time spent by the Beta equation
+     * @param maxError Largest table error over the table range (°C)
+     * @return false if the sensor is not a thermistor
+     */
+    bool benchmarkThermistor(uint16_t iterations, uint32_t& tableMicros, uint32_t& exactMicros, float& maxError);
     
     /**
      * @brief Get list of supported interfaces
@@ -131,7 +135,7 @@ public:
     
 private:
     /**
-     * @brief Read and smooth analog value
+     * @brief Get smoothed analog value from the sample ring
      * @return Smoothed raw ADC value
      */
     float readSmoothed();
@@ -146,11 +150,18 @@ private:
     }
     
     /**
-     * @brief Convert raw ADC to temperature (thermistor)
+     * @brief Convert raw ADC to temperature (thermistor table)
      * @param raw Raw ADC value
-     * @return Temperature in Celsius
+     * @return Temperature in Celsius, -999 outside the table
      */
     float rawToTemperature(float raw) const;
+    
+    /**
+     * @brief Convert raw ADC to temperature with the Beta equation
+     * @param raw Raw ADC value
+     * @return Temperature in Celsius, -999 if out of range
+     */
+    float rawToTemperatureExact(float raw) const;
 };
 
 #endif // ANALOG_SENSOR_H
\ No newline at end of file
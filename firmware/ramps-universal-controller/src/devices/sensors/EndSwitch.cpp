@@ -4,6 +4,63 @@
  */
 
 #include "EndSwitch.h"
+#include "../actuators/StepperMotor.h"
+#include "../../motion/StepGenerator.h"
+#include "../../utils/FastIO.h"
+#include <util/atomic.h>
+
+// Bounce window after an accepted edge
+static const unsigned long DEBOUNCE_MICROS = SWITCH_DEBOUNCE_MS * 1000UL;
+
+// Switches served by the interrupt handlers
+EndSwitch* EndSwitch::interruptSwitches[EndSwitch::MAX_INTERRUPT_SWITCHES];
+uint8_t EndSwitch::numInterruptSwitches = 0;
+
+#if FASTIO_DIRECT
+/**
+ * @brief Pin change interrupts - any switch may have changed
+ */
+ISR(PCINT0_vect) {
+    EndSwitch::handleInterrupt();
+}
+
+ISR(PCINT1_vect) {
+    EndSwitch::handleInterrupt();
+}
+
+ISR(PCINT2_vect) {
+    EndSwitch::handleInterrupt();
+}
+
+/**
+ * @brief Pin change group and bit of a Mega 2560 pin
+ * @param pin Arduino pin number
+ * @param group PCICR bit (0-2)
+ * @param bit PCMSK bit (0-7)
+ * @return false if the pin has no pin change interrupt
+ */
+static bool pinChangeBit(uint8_t pin, uint8_t& group, uint8_t& bit) {
+    char port = fastPinPort(pin);
+    uint8_t portBit = fastPinBit(pin);
+
+    if (port == 'B') {
+        group = 0;          // PCINT0-7
+        bit = portBit;
+    } else if (port == 'E' && portBit == 0) {
+        group = 1;          // PCINT8
+        bit = 0;
+    } else if (port == 'J' && portBit <= 6) {
+        group = 1;          // PCINT9-15
+        bit = portBit + 1;
+    } else if (port == 'K') {
+        group = 2;          // PCINT16-23
+        bit = portBit;
+    } else {
+        return false;
+    }
+    return true;
+}
+#endif
 
 /**
  * @brief Constructor
@@ -19,6 +76,19 @@ EndSwitch::EndSwitch(const String& name, int pin, bool invert, bool pullup)
     stateChanged = false;
     changeCallback = nullptr;
     
+    isrState = false;
+    edgeMicros = 0;
+    latchedSteps = 0;
+    latched = false;
+    boundMotor = nullptr;
+    boundAxis = StepGenerator::NO_AXIS;
+    limitDirection = 0;
+    interruptDriven = false;
+#if defined(__AVR__)
+    inputRegister = nullptr;
+    inputMask = 0;
+#endif
+    
     // Set threshold for digital sensor (0.5)
     threshold = 0.5;
 }
@@ -39,6 +109,14 @@ bool EndSwitch::init() {
     lastState = currentState;
     updateValue(currentState ? 1.0 : 0.0);
     
+    // Apply a limit already triggered at start-up
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        acceptEdge(currentState, micros() - DEBOUNCE_MICROS);
+    }
+    
+    // Take edges by interrupt where the pin allows it
+    interruptDriven = attachPinInterrupt();
+    
     // Initialize state
     state = DeviceState::IDLE;
     enabled = true;
@@ -52,20 +130,42 @@ bool EndSwitch::init() {
 void EndSwitch::update() {
     if (!enabled) return;
     
-    // Read current raw state
-    bool rawState = readRawState();
-    
-    // Check if state changed
-    if (rawState != currentState) {
-        // Reset debounce timer
-        lastDebounce = millis();
-        currentState = rawState;
+    bool stable;
+    if (interruptDriven) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            // An edge ignored as bounce may have left the level changed
+            unsigned long now = micros();
+            if (readRawState() != isrState && now - edgeMicros >= DEBOUNCE_MICROS) {
+                acceptEdge(!isrState, now);
+            }
+            currentState = isrState;
+        }
+        stable = true;
+    } else {
+        // Read current raw state
+        bool rawState = readRawState();
+        
+        // Check if state changed
+        if (rawState != currentState) {
+            // Reset debounce timer
+            lastDebounce = millis();
+            currentState = rawState;
+        }
+        
+        // Check if debounce period has passed
+        stable = (millis() - lastDebounce) > SWITCH_DEBOUNCE_MS;
     }
     
-    // Check if debounce period has passed
-    if ((millis() - lastDebounce) > SWITCH_DEBOUNCE_MS) {
+    if (stable) {
         // State has been stable for debounce period
         if (currentState != lastState) {
+            // Polled switches latch and limit late, when the change is seen here
+            if (!interruptDriven) {
+                ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                    acceptEdge(currentState, micros());
+                }
+            }
+            
             // State changed
             lastState = currentState;
             updateValue(currentState ? 1.0 : 0.0);
@@ -111,11 +211,152 @@ String EndSwitch::getStatus() const {
     return status;
 }
 
+/**
+ * @brief Bind the switch to an axis
+ */
+void EndSwitch::bindAxis(const StepperMotor* motor, int8_t direction) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Release a limit held on the previous axis
+        if (boundAxis != StepGenerator::NO_AXIS && limitDirection != 0) {
+            stepGenerator.setLimit(boundAxis, limitDirection > 0, false);
+        }
+        
+        boundMotor = motor;
+        boundAxis = motor ? motor->getAxis() : StepGenerator::NO_AXIS;
+        limitDirection = motor ? direction : 0;
+        latched = false;
+        
+        if (boundAxis != StepGenerator::NO_AXIS && limitDirection != 0) {
+            stepGenerator.setLimit(boundAxis, limitDirection > 0, isrState);
+        }
+    }
+}
+
+/**
+ * @brief Get step count latched at the last trigger edge
+ */
+bool EndSwitch::getLatchedSteps(long& steps) const {
+    bool valid;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        steps = latchedSteps;
+        valid = latched;
+    }
+    return valid;
+}
+
+/**
+ * @brief Forget the latched step count
+ */
+void EndSwitch::clearLatch() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        latched = false;
+    }
+}
+
+/**
+ * @brief Get time of the last accepted edge
+ */
+unsigned long EndSwitch::getEdgeMicros() const {
+    unsigned long edge;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        edge = edgeMicros;
+    }
+    return edge;
+}
+
+/**
+ * @brief Handle a pin edge (called from the ISR)
+ */
+void EndSwitch::handleEdge() {
+    bool triggered = readRawState();
+    if (triggered == isrState) return;     // Another switch, or bounced back
+    
+    unsigned long now = micros();
+    if (now - edgeMicros < DEBOUNCE_MICROS) return;     // Contact bounce
+    
+    acceptEdge(triggered, now);
+}
+
+/**
+ * @brief Dispatch a switch interrupt
+ */
+void EndSwitch::handleInterrupt() {
+    for (uint8_t i = 0; i < numInterruptSwitches; i++) {
+        interruptSwitches[i]->handleEdge();
+    }
+}
+
+/**
+ * @brief Accept a new debounced state
+ */
+void EndSwitch::acceptEdge(bool triggered, unsigned long now) {
+    isrState = triggered;
+    edgeMicros = now;
+    
+    if (boundAxis == StepGenerator::NO_AXIS) return;
+    
+    // Block (and halt) travel into the switch
+    if (limitDirection != 0) {
+        stepGenerator.setLimit(boundAxis, limitDirection > 0, triggered);
+    }
+    if (triggered) {
+        latchedSteps = stepGenerator.getPosition(boundAxis);
+        latched = true;
+    }
+}
+
+/**
+ * @brief Enable the external or pin-change interrupt of the pin
+ */
+bool EndSwitch::attachPinInterrupt() {
+#if defined(__AVR__)
+    if (numInterruptSwitches >= MAX_INTERRUPT_SWITCHES) return false;
+    
+    int external = digitalPinToInterrupt(switchPin);
+#if FASTIO_DIRECT
+    uint8_t group = 0;
+    uint8_t bit = 0;
+    bool pinChange = pinChangeBit(switchPin, group, bit);
+#else
+    bool pinChange = false;
+#endif
+    if (external == NOT_AN_INTERRUPT && !pinChange) return false;
+    
+    inputRegister = portInputRegister(digitalPinToPort(switchPin));
+    inputMask = digitalPinToBitMask(switchPin);
+    
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        interruptSwitches[numInterruptSwitches++] = this;
+    }
+    
+    if (external != NOT_AN_INTERRUPT) {
+        attachInterrupt(external, handleInterrupt, CHANGE);
+    }
+#if FASTIO_DIRECT
+    else {
+        volatile uint8_t* masks[] = { &PCMSK0, &PCMSK1, &PCMSK2 };
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            *masks[group] |= _BV(bit);
+            PCICR |= _BV(group);
+        }
+    }
+#endif
+    return true;
+#else
+    return false;
+#endif
+}
+
 /**
  * @brief Read raw switch state
  */
 bool EndSwitch::readRawState() {
+#if defined(__AVR__)
+    // Register read once resolved: also called from the ISR
+    bool raw = inputRegister ? (*inputRegister & inputMask) != 0 : digitalRead(switchPin);
+#else
     bool raw = digitalRead(switchPin);
+#endif
     
     // Apply inversion if needed
     if (inverted) {
@@ -2,7 +2,18 @@
  * @file EndSwitch.h
  * @brief End switch/limit switch sensor class
  * 
- * Monitors digital switches with debouncing and event reporting
+ * Monitors digital switches with debouncing and event reporting.
+ * 
+ * On AVR the switch pin raises an external or pin-change interrupt.
+ * The first edge after a quiet period is accepted at once, stamped with
+ * micros() and, on a trigger, latches the step count of the bound
+ * stepper; further edges within SWITCH_DEBOUNCE_MS are contact bounce
+ * and ignored. update() only publishes the result and catches a level
+ * left different by the last ignored edge. Pins without an interrupt
+ * (and host builds) are polled from update() as before.
+ * 
+ * A switch bound as a limit blocks its axis in one direction while
+ * triggered: the same interrupt halts the axis if it travels that way.
  */
 
 #ifndef END_SWITCH_H
@@ -10,6 +21,9 @@
 
 #include "../Sensor.h"
 
+// Forward declaration
+class StepperMotor;
+
 /**
  * @class EndSwitch
  * @brief Digital switch sensor with debouncing
@@ -26,6 +40,26 @@ private:
     unsigned long lastDebounce; // Last debounce time
     bool stateChanged;          // Flag for state change detection
     
+    // Interrupt side (shared with the ISR)
+    volatile bool isrState;             // Debounced state seen by the ISR
+    volatile bool isrChanged;           // isrState changed since update()
+    volatile unsigned long edgeMicros;  // Time of the last accepted edge
+    volatile long latchedSteps;         // Step count at the last trigger
+    volatile bool latched;              // latchedSteps is valid
+    const StepperMotor* boundMotor;     // Axis this switch belongs to
+    uint8_t boundAxis;                  // Its StepGenerator axis
+    int8_t limitDirection;              // Blocked travel: -1, +1, 0 = none
+    bool interruptDriven;               // Pin raises an interrupt
+    
+#if defined(__AVR__)
+    volatile uint8_t* inputRegister;    // PIN register of the switch
+    uint8_t inputMask;
+#endif
+    
+    static const uint8_t MAX_INTERRUPT_SWITCHES = NUM_ENDSWITCHES;
+    static EndSwitch* interruptSwitches[MAX_INTERRUPT_SWITCHES];
+    static uint8_t numInterruptSwitches;
+    
     // For event callback (future implementation)
     void (*changeCallback)(const String& deviceName, bool state);
     
@@ -82,6 +116,62 @@ public:
         return lastState;
     }
     
+    /**
+     * @brief Bind the switch to an axis
+     * 
+     * The axis step count is latched on every trigger edge.
+     * @param motor Stepper, or nullptr to unbind
+     * @param direction Travel the switch blocks while triggered
+     *                  (-1 min end, +1 max end, 0 latch only)
+     */
+    void bindAxis(const StepperMotor* motor, int8_t direction);
+    
+    /**
+     * @brief Get the bound stepper
+     * @return Stepper or nullptr
+     */
+    const StepperMotor* getBoundMotor() const { return boundMotor; }
+    
+    /**
+     * @brief Get the blocked direction
+     * @return -1 (min end), +1 (max end) or 0 (no limit)
+     */
+    int8_t getLimitDirection() const { return limitDirection; }
+    
+    /**
+     * @brief Get step count latched at the last trigger edge
+     * @param steps Latched step count
+     * @return false if nothing was latched since clearLatch()
+     */
+    bool getLatchedSteps(long& steps) const;
+    
+    /**
+     * @brief Forget the latched step count
+     */
+    void clearLatch();
+    
+    /**
+     * @brief Get time of the last accepted edge
+     * @return micros() at the edge
+     */
+    unsigned long getEdgeMicros() const;
+    
+    /**
+     * @brief Check if the switch is read by interrupt
+     * @return false if polled
+     */
+    bool isInterruptDriven() const { return interruptDriven; }
+    
+    /**
+     * @brief Handle a pin edge (called from the ISR)
+     */
+    void handleEdge();
+    
+    /**
+     * @brief Dispatch a switch interrupt to all interrupt driven switches
+     */
+    static void handleInterrupt();
+    
     /**
      * @brief Set change callback (for future use)
      * @param callback Function to call on state change
@@ -110,6 +200,19 @@ private:
      * @return Raw state (considering inversion)
      */
     bool readRawState();
+    
+    /**
+     * @brief Accept a new debounced state (interrupts disabled)
+     * @param triggered New state
+     * @param now micros() at the edge
+     */
+    void acceptEdge(bool triggered, unsigned long now);
+    
+    /**
+     * @brief Enable the external or pin-change interrupt of the pin
+     * @return false if the pin has no interrupt
+     */
+    bool attachPinInterrupt();
 };
 
 #endif // END_SWITCH_H
\ No newline at end of file
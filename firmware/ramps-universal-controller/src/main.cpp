@@ -2,17 +2,34 @@
  * @file main.cpp
  * @brief Main entry point for RAMPS Universal Controller
  * 
- * Initializes the system and runs the main control loop
+ * Initializes the system and runs the scheduler from the main loop
  */
 
 #include <Arduino.h>
 #include "Config.h"
 #include "core/Controller.h"
 #include "core/Interface.h"
+#include "core/Scheduler.h"
+#include "core/Profiler.h"
 
-// Global interface instance
+// Global interface instance (static: its buffers are never allocated)
+static Interface serialInterface(&controller);
 Interface* interface = nullptr;
 
+/**
+ * @brief Scheduler task: process serial input and output
+ */
+static void interfaceTask(void* context) {
+    static_cast<Interface*>(context)->update();
+}
+
+/**
+ * @brief Scheduler task: blink the LED without blocking
+ */
+static void heartbeatTask(void*) {
+    digitalWrite(LED_PIN, (millis() % HEARTBEAT_PERIOD) < HEARTBEAT_ON_TIME ? HIGH : LOW);
+}
+
 /**
  * @brief Arduino setup function
  */
@@ -21,8 +38,7 @@ void setup() {
     pinMode(LED_PIN, OUTPUT);
     digitalWrite(LED_PIN, HIGH);  // LED on during init
     
-    // Create interface
-    interface = new Interface(&controller);
+    interface = &serialInterface;
     
     // Initialize interface (serial communication)
     if (!interface->init(SERIAL_BAUD_RATE)) {
@@ -39,6 +55,7 @@ void setup() {
     // Initialize controller
     if (!controller.init()) {
         interface->sendMessage("ERROR: Controller initialization failed!");
+        interface->flush();     // The loop below never returns to send it
         // Fatal error - blink LED slowly
         while (true) {
             digitalWrite(LED_PIN, !digitalRead(LED_PIN));
@@ -49,6 +66,10 @@ void setup() {
     // Set interface in controller
     controller.setInterface(interface);
     
+    // Serial first so commands are handled before the devices update
+    scheduler.add("interface", interfaceTask, interface, 0, TaskPriority::IO);
+    scheduler.add("heartbeat", heartbeatTask, nullptr, HEARTBEAT_ON_TIME, TaskPriority::BACKGROUND);
+    
     // Initialization complete
     interface->sendMessage("Initialization complete!");
     interface->sendMessage("");  // Blank line
@@ -61,25 +82,10 @@ void setup() {
  * @brief Arduino main loop
  */
 void loop() {
-    // Update interface (process commands)
-    interface->update();
-    
-    // Update controller (update all devices)
-    controller.update();
+    PERF_PASS();
     
-    // Small delay to prevent CPU hogging
-    if (MAIN_LOOP_DELAY > 0) {
-        delay(MAIN_LOOP_DELAY);
-    }
-    
-    // Heartbeat LED (optional)
-    static unsigned long lastBlink = 0;
-    if (millis() - lastBlink > 2000) {
-        digitalWrite(LED_PIN, HIGH);
-        delay(50);
-        digitalWrite(LED_PIN, LOW);
-        lastBlink = millis();
-    }
+    // Run the tasks that are due; nothing here blocks
+    scheduler.run();
 }
 
 /**
@@ -0,0 +1,139 @@
+/**
+ * @file Homing.cpp
+ * @brief Implementation of AxisHoming class
+ */
+
+#include "Homing.h"
+#include "../devices/actuators/StepperMotor.h"
+#include "../devices/sensors/EndSwitch.h"
+
+/**
+ * @brief Constructor
+ */
+AxisHoming::AxisHoming() {
+    stepper = nullptr;
+    homeSwitch = nullptr;
+    state = HomingState::IDLE;
+    phaseStart = 0;
+    moveIssued = false;
+    latchedSteps = 0;
+}
+
+/**
+ * @brief Start homing
+ */
+bool AxisHoming::begin(StepperMotor* motor, EndSwitch* sw) {
+    if (!motor || !sw || isActive()) return false;
+
+    stepper = motor;
+    homeSwitch = sw;
+    latchedSteps = 0;
+
+    stepper->enable();
+
+    if (homeSwitch->isPressed()) {
+        // Already on the switch - back off first
+        enterState(HomingState::BACK_OFF);
+    } else {
+        stepper->setVelocity(-CALIBRATION_SPEED / stepper->getStepsPerUnit());
+        enterState(HomingState::FAST_APPROACH);
+    }
+    return true;
+}
+
+/**
+ * @brief Advance the sequence
+ */
+bool AxisHoming::update() {
+    HomingState previous = state;
+
+    switch (state) {
+        case HomingState::FAST_APPROACH:
+            if (homeSwitch->isPressed()) {
+                stepper->stop();    // Decelerate; back-off starts once stopped
+                enterState(HomingState::BACK_OFF);
+            } else if (timedOut()) {
+                abort();
+            }
+            break;
+
+        case HomingState::BACK_OFF:
+            if (!moveIssued) {
+                if (stepper->isAtTarget()) {
+                    long backOff = stepper->getCurrentSteps() + CALIBRATION_BACKOFF_STEPS;
+                    stepper->setPosition(backOff / stepper->getStepsPerUnit());
+                    moveIssued = true;
+                }
+            } else if (stepper->isAtTarget()) {
+                if (homeSwitch->isPressed()) {
+                    abort();    // Switch did not release
+                } else {
+                    homeSwitch->clearLatch();
+                    stepper->setVelocity(-CALIBRATION_SLOW_SPEED / stepper->getStepsPerUnit());
+                    enterState(HomingState::SLOW_APPROACH);
+                }
+            } else if (timedOut()) {
+                abort();
+            }
+            break;
+
+        case HomingState::SLOW_APPROACH:
+            if (homeSwitch->isPressed()) {
+                stepper->emergencyStop();   // Slow enough to stop without a ramp
+                // Position at the trigger edge, not where the loop noticed it
+                if (!homeSwitch->getLatchedSteps(latchedSteps)) {
+                    latchedSteps = stepper->getCurrentSteps();
+                }
+                enterState(HomingState::LATCH);
+            } else if (timedOut()) {
+                abort();
+            }
+            break;
+
+        case HomingState::LATCH:
+            // Zero at the trigger point; steps run past it are kept
+            stepper->setCurrentSteps(stepper->getCurrentSteps() - latchedSteps);
+            enterState(HomingState::DONE);
+            break;
+
+        default:
+            break;
+    }
+
+    return state != previous;
+}
+
+/**
+ * @brief Stop the axis and fail the sequence
+ */
+void AxisHoming::abort() {
+    if (!isActive()) return;
+
+    stepper->emergencyStop();
+    enterState(HomingState::FAILED);
+}
+
+/**
+ * @brief Enter a new phase
+ */
+void AxisHoming::enterState(HomingState next) {
+    state = next;
+    phaseStart = millis();
+    moveIssued = false;
+}
+
+/**
+ * @brief Get name of a state
+ */
+const char* AxisHoming::getStateName(HomingState s) {
+    switch (s) {
+        case HomingState::IDLE:          return "IDLE";
+        case HomingState::FAST_APPROACH: return "FAST_APPROACH";
+        case HomingState::BACK_OFF:      return "BACK_OFF";
+        case HomingState::SLOW_APPROACH: return "SLOW_APPROACH";
+        case HomingState::LATCH:         return "LATCH";
+        case HomingState::DONE:          return "DONE";
+        case HomingState::FAILED:        return "FAILED";
+        default:                         return "UNKNOWN";
+    }
+}
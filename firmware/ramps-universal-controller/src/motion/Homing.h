@@ -0,0 +1,121 @@
+/**
+ * @file Homing.h
+ * @brief Non-blocking homing sequence for one stepper axis
+ *
+ * Homing runs as a state machine advanced from Controller::update():
+ * fast approach to the home switch, back-off until it releases, slow
+ * re-approach, latch on the switch edge and zero the axis. Every call
+ * returns immediately, so serial commands (including ESTOP) and the
+ * other axes keep running while an axis homes.
+ */
+
+#ifndef HOMING_H
+#define HOMING_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Forward declarations
+class StepperMotor;
+class EndSwitch;
+
+/**
+ * @enum HomingState
+ * @brief Phase of a homing sequence
+ */
+enum class HomingState {
+    IDLE,           // Not homing
+    FAST_APPROACH,  // Moving towards the switch at CALIBRATION_SPEED
+    BACK_OFF,       // Stopping, then backing off until the switch releases
+    SLOW_APPROACH,  // Moving towards the switch at CALIBRATION_SLOW_SPEED
+    LATCH,          // Switch hit on the slow approach, axis halted
+    DONE,           // Axis zeroed at the switch
+    FAILED          // Timeout, stuck switch or aborted
+};
+
+/**
+ * @class AxisHoming
+ * @brief Homing state machine for one stepper and its home switch
+ */
+class AxisHoming {
+private:
+    StepperMotor* stepper;          // Axis being homed
+    EndSwitch* homeSwitch;          // Switch at the home position
+    HomingState state;
+    unsigned long phaseStart;       // millis() when the phase began
+    bool moveIssued;                // Back-off move has been commanded
+    long latchedSteps;              // Position where the slow approach hit the switch
+
+public:
+    /**
+     * @brief Constructor
+     */
+    AxisHoming();
+
+    /**
+     * @brief Start homing
+     * @param motor Stepper to home (towards negative positions)
+     * @param sw Home switch
+     * @return true if started
+     */
+    bool begin(StepperMotor* motor, EndSwitch* sw);
+
+    /**
+     * @brief Advance the sequence (call from the main loop)
+     * @return true if the state changed
+     */
+    bool update();
+
+    /**
+     * @brief Stop the axis and end the sequence as failed
+     */
+    void abort();
+
+    /**
+     * @brief Get current phase
+     * @return Homing state
+     */
+    HomingState getState() const { return state; }
+
+    /**
+     * @brief Check if a sequence is in progress
+     * @return true while approaching, backing off or latching
+     */
+    bool isActive() const {
+        return state != HomingState::IDLE && state != HomingState::DONE && state != HomingState::FAILED;
+    }
+
+    /**
+     * @brief Get the stepper being homed
+     * @return Stepper or nullptr
+     */
+    StepperMotor* getStepper() const { return stepper; }
+
+    /**
+     * @brief Get the position (before zeroing) where the switch latched
+     * @return Position in steps
+     */
+    long getLatchedSteps() const { return latchedSteps; }
+
+    /**
+     * @brief Get name of a state for events
+     * @param s State
+     * @return State name
+     */
+    static const char* getStateName(HomingState s);
+
+private:
+    /**
+     * @brief Enter a new phase
+     * @param next New state
+     */
+    void enterState(HomingState next);
+
+    /**
+     * @brief Check the phase timeout
+     * @return true if CALIBRATION_TIMEOUT_MS has passed in this phase
+     */
+    bool timedOut() const { return (millis() - phaseStart) > CALIBRATION_TIMEOUT_MS; }
+};
+
+#endif // HOMING_H
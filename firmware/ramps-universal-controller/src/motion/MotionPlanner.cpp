@@ -0,0 +1,270 @@
+/**
+ * @file MotionPlanner.cpp
+ * @brief Implementation of MotionPlanner class
+ */
+
+#include "MotionPlanner.h"
+#include "StepGenerator.h"
+#include <util/atomic.h>
+
+// Global motion planner instance
+MotionPlanner motionPlanner;
+
+/**
+ * @brief Constructor
+ */
+MotionPlanner::MotionPlanner() {
+    head = 0;
+    tail = 0;
+    executing = false;
+    resync = false;
+    previousNominalSqr = 0.0;
+
+    for (uint8_t i = 0; i < MAX_AXES; i++) {
+        position[i] = 0;
+        previousUnit[i] = 0.0;
+    }
+}
+
+/**
+ * @brief Queue a linear move
+ */
+bool MotionPlanner::bufferLine(const LinearMove& move) {
+    uint8_t mask = move.axisMask & ((1 << MAX_AXES) - 1);
+    if (mask == 0 || getFreeSlots() == 0) return false;
+
+    if (isEmpty()) {
+        // Nothing queued or running - start from where the axes are
+        for (uint8_t i = 0; i < MAX_AXES; i++) {
+            position[i] = stepGenerator.getPosition(i);
+        }
+        previousNominalSqr = 0.0;
+        resync = false;
+    } else if (resync) {
+        // A stopped move is still decelerating; its end point is unknown
+        return false;
+    }
+
+    PlannerBlock& b = blocks[head];
+    b.axisMask = mask;
+    b.directionBits = 0;
+    b.eventCount = 0;
+
+    float unit[MAX_AXES];
+    float lengthSqr = 0.0;
+    for (uint8_t i = 0; i < MAX_AXES; i++) {
+        b.delta[i] = 0;
+        unit[i] = 0.0;
+        if (!(mask & (1 << i))) continue;
+
+        long delta = move.target[i] - position[i];
+        unit[i] = delta / move.stepsPerUnit[i];
+        lengthSqr += unit[i] * unit[i];
+
+        if (delta < 0) {
+            b.directionBits |= (1 << i);
+            delta = -delta;
+        }
+        b.delta[i] = delta;
+        if (delta > b.eventCount) b.eventCount = delta;
+    }
+
+    if (b.eventCount == 0) return true;    // Already there
+
+    // Path speed and acceleration: the tightest axis limit wins
+    float length = sqrt(lengthSqr);
+    float speed = (move.feed > 0.0) ? move.feed : 0.0;
+    float accel = 0.0;
+    for (uint8_t i = 0; i < MAX_AXES; i++) {
+        unit[i] /= length;
+        if (b.delta[i] == 0) continue;
+
+        float axisSteps = abs(unit[i]) * move.stepsPerUnit[i];  // Steps per path unit
+        float maxSpeed = move.maxRate[i] / axisSteps;
+        float maxAccel = move.maxAccel[i] / axisSteps;
+        if (speed == 0.0 || maxSpeed < speed) speed = maxSpeed;
+        if (accel == 0.0 || maxAccel < accel) accel = maxAccel;
+    }
+    if (accel <= 0.0) accel = STEP_MIN_ACCELERATION;
+
+    b.length = length;
+    b.acceleration = accel;
+    b.stepsPerUnit = b.eventCount / length;
+    b.nominalSqr = speed * speed;
+    b.nominalInterval = StepGenerator::rateToInterval(speed * b.stepsPerUnit);
+    b.rampScale = StepGenerator::accelerationToScale(accel * b.stepsPerUnit);
+
+    // Junction deviation: the corner speed a circle of the given
+    // deviation through the junction allows at this acceleration
+    float maxEntrySqr = 0.0;
+    if (!isEmpty()) {
+        float cosTheta = 0.0;
+        for (uint8_t i = 0; i < MAX_AXES; i++) {
+            cosTheta -= previousUnit[i] * unit[i];
+        }
+
+        maxEntrySqr = (b.nominalSqr < previousNominalSqr) ? b.nominalSqr : previousNominalSqr;
+        if (cosTheta > 0.999999) {
+            maxEntrySqr = 0.0;  // Full reversal
+        } else if (cosTheta > -0.999999) {
+            float sinHalf = sqrt(0.5 * (1.0 - cosTheta));
+            float junctionSqr = accel * MOTION_JUNCTION_DEVIATION * sinHalf / (1.0 - sinHalf);
+            if (junctionSqr < maxEntrySqr) maxEntrySqr = junctionSqr;
+        }
+    }
+
+    b.maxEntrySqr = maxEntrySqr;
+    b.entrySqr = 0.0;
+    b.exitSqr = 0.0;
+    b.entrySteps = 0;
+    b.exitSteps = 0;
+
+    for (uint8_t i = 0; i < MAX_AXES; i++) {
+        if (mask & (1 << i)) position[i] = move.target[i];
+        previousUnit[i] = unit[i];
+    }
+    previousNominalSqr = b.nominalSqr;
+
+    // Publish to the step interrupt
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        head = nextIndex(head);
+    }
+
+    recalculate();
+    return true;
+}
+
+/**
+ * @brief Get number of queued blocks
+ */
+uint8_t MotionPlanner::getDepth() const {
+    uint8_t h = head;
+    uint8_t t = tail;
+    return (h + MOTION_QUEUE_SIZE - t) % MOTION_QUEUE_SIZE;
+}
+
+/**
+ * @brief Drop all blocks that have not started
+ */
+void MotionPlanner::flush() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        head = executing ? nextIndex(tail) : tail;
+        resync = executing;
+    }
+}
+
+/**
+ * @brief Drop all blocks including the running one
+ */
+void MotionPlanner::clear() {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        head = tail;
+        executing = false;
+        resync = false;
+    }
+}
+
+/**
+ * @brief Release the finished tail block
+ */
+void MotionPlanner::discardCurrentBlock() {
+    executing = false;
+    if (head != tail) {
+        tail = nextIndex(tail);
+    }
+}
+
+/**
+ * @brief Recompute entry and exit speeds
+ *
+ * Backward pass: starting at rest after the newest block, every entry is
+ * limited by its junction and by what deceleration over the block can
+ * still reach. Forward pass: every exit is limited by what acceleration
+ * from the committed entry can reach.
+ */
+void MotionPlanner::recalculate() {
+    uint8_t first;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        first = executing ? nextIndex(tail) : tail;
+    }
+    if (first == head) return;
+
+    // Backward pass (the entry of the first pending block is fixed)
+    float nextEntrySqr = 0.0;
+    for (uint8_t i = prevIndex(head); i != first; i = prevIndex(i)) {
+        PlannerBlock& b = blocks[i];
+        float reachable = nextEntrySqr + 2.0 * b.acceleration * b.length;
+        b.entrySqr = (b.maxEntrySqr < reachable) ? b.maxEntrySqr : reachable;
+        nextEntrySqr = b.entrySqr;
+    }
+
+    // Forward pass
+    float entrySqr = blocks[first].entrySqr;
+    for (uint8_t i = first; i != head; i = nextIndex(i)) {
+        PlannerBlock& b = blocks[i];
+        uint8_t next = nextIndex(i);
+
+        float exitSqr = 0.0;
+        if (next != head) {
+            float reachable = entrySqr + 2.0 * b.acceleration * b.length;
+            exitSqr = (blocks[next].entrySqr < reachable) ? blocks[next].entrySqr : reachable;
+        }
+
+        if (!commitJunction(i, exitSqr)) {
+            // The step interrupt took this block first; its exit is final
+            exitSqr = b.exitSqr;
+        }
+
+        if (next != head) {
+            blocks[next].entrySqr = exitSqr;
+        }
+        entrySqr = exitSqr;
+    }
+}
+
+/**
+ * @brief Commit an exit speed and the matching next entry
+ */
+bool MotionPlanner::commitJunction(uint8_t index, float exitSqr) {
+    PlannerBlock& b = blocks[index];
+    uint8_t next = nextIndex(index);
+    bool hasNext = (next != head);
+
+    // Float math outside the critical section
+    long exitSteps = stepsFromRest(b, exitSqr);
+    long entrySteps = hasNext ? stepsFromRest(blocks[next], exitSqr) : 0;
+
+    bool committed = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (isPending(index)) {
+            b.exitSqr = exitSqr;
+            b.exitSteps = exitSteps;
+            if (hasNext) {
+                blocks[next].entrySteps = entrySteps;
+            }
+            committed = true;
+        }
+    }
+
+    return committed;
+}
+
+/**
+ * @brief Check if a block has not started
+ */
+bool MotionPlanner::isPending(uint8_t index) const {
+    uint8_t first = executing ? nextIndex(tail) : tail;
+    uint8_t offset = (index + MOTION_QUEUE_SIZE - first) % MOTION_QUEUE_SIZE;
+    uint8_t pending = (head + MOTION_QUEUE_SIZE - first) % MOTION_QUEUE_SIZE;
+    return offset < pending;
+}
+
+/**
+ * @brief Ramp index reached at a speed
+ *
+ * n = v^2 / 2a in dominant axis steps.
+ */
+long MotionPlanner::stepsFromRest(const PlannerBlock& block, float speedSqr) {
+    if (speedSqr <= 0.0) return 0;
+    return (long)(speedSqr * block.stepsPerUnit / (2.0 * block.acceleration));
+}
@@ -0,0 +1,177 @@
+/**
+ * @file MotionPlanner.h
+ * @brief Lookahead planner for coordinated linear moves
+ *
+ * Linear moves are queued in a fixed size ring buffer. Each new move is
+ * joined to the previous one with a junction speed derived from the
+ * angle between them, and a backward/forward pass over the queue picks
+ * entry and exit speeds so consecutive moves blend without stopping.
+ * The step interrupt takes blocks from the tail of the queue.
+ */
+
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+/**
+ * @struct LinearMove
+ * @brief Coordinated move request for several axes
+ */
+struct LinearMove {
+    long target[NUM_STEPPERS];          // Absolute target per axis (steps)
+    uint8_t axisMask;                   // Axes taking part (bit per axis index)
+    float stepsPerUnit[NUM_STEPPERS];   // Steps per device unit
+    float maxRate[NUM_STEPPERS];        // Axis rate limit (steps/sec)
+    float maxAccel[NUM_STEPPERS];       // Axis acceleration limit (steps/sec^2)
+    float feed;                         // Path speed (units/sec), 0 = axis limits only
+};
+
+/**
+ * @struct PlannerBlock
+ * @brief One queued linear move
+ *
+ * The step fields are read by the step interrupt and only change with
+ * interrupts disabled; the path fields belong to the planner.
+ */
+struct PlannerBlock {
+    // Step interrupt
+    uint8_t axisMask;                   // Axes taking part
+    uint8_t directionBits;              // Bit set = axis moves backwards
+    long delta[NUM_STEPPERS];           // Absolute steps per axis
+    long eventCount;                    // Steps of the dominant axis
+    uint32_t nominalInterval;           // Cruise interval (ticks << 8)
+    uint32_t rampScale;                 // Ramp table scale of the path acceleration
+    long entrySteps;                    // Ramp index at the entry junction
+    long exitSteps;                     // Ramp index at the exit junction
+
+    // Planner (path units)
+    float length;                       // Path length (units)
+    float acceleration;                 // Path acceleration (units/sec^2)
+    float stepsPerUnit;                 // Dominant axis steps per path unit
+    float nominalSqr;                   // Cruise speed squared
+    float maxEntrySqr;                  // Junction limit squared
+    float entrySqr;                     // Planned entry speed squared
+    float exitSqr;                      // Committed exit speed squared
+};
+
+/**
+ * @class MotionPlanner
+ * @brief Ring buffer of linear moves with junction velocity blending
+ *
+ * The block being stepped and its exit speed are fixed. Every other
+ * exit speed is committed together with the entry of the following
+ * block, so the interrupt always sees matching junctions.
+ */
+class MotionPlanner {
+public:
+    static constexpr uint8_t MAX_AXES = NUM_STEPPERS;
+
+private:
+    PlannerBlock blocks[MOTION_QUEUE_SIZE];
+    volatile uint8_t head;              // Next free slot
+    volatile uint8_t tail;              // Oldest block
+    volatile bool executing;            // Tail block is being stepped
+    bool resync;                        // Queue was flushed while a block ran
+
+    long position[MAX_AXES];            // End of the last queued move (steps)
+    float previousUnit[MAX_AXES];       // Direction of the last queued move
+    float previousNominalSqr;           // Cruise speed squared of the last move
+
+public:
+    /**
+     * @brief Constructor
+     */
+    MotionPlanner();
+
+    /**
+     * @brief Queue a linear move
+     * @param move Targets, axis limits and feed
+     * @return true if queued (false if full or still stopping)
+     */
+    bool bufferLine(const LinearMove& move);
+
+    /**
+     * @brief Get number of queued blocks (including the running one)
+     * @return Queue depth
+     */
+    uint8_t getDepth() const;
+
+    /**
+     * @brief Get number of free queue slots
+     * @return Free slots
+     */
+    uint8_t getFreeSlots() const { return MOTION_QUEUE_SIZE - 1 - getDepth(); }
+
+    /**
+     * @brief Check if nothing is queued or running
+     * @return true if empty
+     */
+    bool isEmpty() const { return head == tail; }
+
+    /**
+     * @brief Drop all blocks that have not started
+     */
+    void flush();
+
+    /**
+     * @brief Drop all blocks including the running one
+     */
+    void clear();
+
+    /**
+     * @brief Get the block at the tail (called from the ISR)
+     * @return Block or nullptr if empty
+     */
+    const PlannerBlock* getCurrentBlock() const {
+        return (head != tail) ? &blocks[tail] : nullptr;
+    }
+
+    /**
+     * @brief Mark the tail block as running (called from the ISR)
+     */
+    void beginCurrentBlock() { executing = true; }
+
+    /**
+     * @brief Release the finished tail block (called from the ISR)
+     */
+    void discardCurrentBlock();
+
+private:
+    /**
+     * @brief Recompute entry and exit speeds of all pending blocks
+     */
+    void recalculate();
+
+    /**
+     * @brief Commit an exit speed and the matching next entry
+     * @param index Block index
+     * @param exitSqr Exit speed squared
+     * @return false if the block has already started
+     */
+    bool commitJunction(uint8_t index, float exitSqr);
+
+    /**
+     * @brief Check if a block has not started (interrupts disabled)
+     * @param index Block index
+     * @return true if pending
+     */
+    bool isPending(uint8_t index) const;
+
+    /**
+     * @brief Ramp index reached at a speed
+     * @param block Block
+     * @param speedSqr Path speed squared
+     * @return Steps from rest
+     */
+    static long stepsFromRest(const PlannerBlock& block, float speedSqr);
+
+    static uint8_t nextIndex(uint8_t index) { return (index + 1) % MOTION_QUEUE_SIZE; }
+    static uint8_t prevIndex(uint8_t index) { return (index + MOTION_QUEUE_SIZE - 1) % MOTION_QUEUE_SIZE; }
+};
+
+// Global motion planner instance
+extern MotionPlanner motionPlanner;
+
+#endif // MOTION_PLANNER_H
@@ -0,0 +1,104 @@
+/**
+ * @file RampTable.h
+ * @brief Normalized constant-acceleration ramp table
+ *
+ * Step intervals of a ramp from rest at 1 step/sec^2, sampled at
+ * segment boundaries: every ramp index below 16, then four segments per
+ * octave up to 2^28 steps. Between boundaries the interval is linear in
+ * the ramp index, so stepping through a segment is a single add.
+ *
+ * Values are fixed point: interval(n) = sqrt(2) * (sqrt(n + 1) - sqrt(n))
+ * * 2^28 seconds (0.676 * sqrt(2) * 2^28 for n = 0, Austin's first-step
+ * correction); slopes are the interval decrease per step * 256. A ramp
+ * scales them by STEP_TIMER_FREQUENCY * 16 / sqrt(acceleration) (see
+ * StepGenerator::accelerationToScale()).
+ */
+
+#ifndef RAMP_TABLE_H
+#define RAMP_TABLE_H
+
+#include <Arduino.h>
+
+// Number of table segments (boundaries 0 .. RAMP_TABLE_SEGMENTS)
+#define RAMP_TABLE_SEGMENTS 112
+
+// Interval at each segment boundary
+static const uint32_t RAMP_TABLE_INTERVAL[RAMP_TABLE_SEGMENTS + 1] PROGMEM = {
+     256626542UL,  157245850UL,  120658984UL,  101720229UL,   89617321UL,   81020251UL,
+      74505810UL,   69348317UL,   65133363UL,   61604667UL,   58594039UL,   55985899UL,
+      53697836UL,   51669291UL,   49854626UL,   48218705UL,   46733981UL,   42987608UL,
+      39157552UL,   36197325UL,   33296306UL,   30591704UL,   27835862UL,   25711724UL,
+      23634602UL,   21701836UL,   19735839UL,   18222635UL,   16744575UL,   15370590UL,
+      13974204UL,   12900193UL,   11851721UL,   10877557UL,    9887949UL,    9127081UL,
+       8384516UL,    7694752UL,    6994208UL,    6455686UL,    5930194UL,    5442129UL,
+       4946491UL,    4565519UL,    4193792UL,    3848562UL,    3497994UL,    3228543UL,
+       2965640UL,    2721484UL,    2473561UL,    2283007UL,    2097088UL,    1924429UL,
+       1749109UL,    1614359UL,    1482888UL,    1360794UL,    1236820UL,    1141535UL,
+       1048568UL,     962233UL,     874568UL,     807191UL,     741452UL,     680404UL,
+        618415UL,     570771UL,     524287UL,     481119UL,     437286UL,     403597UL,
+        370727UL,     340203UL,     309208UL,     285386UL,     262144UL,     240560UL,
+        218643UL,     201798UL,     185364UL,     170101UL,     154604UL,     142693UL,
+        131072UL,     120280UL,     109322UL,     100899UL,      92682UL,      85051UL,
+         77302UL,      71347UL,      65536UL,      60140UL,      54661UL,      50450UL,
+         46341UL,      42525UL,      38651UL,      35673UL,      32768UL,      30070UL,
+         27330UL,      25225UL,      23170UL,      21263UL,      19326UL,      17837UL,
+         16384UL,      15035UL,      13665UL,      12612UL,      11585UL
+};
+
+// Interval decrease per step inside each segment (<< 8, 0 for one-step segments)
+static const uint32_t RAMP_TABLE_SLOPE[RAMP_TABLE_SEGMENTS] PROGMEM = {
+             0UL,          0UL,          0UL,          0UL,          0UL,          0UL,
+             0UL,          0UL,          0UL,          0UL,          0UL,          0UL,
+             0UL,          0UL,          0UL,          0UL,  319690496UL,  245123584UL,
+     189454528UL,  148532173UL,  115396352UL,   88186944UL,   67972416UL,   53174323UL,
+      41232341UL,   31455952UL,   24211264UL,   18919168UL,   14655840UL,   11171088UL,
+       8592088UL,    6710221UL,    5195541UL,    3958432UL,    3043472UL,    2376208UL,
+       1839371UL,    1401088UL,    1077044UL,     840787UL,     650753UL,     495638UL,
+        380972UL,     297382UL,     230153UL,     175284UL,     134726UL,     105161UL,
+         81385UL,      61981UL,      47638UL,      37184UL,      28776UL,      21915UL,
+         16844UL,      13147UL,      10174UL,       7748UL,       5955UL,       4648UL,
+          3597UL,       2740UL,       2106UL,       1643UL,       1272UL,        969UL,
+           744UL,        581UL,        450UL,        342UL,        263UL,        205UL,
+           159UL,        121UL,         93UL,         73UL,         56UL,         43UL,
+            33UL,         26UL,         20UL,         15UL,         12UL,          9UL,
+             7UL,          5UL,          4UL,          3UL,          2UL,          2UL,
+             1UL,          1UL,          1UL,          1UL,          1UL,          0UL,
+             0UL,          0UL,          0UL,          0UL,          0UL,          0UL,
+             0UL,          0UL,          0UL,          0UL,          0UL,          0UL,
+             0UL,          0UL,          0UL,          0UL
+};
+
+// Boundary mantissas within an octave (16 * 2^(i/4), rounded)
+static const uint8_t RAMP_TABLE_MANTISSA[4] = { 16, 19, 23, 27 };
+
+/**
+ * @brief Ramp index at the start of a segment
+ * @param segment Segment number (0 .. RAMP_TABLE_SEGMENTS)
+ * @return Ramp index
+ */
+inline long rampTableBoundary(uint8_t segment) {
+    if (segment < 16) return segment;
+    uint8_t octave = (segment - 16) >> 2;
+    return (long)RAMP_TABLE_MANTISSA[(segment - 16) & 3] << octave;
+}
+
+/**
+ * @brief Segment containing a ramp index
+ * @param index Ramp index (>= 0)
+ * @return Segment number (0 .. RAMP_TABLE_SEGMENTS - 1)
+ */
+inline uint8_t rampTableSegment(long index) {
+    if (index < 16) return (uint8_t)index;
+
+    uint8_t octave = 0;
+    while (index >= 32) {
+        index >>= 1;
+        octave++;
+    }
+
+    uint8_t sub = (index >= 27) ? 3 : (index >= 23) ? 2 : (index >= 19) ? 1 : 0;
+    uint16_t segment = 16 + 4 * octave + sub;
+    return (segment < RAMP_TABLE_SEGMENTS) ? segment : RAMP_TABLE_SEGMENTS - 1;
+}
+
+#endif // RAMP_TABLE_H
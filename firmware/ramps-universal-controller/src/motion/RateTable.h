@@ -0,0 +1,70 @@
+/**
+ * @file RateTable.h
+ * @brief Reciprocal table: step interval of an S-curve rate
+ *
+ * S-curve ramps integrate their rate in steps/sec << 16 and need the
+ * step interval, its reciprocal, after every step. The table holds
+ * 4 * STEP_TIMER_FREQUENCY / m for the mantissas m = 128 .. 256 of a
+ * rate normalized to 16 bits; between entries the interval is
+ * interpolated linearly (error below 1e-4), so the interrupt finds an
+ * interval with a table read, a multiply and shifts instead of a
+ * division.
+ */
+
+#ifndef RATE_TABLE_H
+#define RATE_TABLE_H
+
+#include <Arduino.h>
+
+// Step timer frequency the table is computed for
+#define RATE_TABLE_TIMER_FREQUENCY 2000000UL
+
+// Interval at mantissa 128 + i: 8000000 / (128 + i), rounded
+static const uint16_t RATE_TABLE_INTERVAL[129] PROGMEM = {
+    62500, 62016, 61538, 61069, 60606, 60150, 59701, 59259,
+    58824, 58394, 57971, 57554, 57143, 56738, 56338, 55944,
+    55556, 55172, 54795, 54422, 54054, 53691, 53333, 52980,
+    52632, 52288, 51948, 51613, 51282, 50955, 50633, 50314,
+    50000, 49689, 49383, 49080, 48780, 48485, 48193, 47904,
+    47619, 47337, 47059, 46784, 46512, 46243, 45977, 45714,
+    45455, 45198, 44944, 44693, 44444, 44199, 43956, 43716,
+    43478, 43243, 43011, 42781, 42553, 42328, 42105, 41885,
+    41667, 41451, 41237, 41026, 40816, 40609, 40404, 40201,
+    40000, 39801, 39604, 39409, 39216, 39024, 38835, 38647,
+    38462, 38278, 38095, 37915, 37736, 37559, 37383, 37209,
+    37037, 36866, 36697, 36530, 36364, 36199, 36036, 35874,
+    35714, 35556, 35398, 35242, 35088, 34934, 34783, 34632,
+    34483, 34335, 34188, 34043, 33898, 33755, 33613, 33473,
+    33333, 33195, 33058, 32922, 32787, 32653, 32520, 32389,
+    32258, 32129, 32000, 31873, 31746, 31621, 31496, 31373,
+    31250
+};
+
+/**
+ * @brief Step interval of a rate
+ * @param rate Rate in steps/sec << 16 (at least 2^15)
+ * @return Interval in ticks << 8
+ */
+inline uint32_t rateTableInterval(uint32_t rate) {
+    // Normalize to 16 bits: 7 bits of index below the leading one, 8 of fraction
+    uint8_t shift = 0;
+    while (rate >= 0x1000000UL) {
+        rate >>= 8;
+        shift += 8;
+    }
+    while (rate >= 0x10000UL) {
+        rate >>= 1;
+        shift++;
+    }
+
+    uint8_t index = (uint8_t)(rate >> 8) - 128;
+    uint8_t fraction = rate & 0xFF;
+    uint16_t low = pgm_read_word(&RATE_TABLE_INTERVAL[index]);
+    uint16_t high = pgm_read_word(&RATE_TABLE_INTERVAL[index + 1]);
+    uint32_t interval = low - (((uint32_t)(low - high) * fraction) >> 8);
+
+    // rate = mantissa << (shift + 8), interval = entry << (14 - shift)
+    return (shift <= 14) ? interval << (14 - shift) : interval >> (shift - 14);
+}
+
+#endif // RATE_TABLE_H
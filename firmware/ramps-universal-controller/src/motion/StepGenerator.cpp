@@ -0,0 +1,1121 @@
+/**
+ * @file StepGenerator.cpp
+ * @brief Implementation of StepGenerator class
+ */
+
+#include "StepGenerator.h"
+#include "MotionPlanner.h"
+#include "RampTable.h"
+#include "RateTable.h"
+#include <util/atomic.h>
+
+#if defined(NATIVE_BUILD)
+#include <NativeHal.h>
+#endif
+
+// Global step generator instance
+StepGenerator stepGenerator;
+
+// Interval limits (ticks << 8)
+static const uint32_t MIN_INTERVAL = (uint32_t)((STEP_TIMER_FREQUENCY * 256.0) / STEP_MAX_RATE);
+static const uint32_t MAX_INTERVAL = 0x3FFFFFFFUL;
+
+// Interval units (ticks << 8) per second
+static const float INTERVAL_SCALE = STEP_TIMER_FREQUENCY * 256.0;
+
+// S-curve fixed point: rates in steps/sec << 16, accelerations in rate
+// units per tick << 16, jerk in acceleration units per tick << 16
+static const float SCURVE_RATE_SCALE = 65536.0;
+static const float SCURVE_ACCEL_SCALE = SCURVE_RATE_SCALE * 65536.0 / STEP_TIMER_FREQUENCY;
+static const float SCURVE_JERK_SCALE = SCURVE_ACCEL_SCALE * 65536.0 / STEP_TIMER_FREQUENCY;
+static const uint32_t SCURVE_MIN_RATE = (uint32_t)(STEP_SCURVE_MIN_RATE * 65536.0);
+static const uint32_t SCURVE_ACCEL_LIMIT = 0x7FFFFFFFUL;   // Sum of two fits 32 bits
+
+static_assert(STEP_TIMER_FREQUENCY == RATE_TABLE_TIMER_FREQUENCY,
+              "RateTable.h is computed for another step timer frequency");
+static_assert(STEP_TIMER_FREQUENCY / STEP_SCURVE_MIN_RATE < 65536,
+              "S-curve step intervals must fit 16 bits of timer ticks");
+
+/**
+ * @brief Multiply by a tick count and drop 16 fractional bits
+ *
+ * Two 16 x 16 bit products instead of a 64 bit multiply.
+ */
+static inline uint32_t scaleByTicks(uint32_t value, uint16_t ticks) {
+    return (uint32_t)(uint16_t)(value >> 16) * ticks +
+           (((uint32_t)(uint16_t)value * ticks) >> 16);
+}
+
+/**
+ * @brief Convert to fixed point, saturating at a limit
+ */
+static uint32_t toFixed(float value, uint32_t limit) {
+    if (value <= 0.0) return 0;
+    return (value >= (float)limit) ? limit : (uint32_t)value;
+}
+
+#if defined(__AVR__)
+/**
+ * @brief Timer1 compare match A - step generation
+ */
+ISR(TIMER1_COMPA_vect) {
+    stepGenerator.handleInterrupt();
+}
+#elif defined(NATIVE_BUILD)
+/**
+ * @brief Simulated Timer1 compare match (host builds)
+ * @return Ticks until the next match
+ */
+static uint32_t simulatedTimer1() {
+    stepGenerator.handleInterrupt();
+    return stepGenerator.getTimerPeriod();
+}
+#endif
+
+/**
+ * @brief Constructor
+ */
+StepGenerator::StepGenerator() {
+    numAxes = 0;
+    block.running = false;
+    block.position = 0;
+    block.target = 0;
+    block.axisMask = 0;
+    block.exitSteps = 0;
+    numStepPorts = 0;
+    dirPending = 0;
+    currentPeriod = STEP_IDLE_TICKS;
+    started = false;
+}
+
+/**
+ * @brief Configure Timer1 and start the step interrupt
+ */
+void StepGenerator::begin() {
+    if (started) return;
+
+#if defined(__AVR__)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TCCR1A = 0;
+        TCCR1B = _BV(WGM12) | _BV(CS11);    // CTC mode, prescaler 8
+        TCNT1 = 0;
+        OCR1A = STEP_IDLE_TICKS - 1;
+        TIMSK1 |= _BV(OCIE1A);
+    }
+#elif defined(NATIVE_BUILD)
+    NativeHal::attachTimer(simulatedTimer1, STEP_TIMER_FREQUENCY, STEP_IDLE_TICKS);
+#endif
+
+    currentPeriod = STEP_IDLE_TICKS;
+    started = true;
+}
+
+/**
+ * @brief Register an axis
+ */
+uint8_t StepGenerator::attachAxis(uint8_t stepPin, uint8_t dirPin) {
+    if (numAxes >= MAX_AXES) return NO_AXIS;
+
+    Axis& a = axes[numAxes];
+    a.stepPin = stepPin;
+    a.dirPin = dirPin;
+    a.step.attach(stepPin);
+    a.dir.attach(dirPin);
+    a.invertDir = false;
+    a.position = 0;
+    a.target = 0;
+    a.running = false;
+    a.forward = true;
+    a.n = 0;
+    a.cn = 0;
+    a.cmin = rateToInterval(DEFAULT_MAX_SPEED);
+    a.countdown = 0;
+    a.acceleration = 0.0;
+    a.scale = 0;
+    a.exitSteps = 0;
+    a.inBlock = false;
+    a.limits = 0;
+    a.jerkLimit = DEFAULT_JERK;
+    a.jerk = 0.0;
+    a.phase = SCURVE_CRUISE;
+    a.stopping = false;
+    a.rampUp = true;
+    a.rate = 0;
+    a.accelNow = 0;
+    a.lead = 0;
+    a.rampEnd = 0;
+    a.cruiseRate = 0;
+    a.cruiseStopSteps = 0;
+    a.accelMax = 0;
+    a.jerkStep = 0;
+    a.leadMax = 0;
+    setRampAcceleration(a, DEFAULT_ACCELERATION, accelerationToScale(DEFAULT_ACCELERATION));
+
+    // Axes whose step pins share a port share a slot
+    uint8_t slot = 0;
+    while (slot < numStepPorts && stepPorts[slot] != a.step.port) slot++;
+    if (slot == numStepPorts) {
+        stepPorts[slot] = a.step.port;
+        stepBits[slot] = 0;
+        numStepPorts++;
+    }
+    a.stepSlot = slot;
+
+    return numAxes++;
+}
+
+/**
+ * @brief Configure axis output pins
+ */
+void StepGenerator::initAxis(uint8_t axis) {
+    if (axis >= numAxes) return;
+
+    Axis& a = axes[axis];
+    pinMode(a.stepPin, OUTPUT);
+    pinMode(a.dirPin, OUTPUT);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        a.step.writeFromISR(false);
+        writeDirection(a);
+    }
+}
+
+/**
+ * @brief Invert the direction output of an axis
+ */
+void StepGenerator::setInvertDirection(uint8_t axis, bool invert) {
+    if (axis >= numAxes) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        axes[axis].invertDir = invert;
+        writeDirection(axes[axis]);
+    }
+}
+
+/**
+ * @brief Set ramp acceleration
+ */
+void StepGenerator::setAcceleration(uint8_t axis, float accel) {
+    if (axis >= numAxes) return;
+
+    accel = abs(accel);
+    if (accel < STEP_MIN_ACCELERATION) accel = STEP_MIN_ACCELERATION;
+    uint32_t scale = accelerationToScale(accel);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        setRampAcceleration(axes[axis], accel, scale);
+    }
+}
+
+/**
+ * @brief Set jerk limit
+ */
+void StepGenerator::setJerk(uint8_t axis, float jerk) {
+    if (axis >= numAxes) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        axes[axis].jerkLimit = abs(jerk);
+    }
+}
+
+/**
+ * @brief Start or retarget a move
+ */
+bool StepGenerator::submit(uint8_t axis, const MoveSegment& segment) {
+    if (axis >= numAxes) return false;
+
+    long position = getPosition(axis);
+    if (segment.target != position && isLimited(axis, segment.target > position)) {
+        return false;
+    }
+
+    uint32_t cmin = rateToInterval(segment.maxRate);
+
+    Axis& a = axes[axis];
+    bool scurve;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // A running move keeps its profile; a new one uses the current setting
+        scurve = a.running ? (a.jerk > 0.0) : (a.jerkLimit > 0.0);
+    }
+    if (scurve) return submitSCurve(a, segment, cmin);
+
+    bool accepted = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Single-axis moves wait until the planner queue has drained
+        if (!a.inBlock && motionPlanner.isEmpty()) {
+            a.target = segment.target;
+            a.cmin = cmin;
+            if (!a.running && a.target != a.position) {
+                a.jerk = 0.0;
+                a.jerkStep = 0;
+                startRamp(a);
+                writeDirection(a);
+            }
+            accepted = true;
+        }
+    }
+
+    return accepted;
+}
+
+/**
+ * @brief Decelerate to a stop
+ */
+void StepGenerator::stop(uint8_t axis) {
+    if (axis >= numAxes) return;
+
+    Axis& a = axes[axis];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Stopping an axis of a linear move stops the whole path
+        if (a.inBlock || !motionPlanner.isEmpty()) {
+            motionPlanner.flush();
+            block.exitSteps = 0;
+        }
+
+        Ramp& r = a.inBlock ? static_cast<Ramp&>(block) : static_cast<Ramp&>(a);
+        if (!a.inBlock && a.running && a.jerk > 0.0) {
+            a.stopping = true;  // S-curve ramps down in the interrupt
+        } else if (r.running) {
+            long stepsToStop = (r.n >= 0) ? r.n : -r.n;
+            r.target = r.position + (r.forward ? stepsToStop : -stepsToStop);
+        } else {
+            r.target = r.position;
+        }
+    }
+}
+
+/**
+ * @brief Stop immediately
+ */
+void StepGenerator::halt(uint8_t axis) {
+    if (axis >= numAxes) return;
+
+    Axis& a = axes[axis];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (a.inBlock || !motionPlanner.isEmpty()) {
+            motionPlanner.clear();
+            if (block.running) {
+                block.running = false;
+                block.n = 0;
+                releaseBlock();
+            }
+        }
+        a.running = false;
+        a.stopping = false;
+        a.n = 0;
+        a.rate = 0;
+        a.accelNow = 0;
+        a.phase = SCURVE_CRUISE;
+        a.target = a.position;
+    }
+}
+
+/**
+ * @brief Set or clear a limit
+ */
+void StepGenerator::setLimit(uint8_t axis, bool forward, bool active) {
+    if (axis >= numAxes) return;
+
+    Axis& a = axes[axis];
+    uint8_t bit = forward ? LIMIT_FORWARD : LIMIT_BACKWARD;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (active) {
+            a.limits |= bit;
+            if ((a.running || a.inBlock) && a.forward == forward) {
+                halt(axis);
+            }
+        } else {
+            a.limits &= (uint8_t)~bit;
+        }
+    }
+}
+
+/**
+ * @brief Get current position
+ */
+long StepGenerator::getPosition(uint8_t axis) const {
+    if (axis >= numAxes) return 0;
+
+    long position;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        position = axes[axis].position;
+    }
+    return position;
+}
+
+/**
+ * @brief Overwrite current position
+ */
+void StepGenerator::setPosition(uint8_t axis, long position) {
+    if (axis >= numAxes) return;
+
+    Axis& a = axes[axis];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (a.inBlock || !motionPlanner.isEmpty()) {
+            motionPlanner.clear();
+            if (block.running) {
+                block.running = false;
+                block.n = 0;
+                releaseBlock();
+            }
+        }
+        a.running = false;
+        a.stopping = false;
+        a.n = 0;
+        a.rate = 0;
+        a.accelNow = 0;
+        a.phase = SCURVE_CRUISE;
+        a.position = position;
+        a.target = position;
+    }
+}
+
+/**
+ * @brief Get target position
+ */
+long StepGenerator::getTarget(uint8_t axis) const {
+    if (axis >= numAxes) return 0;
+
+    long target;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        target = axes[axis].target;
+    }
+    return target;
+}
+
+/**
+ * @brief Get current step rate
+ */
+float StepGenerator::getRate(uint8_t axis) const {
+    if (axis >= numAxes) return 0.0;
+
+    bool running;
+    bool forward;
+    uint32_t cn;
+    long delta = 1;
+    long events = 1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        const Axis& a = axes[axis];
+        forward = a.forward;
+        if (a.inBlock) {
+            // Followers run at a fixed fraction of the dominant axis rate
+            running = block.running;
+            cn = block.cn;
+            delta = block.delta[axis];
+            events = block.eventCount;
+        } else {
+            running = a.running;
+            cn = a.cn;
+        }
+    }
+
+    if (!running || cn == 0 || events == 0) return 0.0;
+
+    float rate = (STEP_TIMER_FREQUENCY * 256.0) / cn * ((float)delta / events);
+    return forward ? rate : -rate;
+}
+
+/**
+ * @brief Timer compare handler
+ *
+ * Advances every running axis and the linear block by the elapsed
+ * period and raises the step outputs of whatever is due, one write per
+ * port. The next intervals are computed while the pulses are high; the
+ * outputs drop once STEP_PULSE_TICKS have passed, then the directions of
+ * reversing axes and new blocks are written, and the compare register is
+ * programmed for the nearest upcoming step.
+ */
+void StepGenerator::handleInterrupt() {
+    int32_t elapsed = (int32_t)currentPeriod << 8;
+    int32_t nextDue = (int32_t)STEP_IDLE_TICKS << 8;
+    uint8_t due = 0;
+
+    for (uint8_t i = 0; i < numAxes; i++) {
+        Axis& a = axes[i];
+        if (!a.running) continue;
+
+        a.countdown -= elapsed;
+        if (a.countdown <= 0) {
+            pulse(a);
+            due |= (1 << i);
+        }
+    }
+
+    bool blockDue = false;
+    if (block.running) {
+        block.countdown -= elapsed;
+        if (block.countdown <= 0) {
+            stepBlock();
+            blockDue = true;
+        }
+    }
+
+    raiseSteps();
+#if defined(__AVR__)
+    uint16_t pulseStart = TCNT1;
+#endif
+
+    for (uint8_t i = 0; i < numAxes; i++) {
+        Axis& a = axes[i];
+        if (!a.running) continue;
+
+        if (due & (1 << i)) {
+            if (a.jerkStep) {
+                computeSCurveInterval(a);
+            } else if (computeNextInterval(a)) {
+                dirPending |= (1 << i);     // Reversed - STEP is still high
+            }
+            if (!a.running) continue;
+
+            a.countdown += a.cn;
+            if (a.countdown < 0) {
+                a.countdown = 0;    // Late - catch up on the next interrupt
+            }
+        }
+
+        if (a.countdown < nextDue) {
+            nextDue = a.countdown;
+        }
+    }
+
+    if (blockDue) {
+        if (block.position >= block.target) {
+            // Segment done - hand over to the next one at the junction rate
+            int32_t late = block.countdown;
+            releaseBlock();
+            motionPlanner.discardCurrentBlock();
+            block.running = false;
+            if (startBlock(true)) {
+                block.countdown = late + block.cn;
+            }
+        } else {
+            computeNextInterval(block);
+            block.countdown += block.cn;
+        }
+        if (block.countdown < 0) block.countdown = 0;
+    }
+
+    if (!block.running) {
+        startBlock(false);  // Queued move starting from rest
+    }
+
+    if (block.running && block.countdown < nextDue) {
+        nextDue = block.countdown;
+    }
+
+#if defined(__AVR__)
+    // Hold the pulses for the driver's minimum width (a counter reset at
+    // the compare value only means the width has long passed)
+    while ((uint16_t)(TCNT1 - pulseStart) < STEP_PULSE_TICKS) {
+    }
+#endif
+    lowerSteps();
+    latchDirections();
+
+    // Round up so an axis is never served early
+    uint32_t period = ((uint32_t)nextDue + 255) >> 8;
+    if (period < STEP_MIN_TICKS) period = STEP_MIN_TICKS;
+
+#if defined(__AVR__)
+    // Never program a compare value the counter has already passed
+    uint16_t now = TCNT1;
+    if (period <= (uint32_t)now + STEP_MIN_TICKS / 2) {
+        period = now + STEP_MIN_TICKS / 2;
+    }
+    OCR1A = period - 1;
+#endif
+
+    currentPeriod = period;
+}
+
+/**
+ * @brief Start a stopped ramp
+ */
+void StepGenerator::startRamp(Ramp& r) {
+    r.forward = (r.target > r.position);
+    r.n = 1;
+    seekRamp(r, 0);
+    r.cn = r.rampInterval;
+    r.countdown = 0;    // First step on the next interrupt
+    r.running = true;
+}
+
+/**
+ * @brief Compute interval to the next step
+ *
+ * Decision logic of AccelStepper::computeNewSpeed(). The magnitude of n
+ * equals the number of steps needed to stop from the current rate; it is
+ * held constant while cruising so deceleration starts at the right place.
+ * The interval itself is the ramp table entry at |n| - 1, which moves up
+ * while accelerating and down while decelerating.
+ */
+bool StepGenerator::computeNextInterval(Ramp& r) {
+    long distanceTo = r.target - r.position;
+    long stepsToStop = (r.n >= 0) ? r.n : -r.n;
+    long stepsToExit = stepsToStop - r.exitSteps;   // Steps to slow to the exit rate
+
+    if (distanceTo == 0 && stepsToStop <= 1) {
+        // At target and slow enough to stop
+        r.running = false;
+        r.n = 0;
+        return false;
+    }
+
+    if (distanceTo > 0) {
+        if (r.n > 0) {
+            // Accelerating or cruising - decelerate now or going the wrong way?
+            if (stepsToExit >= distanceTo || !r.forward) {
+                r.n = -stepsToStop;
+            }
+        } else if (r.n < 0) {
+            // Decelerating - can we accelerate again?
+            if (stepsToExit < distanceTo && r.forward) {
+                r.n = -r.n;
+            }
+        }
+    } else if (distanceTo < 0) {
+        if (r.n > 0) {
+            if (stepsToExit >= -distanceTo || r.forward) {
+                r.n = -stepsToStop;
+            }
+        } else if (r.n < 0) {
+            if (stepsToExit < -distanceTo && !r.forward) {
+                r.n = -r.n;
+            }
+        }
+    }
+
+    if (r.n == 0) {
+        // Came to rest while reversing - restart from the first interval
+        bool forward = (distanceTo > 0);
+        bool reversed = (forward != r.forward);
+        r.forward = forward;
+        r.n = 1;
+        seekRamp(r, 0);
+        r.cn = r.rampInterval;
+        return reversed;
+    }
+
+    if (r.n > 0) {
+        if (r.rampInterval <= r.cmin) {
+            // Cruising
+            r.cn = r.cmin;
+            return false;
+        }
+        r.cn = r.rampInterval;
+        r.n++;
+        advanceRamp(r);
+    } else {
+        r.cn = (r.rampInterval < r.cmin) ? r.cmin : r.rampInterval;
+        r.n++;
+        if (r.n != 0) retreatRamp(r);
+    }
+    return false;
+}
+
+/**
+ * @brief Set ramp acceleration
+ */
+void StepGenerator::setRampAcceleration(Ramp& r, float accel, uint32_t scale) {
+    // Keep steps-to-stop consistent with the new ramp (n ~ v^2 / 2a)
+    if (r.n != 0 && r.acceleration > 0.0) {
+        long n = (long)(r.n * (r.acceleration / accel));
+        if (n == 0) n = (r.n > 0) ? 1 : -1;
+        r.n = n;
+    }
+    r.acceleration = accel;
+    r.scale = scale;
+    seekRamp(r, (r.n > 0) ? r.n - 1 : (r.n < 0) ? -r.n - 1 : 0);
+}
+
+/**
+ * @brief Position the ramp table at a ramp index
+ */
+void StepGenerator::seekRamp(Ramp& r, long index) {
+    uint8_t segment = rampTableSegment(index);
+    loadRampSegment(r, segment, index - rampTableBoundary(segment));
+}
+
+/**
+ * @brief Load a ramp table segment
+ *
+ * The only multiplications of a ramp: the table entry and its slope
+ * are scaled once per segment. The slope keeps 16 fractional bits so
+ * long, flat segments do not round down to a constant interval.
+ */
+void StepGenerator::loadRampSegment(Ramp& r, uint8_t segment, long offset) {
+    uint32_t interval = pgm_read_dword(&RAMP_TABLE_INTERVAL[segment]);
+    uint32_t slope = pgm_read_dword(&RAMP_TABLE_SLOPE[segment]);
+    uint64_t delta = ((uint64_t)slope * r.scale) >> 16;    // (ticks << 8) << 16 per step
+    uint64_t decrease = delta * (uint32_t)offset;
+
+    r.segment = segment;
+    r.segmentStart = rampTableBoundary(segment);
+    r.segmentEnd = rampTableBoundary(segment + 1);
+    r.rampInterval = (((uint64_t)interval * r.scale) >> 24) - (uint32_t)(decrease >> 16);
+    r.rampDelta = delta >> 16;
+    r.rampFraction = delta & 0xFFFF;
+    r.rampError = decrease & 0xFFFF;
+}
+
+/**
+ * @brief Move the ramp table one index up
+ */
+void StepGenerator::advanceRamp(Ramp& r) {
+    long index = ((r.n > 0) ? r.n : -r.n) - 1;
+    if (index < r.segmentEnd) {
+        uint16_t error = r.rampError + r.rampFraction;
+        r.rampInterval -= r.rampDelta + (error < r.rampError ? 1 : 0);
+        r.rampError = error;
+    } else if (r.segment < RAMP_TABLE_SEGMENTS - 1) {
+        loadRampSegment(r, r.segment + 1, 0);
+    }
+}
+
+/**
+ * @brief Move the ramp table one index down
+ */
+void StepGenerator::retreatRamp(Ramp& r) {
+    long index = ((r.n > 0) ? r.n : -r.n) - 1;
+    if (index >= r.segmentStart) {
+        r.rampInterval += r.rampDelta + (r.rampError < r.rampFraction ? 1 : 0);
+        r.rampError -= r.rampFraction;
+    } else if (r.segment > 0) {
+        // Enter the previous segment at its last index
+        uint8_t segment = r.segment - 1;
+        loadRampSegment(r, segment, index - rampTableBoundary(segment));
+    }
+}
+
+/**
+ * @brief Start or retarget an S-curve move
+ *
+ * The square and cube roots, and the conversion of the limits to fixed
+ * point increments, are done here in the main loop; the interrupt only
+ * integrates jerk and acceleration.
+ */
+bool StepGenerator::submitSCurve(Axis& a, const MoveSegment& segment, uint32_t cmin) {
+    bool running;
+    long position;
+    float accel;
+    float jerk;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        running = a.running;
+        position = a.position;
+        accel = a.acceleration;
+        jerk = running ? a.jerk : a.jerkLimit;
+    }
+
+    float cruise = INTERVAL_SCALE / cmin;
+    if (!running) {
+        // From rest: lower the cruise rate until the ramps fit the move
+        float peak = scurvePeakRate(labs(segment.target - position), accel, jerk);
+        if (peak < STEP_SCURVE_MIN_RATE) peak = STEP_SCURVE_MIN_RATE;
+        if (peak < cruise) cruise = peak;
+    }
+    long cruiseStopSteps = scurveStopSteps(cruise, accel, jerk);
+    uint32_t cruiseRate = toFixed(cruise * SCURVE_RATE_SCALE, 0xFFFFFFFFUL);
+    uint32_t startInterval = rateToInterval(STEP_SCURVE_MIN_RATE);
+
+    uint32_t accelMax;
+    uint32_t jerkStep;
+    uint32_t leadMax;
+    scurveIncrements(accel, jerk, accelMax, jerkStep, leadMax);
+
+    bool accepted = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!a.inBlock && motionPlanner.isEmpty()) {
+            a.target = segment.target;
+            a.cmin = cmin;
+            a.cruiseRate = cruiseRate;
+            a.cruiseStopSteps = cruiseStopSteps;
+            a.accelMax = accelMax;
+            a.jerkStep = jerkStep;
+            a.leadMax = leadMax;
+            a.stopping = false;
+            if (!a.running && a.target != a.position) {
+                a.jerk = jerk;
+                a.forward = (a.target > a.position);
+                a.rate = SCURVE_MIN_RATE;
+                a.accelNow = 0;
+                a.cn = startInterval;
+                a.n = 0;
+                a.countdown = 0;    // First step on the next interrupt
+                beginSCurveRamp(a, cruiseRate);
+                a.running = true;
+                writeDirection(a);
+            }
+            accepted = true;
+        }
+    }
+
+    return accepted;
+}
+
+/**
+ * @brief Convert S-curve limits to fixed point increments
+ *
+ * leadMax is the rate added while the acceleration falls from the limit
+ * back to zero, a^2 / 2j.
+ */
+void StepGenerator::scurveIncrements(float accel, float jerk, uint32_t& accelMax,
+                                     uint32_t& jerkStep, uint32_t& leadMax) {
+    accelMax = toFixed(accel * SCURVE_ACCEL_SCALE, SCURVE_ACCEL_LIMIT);
+    jerkStep = toFixed(jerk * SCURVE_JERK_SCALE, SCURVE_ACCEL_LIMIT);
+    if (jerkStep == 0) jerkStep = 1;
+    leadMax = (jerk > 0.0) ? toFixed(accel * accel / (2.0 * jerk) * SCURVE_RATE_SCALE, SCURVE_ACCEL_LIMIT)
+                           : SCURVE_ACCEL_LIMIT;
+}
+
+/**
+ * @brief Begin an S-curve ramp from the current rate
+ */
+void StepGenerator::beginSCurveRamp(Axis& a, uint32_t endRate) {
+    a.rampUp = (endRate > a.rate);
+    a.rampEnd = endRate;
+    a.lead = 0;
+    a.phase = SCURVE_JERK_IN;
+}
+
+/**
+ * @brief Compute S-curve interval to the next step
+ *
+ * Acceleration and rate are integrated over the interval just taken, in
+ * fixed point with the per-tick increments prepared by submitSCurve().
+ * The jerk reverses once the rate change still outstanding equals the
+ * lead, what bringing the acceleration back to zero adds (a^2 / 2j). The
+ * lead grows by the mean acceleration times the interval while the
+ * acceleration builds up, so the same test covers ramps that reach the
+ * acceleration limit and ramps that do not, without a division.
+ * Deceleration starts when the remaining distance drops to the stopping
+ * distance of the cruise rate; a ramp that ends short of the target
+ * creeps the rest of the way at the minimum rate, and below twice that
+ * rate the axis may stop dead.
+ */
+void StepGenerator::computeSCurveInterval(Axis& a) {
+    long remaining = a.forward ? (a.target - a.position) : (a.position - a.target);
+    if ((remaining <= 0 || a.stopping) && a.rate <= 2 * SCURVE_MIN_RATE) {
+        // Arrived, stopped or overshot a target that moved
+        if (a.stopping) a.target = a.position;
+        a.running = false;
+        a.stopping = false;
+        a.rate = 0;
+        a.accelNow = 0;
+        a.phase = SCURVE_CRUISE;
+        return;
+    }
+
+    uint16_t ticks = (a.cn + 128) >> 8;     // Interval just taken
+    uint32_t jerkChange = scaleByTicks(a.jerkStep, ticks);
+
+    if (a.phase == SCURVE_JERK_IN || a.phase == SCURVE_HOLD) {
+        bool passed = a.rampUp ? (a.rate >= a.rampEnd) : (a.rate <= a.rampEnd);
+        uint32_t outstanding = a.rampUp ? a.rampEnd - a.rate : a.rate - a.rampEnd;
+        if (a.rampUp && (a.stopping || remaining <= a.cruiseStopSteps)) {
+            // Target moved in or stop requested - level off now
+            a.rampEnd = a.rate + a.lead;
+            a.phase = SCURVE_JERK_OUT;
+        } else if (passed || outstanding <= a.lead) {
+            a.phase = SCURVE_JERK_OUT;
+        } else if (a.phase == SCURVE_JERK_IN) {
+            uint32_t previous = a.accelNow;
+            a.accelNow += jerkChange;
+            if (a.accelNow >= a.accelMax) {
+                a.accelNow = a.accelMax;
+                a.lead = a.leadMax;
+                a.phase = SCURVE_HOLD;
+            } else {
+                a.lead += scaleByTicks(previous + a.accelNow, ticks) >> 1;
+            }
+        }
+    }
+
+    if (a.phase == SCURVE_JERK_OUT) {
+        if (a.accelNow <= jerkChange) {
+            a.accelNow = 0;
+            a.rate = a.rampEnd;
+            a.phase = SCURVE_CRUISE;
+        } else {
+            a.accelNow -= jerkChange;
+        }
+    }
+
+    if (a.phase != SCURVE_CRUISE && a.phase != SCURVE_CREEP) {
+        uint32_t change = scaleByTicks(a.accelNow, ticks);
+        bool reached;
+        if (a.rampUp) {
+            a.rate += change;
+            reached = (a.rate >= a.rampEnd);
+        } else {
+            reached = (a.rate <= a.rampEnd + change);
+            if (!reached) a.rate -= change;
+        }
+        if (reached) {
+            a.rate = a.rampEnd;
+            a.accelNow = 0;
+            a.phase = SCURVE_CRUISE;
+        }
+    } else {
+        if (remaining <= 0 || a.stopping || remaining <= a.cruiseStopSteps) {
+            if (a.rate <= SCURVE_MIN_RATE) {
+                a.phase = SCURVE_CREEP;
+            } else {
+                beginSCurveRamp(a, 0);
+            }
+        } else if (a.rate > a.cruiseRate) {
+            beginSCurveRamp(a, a.cruiseRate);
+        } else if (a.rate < a.cruiseRate && remaining > 2 * a.cruiseStopSteps) {
+            beginSCurveRamp(a, a.cruiseRate);
+        }
+    }
+
+    uint32_t next = rateTableInterval((a.rate < SCURVE_MIN_RATE) ? SCURVE_MIN_RATE : a.rate);
+    a.cn = (next < a.cmin) ? a.cmin : next;
+}
+
+/**
+ * @brief Steps needed to stop with an S-curve
+ *
+ * The deceleration ramp is symmetric, so its length is the mean rate
+ * times its duration: v/a + a/j with the peak acceleration a, which
+ * stays below the limit (a = sqrt(v j)) for small rates.
+ */
+long StepGenerator::scurveStopSteps(float rate, float accel, float jerk) {
+    rate = abs(rate);
+    if (rate <= 0.0 || jerk <= 0.0) return 0;
+
+    float peak = sqrt(rate * jerk);
+    if (peak > accel) peak = accel;
+    return (long)(0.5 * rate * (rate / peak + peak / jerk)) + 1;
+}
+
+/**
+ * @brief Highest rate an S-curve move can reach
+ *
+ * Solves distance = 2 * stopping distance for the rate.
+ */
+float StepGenerator::scurvePeakRate(long distance, float accel, float jerk) {
+    if (distance <= 0 || accel <= 0.0 || jerk <= 0.0) return 0.0;
+
+    float d = distance;
+    if (d >= 2.0 * accel * accel * accel / (jerk * jerk)) {
+        // Reaches the acceleration limit
+        float b = accel / jerk;
+        return 0.5 * accel * (sqrt(b * b + 4.0 * d / accel) - b);
+    }
+    return cbrt(d * d * jerk / 4.0);
+}
+
+/**
+ * @brief Start the next planner block
+ *
+ * Copies the tail block of the planner queue into the running block.
+ * After a junction the ramp continues at the planned entry rate,
+ * otherwise it starts from rest.
+ */
+bool StepGenerator::startBlock(bool carry) {
+    const PlannerBlock* b = motionPlanner.getCurrentBlock();
+    if (!b) return false;
+
+    // Wait for single-axis moves that are still running
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if ((b->axisMask & (1 << i)) && axes[i].running) return false;
+    }
+
+    // A move into a triggered limit drops the queued path
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if (!(b->axisMask & (1 << i)) || b->delta[i] == 0) continue;
+        bool forward = !(b->directionBits & (1 << i));
+        if (axes[i].limits & (forward ? LIMIT_FORWARD : LIMIT_BACKWARD)) {
+            motionPlanner.clear();
+            return false;
+        }
+    }
+
+    block.axisMask = b->axisMask;
+    block.eventCount = b->eventCount;
+    for (uint8_t i = 0; i < numAxes; i++) {
+        block.delta[i] = b->delta[i];
+        block.error[i] = -(b->eventCount >> 1);
+        if (!(b->axisMask & (1 << i))) continue;
+
+        Axis& a = axes[i];
+        a.forward = !(b->directionBits & (1 << i));
+        a.target = a.position + (a.forward ? b->delta[i] : -b->delta[i]);
+        a.inBlock = true;
+        dirPending |= (1 << i);     // Written once the pulses are down
+    }
+
+    // The block ramp counts dominant axis step events
+    block.position = 0;
+    block.target = b->eventCount;
+    block.forward = true;
+    block.cmin = b->nominalInterval;
+    block.scale = b->rampScale;
+    block.exitSteps = b->exitSteps;
+    block.n = (carry && b->entrySteps > 0) ? b->entrySteps : 1;
+    seekRamp(block, block.n - 1);
+    block.cn = (block.rampInterval < block.cmin) ? block.cmin : block.rampInterval;
+    block.countdown = 0;    // First step on the next interrupt
+    block.running = true;
+
+    motionPlanner.beginCurrentBlock();
+    return true;
+}
+
+/**
+ * @brief Advance the linear block by one step event
+ *
+ * Bresenham: every event adds each axis' step count to its accumulator
+ * and pulses the axes whose accumulator crosses zero. The dominant axis
+ * pulses on every event.
+ */
+void StepGenerator::stepBlock() {
+    block.position++;
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if (!(block.axisMask & (1 << i))) continue;
+
+        block.error[i] += block.delta[i];
+        if (block.error[i] > 0) {
+            block.error[i] -= block.eventCount;
+            pulse(axes[i]);
+        }
+    }
+}
+
+/**
+ * @brief Release the axes of a finished or halted block
+ */
+void StepGenerator::releaseBlock() {
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if (!(block.axisMask & (1 << i))) continue;
+
+        // A move stopped early ends wherever the axes are
+        axes[i].target = axes[i].position;
+        axes[i].inBlock = false;
+    }
+    block.axisMask = 0;
+}
+
+/**
+ * @brief Queue one step pulse
+ */
+void StepGenerator::pulse(Axis& a) {
+    stepBits[a.stepSlot] |= a.step.mask;
+    a.position += a.forward ? 1 : -1;
+}
+
+/**
+ * @brief Raise all queued step outputs
+ */
+void StepGenerator::raiseSteps() {
+    for (uint8_t i = 0; i < numStepPorts; i++) {
+        if (stepBits[i]) fastSetBits(stepPorts[i], stepBits[i]);
+    }
+}
+
+/**
+ * @brief Lower the raised step outputs
+ */
+void StepGenerator::lowerSteps() {
+    for (uint8_t i = 0; i < numStepPorts; i++) {
+        if (stepBits[i]) {
+            fastClearBits(stepPorts[i], stepBits[i]);
+            stepBits[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Write the directions that changed during this interrupt
+ */
+void StepGenerator::latchDirections() {
+    if (!dirPending) return;
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if (dirPending & (1 << i)) writeDirection(axes[i]);
+    }
+    dirPending = 0;
+}
+
+/**
+ * @brief Write direction output (interrupts disabled or from the ISR)
+ */
+void StepGenerator::writeDirection(Axis& a) {
+    a.dir.writeFromISR(a.forward != a.invertDir);
+}
+
+/**
+ * @brief Time digitalWrite() against grouped port writes
+ */
+bool StepGenerator::benchmarkOutput(uint16_t iterations, uint32_t& pinMicros, uint32_t& portMicros) {
+    if (numAxes == 0) return false;
+    for (uint8_t i = 0; i < numAxes; i++) {
+        if (isRunning(i)) return false;
+    }
+
+    // Group the direction outputs by port the way the step outputs are
+    FastPort ports[MAX_AXES];
+    uint8_t bits[MAX_AXES];
+    uint8_t numPorts = 0;
+    for (uint8_t i = 0; i < numAxes; i++) {
+        uint8_t slot = 0;
+        while (slot < numPorts && ports[slot] != axes[i].dir.port) slot++;
+        if (slot == numPorts) {
+            ports[slot] = axes[i].dir.port;
+            bits[slot] = 0;
+            numPorts++;
+        }
+        bits[slot] |= axes[i].dir.mask;
+    }
+
+    // Before: one digitalWrite() high and low per axis
+    unsigned long start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (uint8_t i = 0; i < numAxes; i++) {
+            digitalWrite(axes[i].dirPin, HIGH);
+            digitalWrite(axes[i].dirPin, LOW);
+        }
+    }
+    pinMicros = micros() - start;
+
+    // After: one write per port for all axes
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            for (uint8_t s = 0; s < numPorts; s++) fastSetBits(ports[s], bits[s]);
+            for (uint8_t s = 0; s < numPorts; s++) fastClearBits(ports[s], bits[s]);
+        }
+    }
+    portMicros = micros() - start;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (uint8_t i = 0; i < numAxes; i++) writeDirection(axes[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief Convert a step rate to an interval
+ */
+uint32_t StepGenerator::rateToInterval(float rate) {
+    rate = abs(rate);
+    if (rate <= 0.0) return MAX_INTERVAL;
+    if (rate > STEP_MAX_RATE) rate = STEP_MAX_RATE;
+
+    float interval = (STEP_TIMER_FREQUENCY * 256.0) / rate;
+    if (interval > MAX_INTERVAL) return MAX_INTERVAL;
+    if (interval < MIN_INTERVAL) return MIN_INTERVAL;
+    return (uint32_t)interval;
+}
+
+/**
+ * @brief Ramp table scale for an acceleration
+ *
+ * Table entries are seconds * 2^28 at 1 step/sec^2; intervals shrink
+ * with sqrt(accel), and (entry * scale) >> 24 gives ticks << 8.
+ */
+uint32_t StepGenerator::accelerationToScale(float accel) {
+    accel = abs(accel);
+    if (accel < STEP_MIN_ACCELERATION) accel = STEP_MIN_ACCELERATION;
+
+    return (uint32_t)(STEP_TIMER_FREQUENCY * 16.0 / sqrt(accel));
+}
\ No newline at end of file
@@ -0,0 +1,459 @@
+/**
+ * @file StepGenerator.h
+ * @brief Timer interrupt driven step pulse generator
+ *
+ * A single Timer1 compare interrupt serves all stepper axes. Each axis
+ * keeps its own countdown to the next step; after every pulse the next
+ * interval is computed immediately so the following interrupt only has
+ * to emit the pulse. Step outputs go straight to the PORT registers;
+ * axes stepping in the same interrupt share one write per port. Step
+ * timing is therefore independent of how long the main loop spends
+ * parsing commands or updating other devices.
+ */
+
+#ifndef STEP_GENERATOR_H
+#define STEP_GENERATOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "../utils/FastIO.h"
+
+/**
+ * @struct MoveSegment
+ * @brief Motion request handed from a StepperMotor to the generator
+ */
+struct MoveSegment {
+    long target;                // Absolute target position (steps)
+    float maxRate;              // Cruise rate for this segment (steps/sec)
+};
+
+/**
+ * @class StepGenerator
+ * @brief Interrupt driven trapezoidal step generation for all axes
+ *
+ * Ramps follow the constant acceleration model of David Austin (as used
+ * by AccelStepper), evaluated in timer ticks with 8 fractional bits.
+ * Intervals come from a normalized ramp table scaled once per segment
+ * by the ramp's acceleration, so a step costs a compare and an add.
+ * Axes with a jerk limit use a 7-segment
+ * S-curve instead: rate and acceleration are integrated in fixed point
+ * over each step interval, with increments per timer tick prepared in
+ * the main loop, so a step costs a few integer multiply-adds and a
+ * reciprocal table lookup (RateTable.h).
+ */
+class StepGenerator {
+public:
+    static constexpr uint8_t MAX_AXES = NUM_STEPPERS;
+    static constexpr uint8_t NO_AXIS = 0xFF;
+    static constexpr uint8_t LIMIT_FORWARD = 0x01;     // Positive travel blocked
+    static constexpr uint8_t LIMIT_BACKWARD = 0x02;    // Negative travel blocked
+
+    /**
+     * @enum SCurvePhase
+     * @brief Segment of an S-curve ramp
+     */
+    enum SCurvePhase : uint8_t {
+        SCURVE_CRUISE,              // Constant rate
+        SCURVE_JERK_IN,             // Acceleration building up
+        SCURVE_HOLD,                // Constant acceleration
+        SCURVE_JERK_OUT,            // Acceleration falling back to zero
+        SCURVE_CREEP                // Ramped down, creeping to the target
+    };
+
+private:
+    /**
+     * @struct Ramp
+     * @brief Trapezoidal ramp state shared between main loop and ISR
+     */
+    struct Ramp {
+        volatile long position;     // Current position (steps or events)
+        long target;                // Target position
+        volatile bool running;      // Ramp is generating steps
+        bool forward;               // Current direction of travel
+
+        long n;                     // Ramp step index (<0 while decelerating)
+        uint32_t cn;                // Current step interval (ticks << 8)
+        uint32_t cmin;              // Cruise interval (ticks << 8)
+        float acceleration;         // Ramp acceleration (steps/sec^2)
+        uint32_t scale;             // Ramp table scale for the acceleration
+        uint8_t segment;            // Ramp table segment of |n| - 1
+        long segmentStart;          // First ramp index of the segment
+        long segmentEnd;            // First ramp index of the next segment
+        uint32_t rampInterval;      // Table interval at |n| - 1 (ticks << 8)
+        uint32_t rampDelta;         // Interval decrease per step in the segment
+        uint16_t rampFraction;      // Fractional part of rampDelta (1/65536)
+        uint16_t rampError;         // Accumulated fractional decrease
+        int32_t countdown;          // Time until next step (ticks << 8)
+        long exitSteps;             // Ramp index to reach at the target
+    };
+
+    /**
+     * @struct Axis
+     * @brief Per-axis output pins and independent ramp
+     */
+    struct Axis : Ramp {
+        uint8_t stepPin;            // Step output pin
+        uint8_t dirPin;             // Direction output pin
+        bool invertDir;             // Invert direction output
+        volatile bool inBlock;      // Axis is driven by the linear block
+        volatile uint8_t limits;    // LIMIT_* of triggered limit switches
+        FastPin step;               // Step output
+        FastPin dir;                // Direction output
+        uint8_t stepSlot;           // Index into the step port table
+
+        float jerkLimit;            // Jerk setting (steps/sec^3, 0 = trapezoid)
+        float jerk;                 // Jerk of the running move (0 = trapezoid)
+        uint8_t phase;              // S-curve phase
+        bool stopping;              // S-curve: ramp down to rest now
+        bool rampUp;                // S-curve: speeding up (false: slowing down)
+        uint32_t rate;              // S-curve: current rate (steps/sec << 16)
+        uint32_t accelNow;          // S-curve: size of the acceleration (rate per tick << 16)
+        uint32_t lead;              // S-curve: rate added while accelNow falls back to 0
+        uint32_t rampEnd;           // S-curve: rate at the end of the ramp
+        uint32_t cruiseRate;        // S-curve: requested cruise rate
+        long cruiseStopSteps;       // S-curve: steps to stop from cruiseRate
+        uint32_t accelMax;          // S-curve: acceleration limit (rate per tick << 16)
+        uint32_t jerkStep;          // S-curve: acceleration change per tick << 16 (0 = trapezoid)
+        uint32_t leadMax;           // S-curve: lead at the acceleration limit
+    };
+
+    /**
+     * @struct Block
+     * @brief Running planner block: one ramp on the dominant axis,
+     * the other axes follow by integer DDA (Bresenham)
+     */
+    struct Block : Ramp {
+        uint8_t axisMask;           // Axes taking part in the move
+        long eventCount;            // Steps of the dominant axis
+        long delta[MAX_AXES];       // Absolute steps per axis
+        long error[MAX_AXES];       // DDA accumulators
+    };
+
+    Axis axes[MAX_AXES];
+    Block block;
+    uint8_t numAxes;
+
+    // Step outputs grouped by port: one write raises every due axis
+    FastPort stepPorts[MAX_AXES];
+    uint8_t stepBits[MAX_AXES];     // Pulses queued for the current interrupt
+    uint8_t numStepPorts;
+    uint8_t dirPending;             // Axes whose direction changes once the pulses drop
+
+    uint16_t currentPeriod;     // Ticks between the last two interrupts
+    bool started;
+
+public:
+    /**
+     * @brief Constructor
+     */
+    StepGenerator();
+
+    /**
+     * @brief Configure Timer1 and start the step interrupt
+     */
+    void begin();
+
+    /**
+     * @brief Register an axis
+     * @param stepPin Step output pin
+     * @param dirPin Direction output pin
+     * @return Axis index or NO_AXIS if all slots are used
+     */
+    uint8_t attachAxis(uint8_t stepPin, uint8_t dirPin);
+
+    /**
+     * @brief Configure axis output pins
+     * @param axis Axis index
+     */
+    void initAxis(uint8_t axis);
+
+    /**
+     * @brief Invert the direction output of an axis
+     * @param axis Axis index
+     * @param invert true to invert
+     */
+    void setInvertDirection(uint8_t axis, bool invert);
+
+    /**
+     * @brief Set ramp acceleration
+     * @param axis Axis index
+     * @param accel Acceleration in steps/sec^2
+     */
+    void setAcceleration(uint8_t axis, float accel);
+
+    /**
+     * @brief Set jerk limit (applies from the next move started at rest)
+     * @param axis Axis index
+     * @param jerk Jerk in steps/sec^3, 0 for trapezoidal ramps
+     */
+    void setJerk(uint8_t axis, float jerk);
+
+    /**
+     * @brief Start or retarget a move
+     * @param axis Axis index
+     * @param segment Target and cruise rate
+     * @return true if accepted (false towards a triggered limit)
+     */
+    bool submit(uint8_t axis, const MoveSegment& segment);
+
+    /**
+     * @brief Decelerate to a stop using the current ramp
+     * @param axis Axis index
+     */
+    void stop(uint8_t axis);
+
+    /**
+     * @brief Stop immediately without deceleration
+     * @param axis Axis index
+     */
+    void halt(uint8_t axis);
+
+    /**
+     * @brief Set or clear a limit (safe from a switch ISR)
+     *
+     * Setting a limit halts the axis at once if it is travelling that
+     * way (with the rest of its linear move), and later moves that way
+     * are refused until the limit is cleared.
+     * @param axis Axis index
+     * @param forward true for the positive end
+     * @param active true while the switch is triggered
+     */
+    void setLimit(uint8_t axis, bool forward, bool active);
+
+    /**
+     * @brief Check if travel in a direction is blocked
+     * @param axis Axis index
+     * @param forward true for positive travel
+     * @return true if a limit switch blocks it
+     */
+    bool isLimited(uint8_t axis, bool forward) const {
+        return axis < numAxes && (axes[axis].limits & (forward ? LIMIT_FORWARD : LIMIT_BACKWARD));
+    }
+
+    /**
+     * @brief Get current position
+     * @param axis Axis index
+     * @return Position in steps
+     */
+    long getPosition(uint8_t axis) const;
+
+    /**
+     * @brief Overwrite current position (axis must be stopped)
+     * @param axis Axis index
+     * @param position New position in steps
+     */
+    void setPosition(uint8_t axis, long position);
+
+    /**
+     * @brief Get target position
+     * @param axis Axis index
+     * @return Target in steps
+     */
+    long getTarget(uint8_t axis) const;
+
+    /**
+     * @brief Get current step rate
+     * @param axis Axis index
+     * @return Signed rate in steps/sec
+     */
+    float getRate(uint8_t axis) const;
+
+    /**
+     * @brief Check if axis is generating steps
+     * @param axis Axis index
+     * @return true if running
+     */
+    bool isRunning(uint8_t axis) const {
+        return axis < numAxes && (axes[axis].running || axes[axis].inBlock);
+    }
+
+    /**
+     * @brief Timer compare handler (called from the ISR)
+     */
+    void handleInterrupt();
+
+    /**
+     * @brief Get the programmed timer period
+     * @return Ticks from the last interrupt to the next
+     */
+    uint16_t getTimerPeriod() const { return currentPeriod; }
+
+    /**
+     * @brief Time step-style output writes: digitalWrite() per pin
+     * against grouped port writes
+     *
+     * Toggles the direction outputs (same ports as the step outputs)
+     * so no steps are emitted. Only runs while all axes are idle.
+     * @param iterations Number of high/low cycles over all axes
+     * @param pinMicros Time taken with digitalWrite()
+     * @param portMicros Time taken with port writes
+     * @return false if an axis is moving
+     */
+    bool benchmarkOutput(uint16_t iterations, uint32_t& pinMicros, uint32_t& portMicros);
+
+    /**
+     * @brief Convert a step rate to an interval
+     * @param rate Steps/sec
+     * @return Interval in ticks << 8
+     */
+    static uint32_t rateToInterval(float rate);
+
+    /**
+     * @brief Ramp table scale for an acceleration
+     * @param accel Acceleration in steps/sec^2
+     * @return Scale (STEP_TIMER_FREQUENCY * 16 / sqrt(accel))
+     */
+    static uint32_t accelerationToScale(float accel);
+
+private:
+    /**
+     * @brief Start a stopped ramp towards its target
+     * @param r Ramp state
+     */
+    static void startRamp(Ramp& r);
+
+    /**
+     * @brief Compute interval to the next step after a pulse
+     * @param r Ramp state
+     * @return true if the direction of travel changed
+     */
+    static bool computeNextInterval(Ramp& r);
+
+    /**
+     * @brief Set ramp acceleration
+     * @param r Ramp state
+     * @param accel Acceleration in steps/sec^2 (at least STEP_MIN_ACCELERATION)
+     * @param scale Matching ramp table scale
+     */
+    static void setRampAcceleration(Ramp& r, float accel, uint32_t scale);
+
+    /**
+     * @brief Position the ramp table at a ramp index
+     * @param r Ramp state
+     * @param index Ramp index (|n| - 1)
+     */
+    static void seekRamp(Ramp& r, long index);
+
+    /**
+     * @brief Load a ramp table segment
+     * @param r Ramp state
+     * @param segment Segment number
+     * @param offset Ramp index relative to the segment start
+     */
+    static void loadRampSegment(Ramp& r, uint8_t segment, long offset);
+
+    /**
+     * @brief Move the ramp table one index up (faster)
+     * @param r Ramp state
+     */
+    static void advanceRamp(Ramp& r);
+
+    /**
+     * @brief Move the ramp table one index down (slower)
+     * @param r Ramp state
+     */
+    static void retreatRamp(Ramp& r);
+
+    /**
+     * @brief Start or retarget an S-curve move
+     * @param a Axis state
+     * @param segment Target and cruise rate
+     * @param cmin Cruise interval (ticks << 8)
+     * @return true if accepted
+     */
+    bool submitSCurve(Axis& a, const MoveSegment& segment, uint32_t cmin);
+
+    /**
+     * @brief Convert S-curve limits to fixed point increments
+     * @param accel Acceleration limit in steps/sec^2
+     * @param jerk Jerk in steps/sec^3
+     * @param accelMax Acceleration limit (rate per tick << 16)
+     * @param jerkStep Acceleration change per tick << 16
+     * @param leadMax Rate added while the acceleration falls from the limit to 0
+     */
+    static void scurveIncrements(float accel, float jerk, uint32_t& accelMax,
+                                 uint32_t& jerkStep, uint32_t& leadMax);
+
+    /**
+     * @brief Begin an S-curve ramp from the current rate
+     * @param a Axis state
+     * @param endRate Rate at the end of the ramp (steps/sec << 16)
+     */
+    static void beginSCurveRamp(Axis& a, uint32_t endRate);
+
+    /**
+     * @brief Highest rate an S-curve move of a given length can reach
+     * @param distance Move length in steps
+     * @param accel Acceleration limit in steps/sec^2
+     * @param jerk Jerk limit in steps/sec^3
+     * @return Peak rate in steps/sec
+     */
+    static float scurvePeakRate(long distance, float accel, float jerk);
+
+    /**
+     * @brief Compute S-curve interval to the next step after a pulse
+     * @param a Axis state
+     */
+    static void computeSCurveInterval(Axis& a);
+
+    /**
+     * @brief Steps needed to stop from a rate with an S-curve
+     * @param rate Rate in steps/sec
+     * @param accel Acceleration limit in steps/sec^2
+     * @param jerk Jerk limit in steps/sec^3
+     * @return Distance in steps
+     */
+    static long scurveStopSteps(float rate, float accel, float jerk);
+
+    /**
+     * @brief Start the next planner block
+     * @param carry true to enter at the planned junction rate
+     * @return true if a block was started
+     */
+    bool startBlock(bool carry);
+
+    /**
+     * @brief Advance the linear block by one step event
+     */
+    void stepBlock();
+
+    /**
+     * @brief Release the axes of a finished or halted block
+     */
+    void releaseBlock();
+
+    /**
+     * @brief Queue one step pulse for this interrupt
+     * @param a Axis state
+     */
+    void pulse(Axis& a);
+
+    /**
+     * @brief Raise all queued step outputs
+     */
+    void raiseSteps();
+
+    /**
+     * @brief Lower the step outputs raised by raiseSteps()
+     */
+    void lowerSteps();
+
+    /**
+     * @brief Write the directions that changed during this interrupt
+     *
+     * Called after lowerSteps(), so DIR never changes while a STEP output
+     * is high and is set up a full period before the next rising edge.
+     */
+    void latchDirections();
+
+    /**
+     * @brief Write direction output (interrupts disabled or from the ISR)
+     * @param a Axis state
+     */
+    void writeDirection(Axis& a);
+};
+
+// Global step generator instance
+extern StepGenerator stepGenerator;
+
+#endif // STEP_GENERATOR_H
@@ -0,0 +1,175 @@
+/**
+ * @file FastIO.h
+ * @brief Direct port register access for Arduino Mega pins
+ *
+ * digitalWrite() looks the pin up in flash tables and disables
+ * interrupts on every call, which costs several microseconds. For the
+ * step, direction and enable outputs the pin number is resolved once to
+ * a PORT register and bit mask; the constexpr pin tables fold to
+ * constants when the pin is a compile-time value (PinDefinitions.h).
+ * Outputs on the same port can then be written with a single access.
+ *
+ * Other boards (and host builds) fall back to digitalWrite() with one
+ * "port" per pin.
+ */
+
+#ifndef FAST_IO_H
+#define FAST_IO_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+
+#if defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+#define FASTIO_DIRECT 1
+#else
+#define FASTIO_DIRECT 0
+#endif
+
+/**
+ * @brief Port letter of a Mega 2560 digital pin
+ * @param pin Arduino pin number (0-69)
+ * @return 'A' to 'L', or 0 for an invalid pin
+ */
+constexpr char fastPinPort(uint8_t pin) {
+    return (pin <= 3 || pin == 5) ? 'E' :
+           (pin == 4) ? 'G' :
+           (pin <= 9 || pin == 16 || pin == 17) ? 'H' :
+           (pin <= 13) ? 'B' :
+           (pin <= 15) ? 'J' :
+           (pin <= 21) ? 'D' :
+           (pin <= 29) ? 'A' :
+           (pin <= 37) ? 'C' :
+           (pin == 38) ? 'D' :
+           (pin <= 41) ? 'G' :
+           (pin <= 49) ? 'L' :
+           (pin <= 53) ? 'B' :
+           (pin <= 61) ? 'F' :
+           (pin <= 69) ? 'K' : 0;
+}
+
+/**
+ * @brief Port bit of a Mega 2560 digital pin
+ * @param pin Arduino pin number (0-69)
+ * @return Bit number within the port
+ */
+constexpr uint8_t fastPinBit(uint8_t pin) {
+    return (pin == 0) ? 0 : (pin == 1) ? 1 : (pin == 2) ? 4 : (pin == 3) ? 5 :
+           (pin == 4) ? 5 : (pin == 5) ? 3 : (pin == 6) ? 3 : (pin == 7) ? 4 :
+           (pin == 8) ? 5 : (pin == 9) ? 6 :
+           (pin <= 13) ? pin - 6 :                 // PB4-PB7
+           (pin == 14) ? 1 : (pin == 15) ? 0 :
+           (pin == 16) ? 1 : (pin == 17) ? 0 :
+           (pin <= 21) ? 21 - pin :                // PD3-PD0
+           (pin <= 29) ? pin - 22 :                // PA0-PA7
+           (pin <= 37) ? 37 - pin :                // PC7-PC0
+           (pin == 38) ? 7 :
+           (pin <= 41) ? 41 - pin :                // PG2-PG0
+           (pin <= 49) ? 49 - pin :                // PL7-PL0
+           (pin <= 53) ? 53 - pin :                // PB3-PB0
+           (pin <= 61) ? pin - 54 :                // PF0-PF7
+           pin - 62;                               // PK0-PK7
+}
+
+/**
+ * @brief Port bit mask of a Mega 2560 digital pin
+ * @param pin Arduino pin number (0-69)
+ * @return Mask with the pin's bit set
+ */
+constexpr uint8_t fastPinMask(uint8_t pin) {
+    return (uint8_t)(1 << fastPinBit(pin));
+}
+
+#if FASTIO_DIRECT
+typedef volatile uint8_t* FastPort;    // PORT output register
+
+/**
+ * @brief PORT output register of a pin
+ * @param pin Arduino pin number
+ * @return Register or nullptr for an invalid pin
+ */
+inline FastPort fastPortOf(uint8_t pin) {
+    switch (fastPinPort(pin)) {
+        case 'A': return &PORTA;
+        case 'B': return &PORTB;
+        case 'C': return &PORTC;
+        case 'D': return &PORTD;
+        case 'E': return &PORTE;
+        case 'F': return &PORTF;
+        case 'G': return &PORTG;
+        case 'H': return &PORTH;
+        case 'J': return &PORTJ;
+        case 'K': return &PORTK;
+        case 'L': return &PORTL;
+        default:  return nullptr;
+    }
+}
+
+/**
+ * @brief Bit mask of a pin within its port
+ * @param pin Arduino pin number
+ * @return Bit mask
+ */
+inline uint8_t fastMaskOf(uint8_t pin) { return fastPinMask(pin); }
+
+/**
+ * @brief Set output bits (call with interrupts disabled or from an ISR)
+ */
+inline void fastSetBits(FastPort port, uint8_t mask) { *port |= mask; }
+
+/**
+ * @brief Clear output bits (call with interrupts disabled or from an ISR)
+ */
+inline void fastClearBits(FastPort port, uint8_t mask) { *port &= (uint8_t)~mask; }
+#else
+typedef uint8_t FastPort;              // Pin number, one pin per "port"
+
+inline FastPort fastPortOf(uint8_t pin) { return pin; }
+inline uint8_t fastMaskOf(uint8_t pin) { (void)pin; return 1; }
+inline void fastSetBits(FastPort port, uint8_t mask) { if (mask) digitalWrite(port, HIGH); }
+inline void fastClearBits(FastPort port, uint8_t mask) { if (mask) digitalWrite(port, LOW); }
+#endif
+
+/**
+ * @struct FastPin
+ * @brief Output pin resolved to its port and mask
+ */
+struct FastPin {
+    FastPort port;
+    uint8_t mask;
+
+    /**
+     * @brief Resolve a pin (pinMode() is left to the caller)
+     * @param pin Arduino pin number
+     */
+    void attach(uint8_t pin) {
+        port = fastPortOf(pin);
+        mask = fastMaskOf(pin);
+    }
+
+    /**
+     * @brief Write the pin from an ISR or with interrupts disabled
+     * @param high true for HIGH
+     */
+    void writeFromISR(bool high) const {
+        if (high) {
+            fastSetBits(port, mask);
+        } else {
+            fastClearBits(port, mask);
+        }
+    }
+
+    /**
+     * @brief Write the pin from the main loop
+     *
+     * The port is shared with outputs the step interrupt writes, so the
+     * read-modify-write runs with interrupts disabled.
+     * @param high true for HIGH
+     */
+    void write(bool high) const {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            writeFromISR(high);
+        }
+    }
+};
+
+#endif // FAST_IO_H
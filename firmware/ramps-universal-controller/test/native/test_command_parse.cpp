@@ -0,0 +1,142 @@
+/**
+ * @file test_command_parse.cpp
+ * @brief Host test of Command::parse: fields, reuse, limits, heap use, speed
+ *
+ * Parsing must not touch the heap; every operator new on the host is
+ * counted while the sample commands are parsed. The parse time per
+ * command is printed for comparison with SERVICE PARSE_BENCHMARK on the
+ * board.
+ */
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <Arduino.h>
+#include "core/Command.h"
+
+static unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const uint32_t BENCHMARK_ITERATIONS = 200000;
+
+// Same samples as SERVICE PARSE_BENCHMARK
+static const char* const samples[] = {
+    ">X position 3.14",
+    ">STEPPERS move 1.0 0.5 0.2 2.0",
+    ">MainLight ON",
+    ">XMin state?",
+    ">CONTROLLER STATUS"
+};
+static const uint8_t numSamples = sizeof(samples) / sizeof(samples[0]);
+
+static void testFields() {
+    Command cmd;
+    CHECK(cmd.parse("#42 >X position? 3.14"));
+    CHECK(cmd.hasSequence() && cmd.getSequence() == 42);
+    CHECK(cmd.isDevice("X") && cmd.isInterface("position"));
+    CHECK(cmd.getIsQuery());
+    CHECK(cmd.getCommandType() == CommandType::POSITION);
+    CHECK(cmd.getParamCount() == 1 && cmd.getParam(0) == 3.14f);
+
+    CHECK(cmd.parse(">STEPPERS move 1 2 3 4"));
+    CHECK(cmd.getIsBulk() && cmd.getCommandType() == CommandType::MOVE);
+    CHECK(cmd.getParamCount() == 4 && cmd.getParam(3) == 4.0f);
+
+    CHECK(cmd.parse(">D10 on"));
+    CHECK(cmd.getCommandType() == CommandType::ON);
+}
+
+static void testReuse() {
+    // Nothing of a tagged multi-value query may leak into the next parse
+    Command cmd;
+    CHECK(cmd.parse("#7 >STEPPERS move 1 2 3 4"));
+    CHECK(cmd.parse(">X enable"));
+    CHECK(!cmd.hasSequence() && cmd.getSequence() == 0);
+    CHECK(!cmd.getIsQuery() && !cmd.getIsBulk());
+    CHECK(cmd.getParamCount() == 0 && cmd.getValue()[0] == '\0');
+    CHECK(cmd.getCommandType() == CommandType::ENABLE);
+
+    CHECK(cmd.parse(">X position?"));
+    CHECK(cmd.parse(">X speed"));
+    CHECK(!cmd.getIsQuery());
+
+    // A failed parse leaves an invalid command, not the previous one
+    CHECK(cmd.parse(">X position 1"));
+    CHECK(!cmd.parse("   "));
+    CHECK(!cmd.isValid() && cmd.getParamCount() == 0);
+}
+
+static void testLimits() {
+    Command cmd;
+    CHECK(cmd.parse(">STEPPERS move 1 2 3 4  "));
+    CHECK(!cmd.parse(">STEPPERS move 1 2 3 4 5"));
+    CHECK(!cmd.parse("#3 >X position 1 2 3 4 5 6 7 8"));
+    CHECK(cmd.hasSequence() && cmd.getSequence() == 3);
+
+    char longLine[COMMAND_BUFFER_SIZE + 1];
+    memset(longLine, 'A', COMMAND_BUFFER_SIZE);
+    longLine[COMMAND_BUFFER_SIZE] = '\0';
+    CHECK(!cmd.parse(longLine));
+}
+
+static void testNoAllocation() {
+    Command cmd;
+    unsigned long before = allocations;
+    for (uint8_t i = 0; i < numSamples; i++) {
+        cmd.parse(samples[i]);
+    }
+    unsigned long used = allocations - before;
+    printf("  heap allocations while parsing: %lu\n", used);
+    CHECK(used == 0);
+}
+
+static void benchmark() {
+    Command cmd;
+    bool parsed = true;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCHMARK_ITERATIONS; n++) {
+        for (uint8_t i = 0; i < numSamples; i++) {
+            parsed &= cmd.parse(samples[i]);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    printf("  parse: %.1f ns/command (host)\n", ns / ((double)BENCHMARK_ITERATIONS * numSamples));
+    CHECK(parsed);
+}
+
+int main() {
+    testFields();
+    testReuse();
+    testLimits();
+    testNoAllocation();
+    benchmark();
+    return failures ? 1 : 0;
+}
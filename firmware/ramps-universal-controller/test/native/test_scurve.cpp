@@ -0,0 +1,188 @@
+/**
+ * @file test_scurve.cpp
+ * @brief Host test of the fixed point S-curve ramps
+ *
+ * Drives StepGenerator::handleInterrupt() directly, advancing time by
+ * the period it programs, and checks the step times: the reciprocal
+ * table, the rate, acceleration and jerk limits, and that retargeted
+ * and stopped moves end where they should.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include <Arduino.h>
+#include "motion/StepGenerator.h"
+#include "motion/RateTable.h"
+#include "PinDefinitions.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const float ACCEL = 4000.0;      // steps/sec^2
+static const float JERK = 40000.0;      // steps/sec^3
+static const float RATE = 1000.0;       // steps/sec
+static const double TICK = 1.0 / STEP_TIMER_FREQUENCY;
+
+static uint8_t axis;
+
+/**
+ * @brief Run the interrupt until the axis stops
+ * @param stepTimes Filled with the time of every step (seconds)
+ * @param atStep Step count at which to call action (0: never)
+ * @param action Called once from the "main loop" at that step
+ */
+static void run(std::vector<double>& stepTimes, size_t atStep = 0, void (*action)() = nullptr) {
+    stepTimes.clear();
+    double now = 0.0;
+    long position = stepGenerator.getPosition(axis);
+    for (uint32_t i = 0; i < 10000000UL; i++) {
+        stepGenerator.handleInterrupt();
+        long next = stepGenerator.getPosition(axis);
+        if (next != position) {
+            stepTimes.push_back(now);
+            position = next;
+            if (action && stepTimes.size() == atStep) action();
+        }
+        if (!stepGenerator.isRunning(axis)) return;
+        now += stepGenerator.getTimerPeriod() * TICK;
+    }
+}
+
+/**
+ * @brief Peak rate, acceleration and jerk of a step list
+ *
+ * Rates over 16-step windows, so the 0.5 us timer resolution stays well
+ * below the limits checked.
+ */
+static void profile(const std::vector<double>& t, double& peakRate, double& peakAccel, double& peakJerk) {
+    const size_t w = 16;
+    std::vector<double> time, rate;
+    for (size_t i = w; i < t.size(); i += w) {
+        time.push_back((t[i] + t[i - w]) / 2.0);
+        rate.push_back(w / (t[i] - t[i - w]));
+    }
+    std::vector<double> accelTime, accel;
+    peakRate = peakAccel = peakJerk = 0.0;
+    for (size_t i = 0; i < rate.size(); i++) {
+        if (rate[i] > peakRate) peakRate = rate[i];
+        if (i == 0) continue;
+        accelTime.push_back((time[i] + time[i - 1]) / 2.0);
+        accel.push_back((rate[i] - rate[i - 1]) / (time[i] - time[i - 1]));
+        if (fabs(accel.back()) > peakAccel) peakAccel = fabs(accel.back());
+        if (accel.size() < 2) continue;
+        size_t k = accel.size() - 1;
+        double jerk = (accel[k] - accel[k - 1]) / (accelTime[k] - accelTime[k - 1]);
+        if (fabs(jerk) > peakJerk) peakJerk = fabs(jerk);
+    }
+}
+
+static bool moveTo(long target) {
+    MoveSegment segment;
+    segment.target = target;
+    segment.maxRate = RATE;
+    return stepGenerator.submit(axis, segment);
+}
+
+static void testRateTable() {
+    // Every rate the S-curve uses, 100 steps/sec up past STEP_MAX_RATE
+    double worst = 0.0;
+    for (double rate = 100.0; rate < 40000.0; rate *= 1.0007) {
+        uint32_t fixed = (uint32_t)(rate * 65536.0);
+        double exact = STEP_TIMER_FREQUENCY * 256.0 * 65536.0 / fixed;
+        double error = fabs(rateTableInterval(fixed) - exact) / exact;
+        if (error > worst) worst = error;
+    }
+    printf("  rate table: max interval error %.2e\n", worst);
+    CHECK(worst < 1e-4);
+}
+
+static void testFullMove() {
+    std::vector<double> t;
+    stepGenerator.setPosition(axis, 0);
+    CHECK(moveTo(4000));
+    run(t);
+
+    double peakRate, peakAccel, peakJerk;
+    profile(t, peakRate, peakAccel, peakJerk);
+    printf("  4000 steps: %.3f s, peak %.1f steps/s, %.0f steps/s^2, %.0f steps/s^3\n",
+           t.back(), peakRate, peakAccel, peakJerk);
+    CHECK(stepGenerator.getPosition(axis) == 4000);
+    CHECK(peakRate < RATE * 1.01 && peakRate > RATE * 0.99);
+    CHECK(peakAccel < ACCEL * 1.1 && peakAccel > ACCEL * 0.9);
+    CHECK(peakJerk < JERK * 1.5);
+
+    // Cruise 4000 steps at RATE plus two ramps of RATE/ACCEL + ACCEL/JERK each
+    double expected = 4000.0 / RATE + RATE / ACCEL + ACCEL / JERK;
+    CHECK(fabs(t.back() - expected) < 0.05 * expected);
+}
+
+static void testShortMove() {
+    // Too short to reach the acceleration limit or the cruise rate
+    std::vector<double> t;
+    stepGenerator.setPosition(axis, 0);
+    CHECK(moveTo(-60));
+    run(t);
+
+    double peakRate, peakAccel, peakJerk;
+    profile(t, peakRate, peakAccel, peakJerk);
+    CHECK(stepGenerator.getPosition(axis) == -60);
+    CHECK(peakRate < RATE);
+    CHECK(peakAccel < ACCEL * 1.1);
+}
+
+static void retargetCloser() {
+    moveTo(1200);
+}
+
+static void stopNow() {
+    stepGenerator.stop(axis);
+}
+
+static void testRetarget() {
+    // Target moved in while accelerating: level off, then ramp down to it
+    std::vector<double> t;
+    stepGenerator.setPosition(axis, 0);
+    CHECK(moveTo(4000));
+    run(t, 150, retargetCloser);
+
+    double peakRate, peakAccel, peakJerk;
+    profile(t, peakRate, peakAccel, peakJerk);
+    CHECK(stepGenerator.getPosition(axis) == 1200);
+    CHECK(peakAccel < ACCEL * 1.1);
+}
+
+static void testStop() {
+    std::vector<double> t;
+    stepGenerator.setPosition(axis, 0);
+    CHECK(moveTo(4000));
+    run(t, 1500, stopNow);
+
+    // Stopping distance from RATE: RATE * (RATE / ACCEL + ACCEL / JERK) / 2
+    long stopSteps = stepGenerator.getPosition(axis) - 1500;
+    double expected = RATE * (RATE / ACCEL + ACCEL / JERK) / 2.0;
+    printf("  stop from cruise: %ld steps (%.0f expected)\n", stopSteps, expected);
+    CHECK(fabs(stopSteps - expected) < 0.1 * expected + 5);
+    CHECK(stepGenerator.getTarget(axis) == stepGenerator.getPosition(axis));
+}
+
+int main() {
+    axis = stepGenerator.attachAxis(X_STEP_PIN, X_DIR_PIN);
+    stepGenerator.initAxis(axis);
+    stepGenerator.setAcceleration(axis, ACCEL);
+    stepGenerator.setJerk(axis, JERK);
+
+    testRateTable();
+    testFullMove();
+    testShortMove();
+    testRetarget();
+    testStop();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_thermal_plant.cpp
+ * @brief Host test of the heater loop against the ThermalPlant model
+ *
+ * The plant's sensor temperature is turned into the ADC reading of the
+ * configured thermistor and fed to the simulated analog input, so the
+ * loop sees it through AdcSampler and the thermistor table like on the
+ * board. The heater duty comes back from the PWM the MosfetOutput writes.
+ * Checks that a relay autotune finishes with usable gains and that the
+ * PID step response with those gains settles on the setpoint.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <Arduino.h>
+#include <NativeHal.h>
+#include "control/HeaterLoop.h"
+#include "control/ThermalPlant.h"
+#include "devices/sensors/AnalogSensor.h"
+#include "devices/actuators/MosfetOutput.h"
+#include "DeviceConfig.h"
+#include "PinDefinitions.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const float TARGET = 200.0;             // °C
+static const unsigned long SIMULATION_STEP = 10; // ms
+
+static AnalogSensor* sensor;
+static MosfetOutput* heater;
+static HeaterLoop heaterLoop;
+static ThermalPlant plant;
+
+/**
+ * @brief ADC reading of the thermistor divider at a temperature
+ */
+static int adcReading(float celsius) {
+    float resistance = ANALOG_0_THERMISTOR_R25 *
+                       exp(ANALOG_0_THERMISTOR_BETA * (1.0 / (celsius + 273.15) - 1.0 / 298.15));
+    return (int)lround(ANALOG_MAX_VALUE * resistance / (resistance + ANALOG_0_R_PULLUP));
+}
+
+/**
+ * @brief Advance plant and firmware together
+ * @param ms Time to simulate
+ * @param peak Highest sensor temperature seen (updated)
+ * @param stopWhenFinished Return early when an autotune run ends
+ * @return true if an autotune run ended
+ */
+static bool simulate(unsigned long ms, float& peak, bool stopWhenFinished = false) {
+    for (unsigned long t = 0; t < ms; t += SIMULATION_STEP) {
+        NativeHal::setAnalog(ANALOG_0_PIN, adcReading(plant.getTemperature()));
+        NativeHal::advance(SIMULATION_STEP * 1000000ULL);
+        sensor->update();
+        bool finished = heaterLoop.update(millis());
+        heater->update();
+        plant.step(NativeHal::getPwm(MOSFET_A_PIN) / 255.0, SIMULATION_STEP / 1000.0);
+        if (plant.getTemperature() > peak) peak = plant.getTemperature();
+        if (finished && stopWhenFinished) return true;
+    }
+    return false;
+}
+
+static void testAutotune() {
+    float peak = 0.0;
+    CHECK(heaterLoop.startAutotune(TARGET));
+    bool finished = simulate(AUTOTUNE_TIMEOUT_MS, peak, true);
+
+    const RelayAutotune& tune = heaterLoop.getAutotune();
+    printf("  autotune: %s after %.0f s, Kp %.4f Ki %.5f Kd %.4f, peak %.1f C\n",
+           tune.getState() == AutotuneState::DONE ? "DONE" : "FAILED", millis() / 1000.0,
+           tune.getKp(), tune.getKi(), tune.getKd(), peak);
+    CHECK(finished && tune.getState() == AutotuneState::DONE);
+    CHECK(tune.getKp() > 0.0 && tune.getKi() > 0.0 && tune.getKd() > 0.0);
+    CHECK(peak < TARGET + AUTOTUNE_MAX_OVERSHOOT);
+    CHECK(heaterLoop.getPid().getKp() == tune.getKp());
+    CHECK(heaterLoop.getDuty() == 0.0);
+}
+
+static void testStepResponse() {
+    // Cool back to ambient with the heater off, then step to TARGET
+    float peak = 0.0;
+    simulate(1800000UL, peak);
+    CHECK(plant.getTemperature() < 40.0);
+
+    peak = 0.0;
+    unsigned long start = millis();
+    CHECK(heaterLoop.setTarget(TARGET));
+    unsigned long reached = 0;
+    for (unsigned long t = 0; t < 300000UL && !reached; t += 1000) {
+        simulate(1000, peak);
+        if (plant.getTemperature() >= TARGET - THERMAL_HYSTERESIS) reached = millis() - start;
+    }
+    simulate(300000UL, peak);
+
+    // Last minute: hold the setpoint
+    float low = 1000.0, high = -1000.0;
+    for (int i = 0; i < 60; i++) {
+        float ignored = 0.0;
+        simulate(1000, ignored);
+        if (plant.getTemperature() < low) low = plant.getTemperature();
+        if (plant.getTemperature() > high) high = plant.getTemperature();
+    }
+    printf("  step to %.0f C: within %.0f C after %.1f s, overshoot %.1f C, holds %.1f-%.1f C\n",
+           TARGET, THERMAL_HYSTERESIS, reached / 1000.0, peak - TARGET, low, high);
+    CHECK(reached > 0);
+    CHECK(peak < TARGET + THERMAL_HYSTERESIS);
+    CHECK(low > TARGET - 1.0 && high < TARGET + 1.0);
+    CHECK(heaterLoop.getFault() == ThermalFault::NONE);
+}
+
+int main() {
+    static AnalogSensor analog0(ANALOG_0_NAME, ANALOG_0_PIN, ANALOG_0_MODE);
+    static uint16_t analog0Table[THERMISTOR_TABLE_SIZE];
+    static MosfetOutput mosfetA(MOSFET_A_NAME, MOSFET_A_PIN, MOSFET_A_PWM);
+    sensor = &analog0;
+    heater = &mosfetA;
+    analog0.configureThermistor(ANALOG_0_R_PULLUP, ANALOG_0_THERMISTOR_R25, ANALOG_0_THERMISTOR_BETA, analog0Table);
+    CHECK(sensor->init() && heater->init());
+    heaterLoop.attach(sensor, heater, HEATER_0_MAX_POWER);
+
+    testAutotune();
+    testStepResponse();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_thermistor.cpp
+ * @brief Host test of the thermistor table against the Beta equation
+ *
+ * Sweeps every ADC reading through the simulated analog input and the
+ * sensor's sampler, and compares the temperature it reports with the
+ * Beta equation for the configured divider, evaluated here in double
+ * precision. The table must agree to within MAX_ERROR over its range
+ * and report -999 outside it.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <Arduino.h>
+#include <NativeHal.h>
+#include "devices/sensors/AnalogSensor.h"
+#include "DeviceConfig.h"
+#include "PinDefinitions.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const double MAX_ERROR = 0.25;          // °C, see THERMISTOR_TABLE_STEP
+
+static AnalogSensor* sensor;
+
+/**
+ * @brief Beta equation for a thermistor below the pullup
+ * @return Temperature (°C) at an ADC reading
+ */
+static double betaTemperature(double raw) {
+    double resistance = ANALOG_0_R_PULLUP * raw / (ANALOG_MAX_VALUE - raw);
+    double kelvin = 1.0 / (1.0 / 298.15 + log(resistance / ANALOG_0_THERMISTOR_R25) / ANALOG_0_THERMISTOR_BETA);
+    return kelvin - 273.15;
+}
+
+/**
+ * @brief Feed one reading until the sampler's average is made of it
+ */
+static float readAt(int raw) {
+    NativeHal::setAnalog(ANALOG_0_PIN, raw);
+    for (uint8_t i = 0; i < ANALOG_SAMPLES; i++) {
+        sensor->update();
+    }
+    return sensor->getValue();
+}
+
+static void testSweep() {
+    double worst = 0.0;
+    int worstRaw = 0;
+    int inTable = 0;
+    for (int raw = 1; raw < ANALOG_MAX_VALUE; raw++) {
+        double exact = betaTemperature(raw);
+        float reported = readAt(raw);
+        if (exact < THERMISTOR_TABLE_MIN || exact > THERMISTOR_TABLE_MAX) {
+            // Beyond the table: an open/shorted sensor or an unusable reading
+            if (reported != -999.0 && fabs(reported - exact) > MAX_ERROR) {
+                printf("  raw %d: %.2f C outside the table, expected -999\n", raw, reported);
+                failures++;
+            }
+            continue;
+        }
+        inTable++;
+        double error = fabs(reported - exact);
+        if (error > worst) {
+            worst = error;
+            worstRaw = raw;
+        }
+    }
+    printf("  %d readings in the table: max error %.3f C (raw %d, %.1f C)\n",
+           inTable, worst, worstRaw, betaTemperature(worstRaw));
+    CHECK(inTable > 900);
+    CHECK(worst < MAX_ERROR);
+
+    // Readings only go one way with temperature, and the ends are errors
+    CHECK(readAt(200) > readAt(400) && readAt(400) > readAt(800));
+    CHECK(readAt(0) == -999.0);
+    CHECK(readAt(ANALOG_MAX_VALUE) == -999.0);
+}
+
+static void testBenchmark() {
+    // SERVICE THERMISTOR_BENCHMARK reports the same bound from the board
+    uint32_t tableMicros, exactMicros;
+    float maxError;
+    CHECK(sensor->benchmarkThermistor(THERMISTOR_BENCHMARK_ITERATIONS, tableMicros, exactMicros, maxError));
+    printf("  benchmark: max error %.3f C\n", maxError);
+    CHECK(maxError < MAX_ERROR);
+}
+
+int main() {
+    static AnalogSensor analog0(ANALOG_0_NAME, ANALOG_0_PIN, ANALOG_0_MODE);
+    static uint16_t analog0Table[THERMISTOR_TABLE_SIZE];
+    sensor = &analog0;
+    analog0.configureThermistor(ANALOG_0_R_PULLUP, ANALOG_0_THERMISTOR_R25, ANALOG_0_THERMISTOR_BETA, analog0Table);
+    CHECK(sensor->init());
+
+    testSweep();
+    testBenchmark();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,396 @@
+#!/usr/bin/env python3
+"""Regression tests on the native build (simulated board, lib/ArduinoNative).
+
+  test/run_native.py                 Build, then run every test
+  test/run_native.py -k window       Only tests whose name contains "window"
+  test/run_native.py --list          List the tests
+  test/run_native.py --update-traces Record the golden step traces again
+
+Two kinds of tests run here:
+
+  scenario  A command script piped through the firmware program; the test
+            checks the replies (and traces) it produces.
+  host      test/native/test_*.cpp, each built with the firmware sources
+            (without main.cpp) into its own program; exit status 0 passes.
+
+Builds go to .pio/build/native-test. The exit status is the number of
+failed tests.
+
+Golden traces (test/traces/*.ptrc) pin down the step timing of a few
+canonical moves; test_golden_traces records the moves again and runs
+`steptrace.py compare` against them. After a deliberate timing change,
+check the new timing with `steptrace.py compare`, then record the traces
+again (--update-traces) and commit them with the change.
+"""
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BUILD = os.path.join(ROOT, ".pio", "build", "native-test")
+TOOLS = os.path.join(ROOT, "tools")
+TRACES = os.path.join(ROOT, "test", "traces")
+PROGRAM = os.path.join(BUILD, "program")
+
+CXX = os.environ.get("CXX", "g++")
+CXXFLAGS = ["-std=gnu++17", "-O1", "-DNATIVE_BUILD",
+            "-I" + os.path.join(ROOT, "lib", "ArduinoNative", "src"),
+            "-I" + os.path.join(ROOT, "include"), "-I" + os.path.join(ROOT, "src")]
+
+# Min endstops float high (triggered) on the simulated board
+ENDSTOPS_OPEN = ["--input", "3=0", "--input", "14=0", "--input", "18=0"]
+
+
+def config_value(name):
+    """Read a numeric #define from include/Config.h."""
+    with open(os.path.join(ROOT, "include", "Config.h")) as f:
+        match = re.search(r"^#define\s+%s\s+(\d+)" % name, f.read(), re.M)
+    return int(match.group(1))
+
+
+def sources(with_main):
+    files = [f for f in glob.glob(os.path.join(ROOT, "src", "**", "*.cpp"), recursive=True)
+             if with_main or os.path.basename(f) != "main.cpp"]
+    hal = [f for f in glob.glob(os.path.join(ROOT, "lib", "ArduinoNative", "src", "*.cpp"))
+           if with_main or os.path.basename(f) != "NativeMain.cpp"]
+    return sorted(files) + sorted(hal)
+
+
+def compile_program(output, extra_sources, with_main):
+    os.makedirs(os.path.dirname(output), exist_ok=True)
+    command = [CXX] + CXXFLAGS + extra_sources + sources(with_main) + ["-o", output]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        raise RuntimeError("build of %s failed:\n%s" % (os.path.basename(output), result.stdout))
+
+
+def run_script(lines, args=(), linger_ms=1000):
+    """Pipe command lines through the firmware; return (stdout, stderr)."""
+    script = "".join(line + "\n" for line in lines)
+    result = subprocess.run([PROGRAM, "--linger-ms", str(linger_ms)] + list(args),
+                            input=script, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            text=True, timeout=120)
+    return result.stdout, result.stderr
+
+
+def tagged_replies(output):
+    """Map tag -> list of reply lines."""
+    replies = {}
+    for line in output.splitlines():
+        match = re.match(r"^#(\d+) (.*)$", line.rstrip("\r"))
+        if match:
+            replies.setdefault(int(match.group(1)), []).append(match.group(2))
+    return replies
+
+
+# ============================================
+# Scenario tests
+# ============================================
+
+def test_receive_window_burst():
+    """Commands beyond the window get a busy reply, none are lost.
+
+    A long reply (CONTROLLER LIST) backs up the output while more than
+    COMMAND_WINDOW tagged commands arrive in one burst.
+    """
+    window = config_value("COMMAND_WINDOW")
+    commands = ["CONTROLLER LIST", "STEPPERS enable", "X position 1", "STEPPERS move 1 1 1",
+                "CONTROLLER window?", "CONTROLLER PING", "T0 read", "XMin state?"]
+    while len(commands) < 3 * window:
+        commands.append("CONTROLLER PING")
+    lines = ["#%d >%s" % (tag, command) for tag, command in enumerate(commands, 1)]
+
+    output, errors = run_script(lines, ENDSTOPS_OPEN)
+    replies = tagged_replies(output)
+
+    failures = []
+    busy = 0
+    for tag in range(1, len(lines) + 1):
+        got = replies.get(tag, [])
+        if len(got) != 1:
+            failures.append("#%d: %d replies %r" % (tag, len(got), got))
+        elif got[0].startswith("ERROR") and "Receive window full" in got[0]:
+            busy += 1
+    if "RX overruns" in errors:
+        failures.append(errors.strip())
+    if busy == 0:
+        failures.append("no command was rejected as busy; the burst did not exceed the window")
+    return failures
+
+
+def test_estop_bypasses_receive_window():
+    """ESTOP runs on arrival, with the window full and the output backed up.
+
+    CONTROLLER LIST backs up the output and the PINGs fill the window, so
+    a queued ESTOP would be rejected as busy. It must be answered before
+    the PINGs queued ahead of it, which are then refused.
+    """
+    lines = ["#1 >CONTROLLER LIST"] + ["#%d >CONTROLLER PING" % tag for tag in range(2, 7)] + \
+            ["#7 >CONTROLLER ESTOP"]
+    output, _ = run_script(lines, linger_ms=500)
+    replies = tagged_replies(output)
+
+    failures = []
+    for tag in range(1, len(lines) + 1):
+        got = replies.get(tag, [])
+        if len(got) != 1:
+            failures.append("#%d: %d replies %r" % (tag, len(got), got))
+    if replies.get(7) != ["CONTROLLER ESTOP OK"]:
+        return failures + ["#7: expected 'CONTROLLER ESTOP OK', got %r" % replies.get(7)]
+
+    order = [int(m) for m in re.findall(r"^#(\d+) ", output, re.M)]
+    refused = [tag for tag in range(2, 7) if "Emergency stop active" in replies.get(tag, [""])[0]]
+    if not refused:
+        failures.append("no queued PING was refused; ESTOP did not run ahead of them")
+    late = [tag for tag in refused if order.index(tag) < order.index(7)]
+    if late:
+        failures.append("refused before the ESTOP reply: %r" % late)
+    return failures
+
+
+def test_busy_replies_ahead_of_long_reply():
+    """Busy replies are sent while CONTROLLER LIST is going out, not after it.
+
+    They are URGENT and have their own queue; none may end up behind the
+    LIST output that fills the overflow store.
+    """
+    window = config_value("COMMAND_WINDOW")
+    lines = ["#1 >CONTROLLER LIST"] + ["#%d >CONTROLLER PING" % tag for tag in range(2, 3 * window + 2)]
+    output, errors = run_script(lines, linger_ms=500)
+    replies = tagged_replies(output)
+
+    failures = []
+    for tag in range(1, len(lines) + 1):
+        got = replies.get(tag, [])
+        if len(got) != 1:
+            failures.append("#%d: %d replies %r" % (tag, len(got), got))
+    if "RX overruns" in errors:
+        failures.append(errors.strip())
+
+    # The LIST output ends with the last untagged line before the first PONG
+    output_lines = [line.rstrip("\r") for line in output.splitlines()]
+    first_pong = min(i for i, line in enumerate(output_lines) if line.endswith(" PONG"))
+    list_end = max(i for i in range(first_pong) if not output_lines[i].startswith("#"))
+    late = [line for line in output_lines[list_end:first_pong] if "Receive window full" in line]
+    if late:
+        failures.append("busy replies after the LIST output: %r" % late)
+    return failures
+
+
+def test_disabled_stepper_reply_only():
+    """A move to a disabled stepper is answered by its reply and nothing else."""
+    output, _ = run_script(["#1 >X position 1", "#2 >X velocity 1"], linger_ms=200)
+    replies = tagged_replies(output)
+    failures = []
+    for tag in (1, 2):
+        got = replies.get(tag, [])
+        if len(got) != 1 or "Not enabled" not in got[0]:
+            failures.append("#%d: expected a 'Not enabled' error, got %r" % (tag, got))
+    stray = [line for line in output.splitlines() if "StepperMotor" in line]
+    if stray:
+        failures.append("output outside the replies: %r" % stray)
+    return failures
+
+
+def direction_changes_under_step(trace):
+    """Per axis, the DIR edges that happen while its STEP output is high."""
+    sys.path.insert(0, TOOLS)
+    import steptrace
+    events = steptrace.read_trace(trace)
+    changes = {}
+    for name, (step_pin, dir_pin, _) in steptrace.DEFAULT_AXES.items():
+        step_high = False
+        for nanos, pin, level in events:
+            if pin == step_pin:
+                step_high = bool(level)
+            elif pin == dir_pin and step_high:
+                changes.setdefault(name, []).append(nanos)
+    return changes
+
+
+def test_direction_changes_with_step_low():
+    """DIR only changes between pulses, at a reversal and at junctions."""
+    runs = {
+        "reversal": [">X enable", ">X position 1", ">X position -1"],
+        "junctions": [">STEPPERS enable", ">STEPPERS move 0.5 0.5 0 2", ">STEPPERS move 0 1 0 2",
+                      ">STEPPERS move 0.5 0 0 2", ">STEPPERS move 0 0 0 2"],
+    }
+    failures = []
+    for name, lines in runs.items():
+        trace = os.path.join(BUILD, "direction-%s.ptrc" % name)
+        run_script(lines, ENDSTOPS_OPEN + ["--trace", trace], linger_ms=8000)
+        for axis, times in sorted(direction_changes_under_step(trace).items()):
+            failures.append("%s: %s DIR changed with STEP high at %s s"
+                            % (name, axis, ", ".join("%.6f" % (t / 1e9) for t in times)))
+    return failures
+
+
+def step_edges(trace):
+    """Step and DIR edges from the first step on, timed from that step.
+
+    Edges before the first step (DIR set up while idle) are dropped.
+    """
+    sys.path.insert(0, TOOLS)
+    import steptrace
+    names = {}
+    for name, (step_pin, dir_pin, _) in steptrace.DEFAULT_AXES.items():
+        names[step_pin] = name + " STEP"
+        names[dir_pin] = name + " DIR"
+    edges = [(nanos, names[pin], level) for nanos, pin, level in steptrace.read_trace(trace)
+             if pin in names]
+    start = next((nanos for nanos, name, _ in edges if name.endswith("STEP")), 0)
+    return [(nanos - start, name, level) for nanos, name, level in edges if nanos >= start]
+
+
+def test_step_timing_independent_of_loop_load():
+    """The same move steps identically with a fast and a heavily loaded loop.
+
+    --loop-us sets the virtual time each loop() pass takes; 10 ms stands
+    in for a main loop busy with slow replies or devices. Only the start
+    of the move may shift (the command is parsed later); every step edge
+    after the first must match. Moves that are fully planned when they
+    start are used: a block that starts before the next command has been
+    parsed keeps its stop at the end, which depends on when that command
+    arrived, not on the step generation.
+    """
+    moves = {
+        "trapezoid": [">X enable", ">X position 3"],
+        "scurve": [">X enable", ">X jerk 50", ">X position 3"],
+        "linear": [">STEPPERS enable", ">STEPPERS move 1 0.5 0.25 2"],
+    }
+    failures = []
+    for name, lines in sorted(moves.items()):
+        edges = {}
+        for loop_us in (20, 10000):
+            trace = os.path.join(BUILD, "loop-load-%s-%d.ptrc" % (name, loop_us))
+            run_script(lines, ENDSTOPS_OPEN + ["--loop-us", str(loop_us), "--trace", trace],
+                       linger_ms=8000)
+            edges[loop_us] = step_edges(trace)
+        fast, loaded = edges[20], edges[10000]
+        if not fast:
+            failures.append("%s: no steps" % name)
+        elif fast != loaded:
+            index = next((i for i, (a, b) in enumerate(zip(fast, loaded)) if a != b),
+                         min(len(fast), len(loaded)))
+            failures.append("%s: %d/%d edges, first difference at edge %d: %r vs %r"
+                            % (name, len(fast), len(loaded), index,
+                               fast[index] if index < len(fast) else None,
+                               loaded[index] if index < len(loaded) else None))
+    return failures
+
+
+# Canonical moves with a golden trace in test/traces/<name>.ptrc
+GOLDEN_MOVES = {
+    "x_trapezoid": [">X enable", ">X position 6"],
+    "x_scurve": [">X enable", ">X jerk 50", ">X position 6"],
+    "x_reversal": [">X enable", ">X position 2", ">X position -1"],
+    "linear_xyz": [">STEPPERS enable", ">STEPPERS move 1 0.5 0.25 2", ">STEPPERS move 0 0 0 2"],
+}
+
+
+def record_golden_move(name, trace):
+    run_script(GOLDEN_MOVES[name], ENDSTOPS_OPEN + ["--trace", trace], linger_ms=10000)
+
+
+def test_golden_traces():
+    """Canonical moves step exactly as in their golden traces.
+
+    Virtual time makes a run deterministic, so the comparison has no
+    tolerance: any change of a step time, rate or count fails.
+    """
+    failures = []
+    for name in sorted(GOLDEN_MOVES):
+        reference = os.path.join(TRACES, name + ".ptrc")
+        if not os.path.exists(reference):
+            failures.append("%s: no golden trace, record it with --update-traces" % name)
+            continue
+        trace = os.path.join(BUILD, "golden-%s.ptrc" % name)
+        record_golden_move(name, trace)
+        result = subprocess.run([sys.executable, os.path.join(TOOLS, "steptrace.py"),
+                                 "compare", trace, reference],
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        if result.returncode != 0:
+            failures += ["%s: %s" % (name, line) for line in result.stdout.splitlines()
+                         if "ok" not in line.split()]
+    return failures
+
+
+def update_traces():
+    os.makedirs(TRACES, exist_ok=True)
+    for name in sorted(GOLDEN_MOVES):
+        trace = os.path.join(TRACES, name + ".ptrc")
+        record_golden_move(name, trace)
+        print("recorded %s" % os.path.relpath(trace, ROOT))
+
+
+SCENARIOS = [test_receive_window_burst, test_estop_bypasses_receive_window,
+             test_busy_replies_ahead_of_long_reply, test_disabled_stepper_reply_only,
+             test_direction_changes_with_step_low, test_step_timing_independent_of_loop_load,
+             test_golden_traces]
+
+
+# ============================================
+# Host tests
+# ============================================
+
+def host_tests():
+    return sorted(glob.glob(os.path.join(ROOT, "test", "native", "test_*.cpp")))
+
+
+def run_host_test(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    output = os.path.join(BUILD, name)
+    compile_program(output, [path], with_main=False)
+    result = subprocess.run([output], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            text=True, timeout=300)
+    sys.stdout.write(result.stdout)
+    return [] if result.returncode == 0 else ["%s exited with %d" % (name, result.returncode)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Native regression tests")
+    parser.add_argument("-k", dest="pattern", default="", help="run tests whose name contains this")
+    parser.add_argument("--list", action="store_true", help="list the tests")
+    parser.add_argument("--update-traces", action="store_true",
+                        help="record the golden step traces again")
+    args = parser.parse_args()
+
+    if args.update_traces:
+        compile_program(PROGRAM, [], with_main=True)
+        update_traces()
+        return 0
+
+    tests = [(t.__name__, t) for t in SCENARIOS]
+    tests += [(os.path.splitext(os.path.basename(p))[0], lambda p=p: run_host_test(p))
+              for p in host_tests()]
+    tests = [(name, test) for name, test in tests if args.pattern in name]
+
+    if args.list:
+        for name, _ in tests:
+            print(name)
+        return 0
+
+    if any(test in SCENARIOS for _, test in tests):
+        compile_program(PROGRAM, [], with_main=True)
+
+    failed = 0
+    for name, test in tests:
+        try:
+            failures = test()
+        except (RuntimeError, subprocess.TimeoutExpired) as e:
+            failures = [str(e)]
+        print("%-44s %s" % (name, "FAIL" if failures else "ok"))
+        for failure in failures:
+            print("    " + failure)
+        failed += bool(failures)
+
+    print("%d passed, %d failed" % (len(tests) - failed, failed))
+    return failed
+
+
+if __name__ == "__main__":
+    sys.exit(main())
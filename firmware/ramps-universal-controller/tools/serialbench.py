@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""Serial protocol throughput and latency benchmark.
+
+Runs command workloads against the native build (started on a pseudo
+terminal and paced in real time) or a board on a serial port, keeping up
+to --window tagged commands in flight (see "Pipelining" in README.md):
+
+  serialbench.py                                   Native build, all workloads
+  serialbench.py --port /dev/ttyACM0               A board
+  serialbench.py --workload position,query -n 2000
+  serialbench.py --json > result.json              Machine readable results
+  serialbench.py --baseline result.json            Exit status 1 on a regression
+
+Workloads:
+  position   Position stream to the steppers and a servo
+  query      Position, switch, sensor, queue and PING queries
+  bulk       STEPPERS group commands
+  telemetry  Queries while three channels stream every 10 ms
+  mixed      All of the above interleaved
+
+For each workload it reports commands/s, reply latency (p50/p99/max, wall
+clock from the write to the reply), bytes sent and received per command,
+and the error rate (ERROR replies and replies that never came). Device
+names are those of the stock include/DeviceConfig.h.
+"""
+
+import argparse
+import json
+import os
+import re
+import select
+import subprocess
+import sys
+import termios
+import time
+import tty
+
+DEFAULT_PROGRAM = ".pio/build/native/program"
+REPLY_PATTERN = re.compile(rb"^#(\d+) (.*)$")
+
+WORKLOADS = ("position", "query", "bulk", "telemetry", "mixed")
+
+SETUP = ["STEPPERS enable"]
+TELEMETRY_SETUP = ["X subscribe position", "Y subscribe position", "T0 subscribe",
+                   "CONTROLLER subscribe 10"]
+TELEMETRY_TEARDOWN = ["CONTROLLER unsubscribe"]
+
+
+def position_commands(i):
+    value = 0.05 * (i % 20)
+    return ["X position %.2f" % value, "Y position %.2f" % -value,
+            "Z position %.2f" % value, "Servo0 position %.2f" % (1.0 + value)][i % 4]
+
+
+def query_commands(i):
+    return ["X position?", "CONTROLLER PING", "T0 read", "XMin state?",
+            "STEPPERS queue?", "D10 position?"][i % 6]
+
+
+def bulk_commands(i):
+    value = 0.05 * (i % 20)
+    return ["STEPPERS position %.2f %.2f %.2f" % (value, -value, value),
+            "STEPPERS queue?", "STEPPERS velocity 0"][i % 3]
+
+
+def mixed_commands(i):
+    return [position_commands, query_commands, bulk_commands][i % 3](i // 3)
+
+
+GENERATORS = {
+    "position": position_commands,
+    "query": query_commands,
+    "bulk": bulk_commands,
+    "telemetry": query_commands,
+    "mixed": mixed_commands,
+}
+
+
+class Link:
+    """Line oriented access to the serial port."""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.buffer = b""
+        self.sent = 0
+        self.received = 0
+
+    def write(self, line):
+        data = line.encode() + b"\n"
+        view = memoryview(data)
+        while view:
+            n = os.write(self.fd, view)
+            view = view[n:]
+        self.sent += len(data)
+
+    def read_lines(self, timeout):
+        """Return the complete lines received within timeout seconds."""
+        ready, _, _ = select.select([self.fd], [], [], timeout)
+        if ready:
+            try:
+                data = os.read(self.fd, 4096)
+            except OSError:
+                data = b""
+            if not data:
+                raise EOFError("serial port closed")
+            self.received += len(data)
+            self.buffer += data
+        lines = self.buffer.split(b"\n")
+        self.buffer = lines.pop()
+        return [line.rstrip(b"\r") for line in lines]
+
+    def drain(self, quiet, limit=2.0):
+        """Discard input until the line has been quiet for `quiet` seconds."""
+        end = time.perf_counter() + limit
+        while (self.read_lines(quiet) or self.buffer) and time.perf_counter() < end:
+            self.buffer = b""
+        self.buffer = b""
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    if baud:
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def start_program(program):
+    """Start the native build on a pty; return (process, pty path)."""
+    process = subprocess.Popen(
+        [program, "--pty", "--realtime", "--input", "3=0", "--input", "14=0", "--input", "18=0"],
+        stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    line = process.stderr.readline().decode().strip()
+    if not line.startswith("PTY "):
+        process.kill()
+        raise RuntimeError("%s did not open a pty (%r)" % (program, line))
+    return process, line[4:]
+
+
+def percentile(values, fraction):
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+def run_commands(link, commands, window, timeout):
+    """Send commands with up to `window` in flight; return the measurements."""
+    in_flight = {}          # tag -> send time
+    latencies = []
+    errors = 0
+    telemetry = 0
+    next_tag = 1
+    sent = 0
+    sent_before = link.sent
+    received_before = link.received
+    start = time.perf_counter()
+
+    while sent < len(commands) or in_flight:
+        while sent < len(commands) and len(in_flight) < window:
+            tag = next_tag
+            next_tag = next_tag % 65535 + 1
+            in_flight[tag] = time.perf_counter()
+            link.write("#%d >%s" % (tag, commands[sent]))
+            sent += 1
+
+        for line in link.read_lines(0.05):
+            now = time.perf_counter()
+            match = REPLY_PATTERN.match(line)
+            if not match:
+                if line.startswith(b"TLM "):
+                    telemetry += 1
+                continue
+            sent_at = in_flight.pop(int(match.group(1)), None)
+            if sent_at is None:
+                continue
+            latencies.append(now - sent_at)
+            if match.group(2).startswith(b"ERROR"):
+                errors += 1
+
+        now = time.perf_counter()
+        for tag, sent_at in list(in_flight.items()):
+            if now - sent_at > timeout:
+                del in_flight[tag]
+                errors += 1     # No reply
+
+    elapsed = time.perf_counter() - start
+    count = len(commands)
+    return {
+        "commands": count,
+        "seconds": elapsed,
+        "commands_per_s": count / elapsed if elapsed > 0 else 0.0,
+        "latency_p50_ms": percentile(latencies, 0.50) * 1000.0,
+        "latency_p99_ms": percentile(latencies, 0.99) * 1000.0,
+        "latency_max_ms": max(latencies, default=0.0) * 1000.0,
+        "tx_bytes_per_command": (link.sent - sent_before) / count,
+        "rx_bytes_per_command": (link.received - received_before) / count,
+        "error_rate": errors / count,
+        "telemetry_records_per_s": telemetry / elapsed if elapsed > 0 else 0.0,
+    }
+
+
+def run_workload(link, name, count, window, timeout):
+    setup = SETUP + (TELEMETRY_SETUP if name == "telemetry" else [])
+    run_commands(link, setup, 1, timeout)
+
+    generate = GENERATORS[name]
+    result = run_commands(link, [generate(i) for i in range(count)], window, timeout)
+
+    run_commands(link, TELEMETRY_TEARDOWN + ["STEPPERS velocity 0"], 1, timeout)
+    link.drain(0.1)
+    return result
+
+
+def compare(results, baseline, tolerance):
+    """Return descriptions of results worse than the baseline."""
+    regressions = []
+    for name, result in results.items():
+        base = baseline.get("workloads", {}).get(name)
+        if not base:
+            continue
+        if result["commands_per_s"] < base["commands_per_s"] * (1.0 - tolerance):
+            regressions.append("%s: %.1f commands/s (baseline %.1f)"
+                               % (name, result["commands_per_s"], base["commands_per_s"]))
+        if result["latency_p99_ms"] > base["latency_p99_ms"] * (1.0 + tolerance):
+            regressions.append("%s: p99 %.2f ms (baseline %.2f)"
+                               % (name, result["latency_p99_ms"], base["latency_p99_ms"]))
+        if result["error_rate"] > base["error_rate"] + 0.001:
+            regressions.append("%s: error rate %.4f (baseline %.4f)"
+                               % (name, result["error_rate"], base["error_rate"]))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serial protocol benchmark")
+    parser.add_argument("--program", default=DEFAULT_PROGRAM,
+                        help="native build to start (default %s)" % DEFAULT_PROGRAM)
+    parser.add_argument("--port", help="serial port of a board instead of the native build")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of --port")
+    parser.add_argument("--workload", default=",".join(WORKLOADS),
+                        help="comma separated workloads (default all)")
+    parser.add_argument("-n", "--count", type=int, default=500, help="commands per workload")
+    parser.add_argument("--window", type=int, default=4,
+                        help="commands in flight (COMMAND_WINDOW, default 4)")
+    parser.add_argument("--timeout", type=float, default=2.0, help="seconds to wait for a reply")
+    parser.add_argument("--json", action="store_true", help="machine readable output")
+    parser.add_argument("--baseline", help="earlier --json result to compare against")
+    parser.add_argument("--tolerance", type=float, default=10.0,
+                        help="allowed throughput/p99 change against the baseline in %% (default 10)")
+    args = parser.parse_args()
+
+    names = [w for w in args.workload.split(",") if w]
+    unknown = [w for w in names if w not in WORKLOADS]
+    if unknown:
+        parser.error("unknown workload %s" % ", ".join(unknown))
+
+    process = None
+    try:
+        if args.port:
+            target = args.port
+            fd = open_port(args.port, args.baud)
+            time.sleep(2.0)     # Opening the port resets a board
+        else:
+            target = args.program
+            process, path = start_program(args.program)
+            fd = open_port(path, 0)
+        link = Link(fd)
+        link.drain(0.5)
+
+        results = {}
+        for name in names:
+            results[name] = run_workload(link, name, args.count, args.window, args.timeout)
+    except (OSError, EOFError, RuntimeError) as e:
+        print("serialbench: %s" % e, file=sys.stderr)
+        return 2
+    finally:
+        if process:
+            process.terminate()
+            process.wait()
+
+    report = {"target": target, "window": args.window, "count": args.count, "workloads": results}
+    if args.json:
+        json.dump(report, sys.stdout, indent=2)
+        print()
+    else:
+        print("%-10s %9s %8s %8s %8s %7s %7s %7s" % ("workload", "cmd/s", "p50 ms", "p99 ms",
+                                                   "max ms", "tx B", "rx B", "errors"))
+        for name, r in results.items():
+            print("%-10s %9.1f %8.2f %8.2f %8.2f %7.1f %7.1f %6.2f%%"
+                  % (name, r["commands_per_s"], r["latency_p50_ms"], r["latency_p99_ms"],
+                     r["latency_max_ms"], r["tx_bytes_per_command"], r["rx_bytes_per_command"],
+                     r["error_rate"] * 100.0))
+            if r["telemetry_records_per_s"]:
+                print("%-10s %9.1f telemetry records/s" % ("", r["telemetry_records_per_s"]))
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = compare(results, json.load(f), args.tolerance / 100.0)
+        for line in regressions:
+            print("regression: %s" % line, file=sys.stderr)
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
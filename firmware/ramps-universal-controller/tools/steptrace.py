@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+"""Analyse step/dir traces recorded by the native build.
+
+Record a run with `.pio/build/native/program --trace run.ptrc` (format in
+lib/ArduinoNative/src/PinTrace.h), then:
+
+  steptrace.py summary run.ptrc              Per axis: moves, rates, acceleration,
+                                             inter-step jitter, final position
+  steptrace.py summary run.ptrc --expect X=6400
+                                             ... and the final position error
+  steptrace.py profile run.ptrc X            Time, position, rate and acceleration
+                                             of every step as CSV
+  steptrace.py compare run.ptrc ref.ptrc     Differences against a reference run;
+                                             exit status 1 if they exceed the
+                                             tolerances
+
+Axes default to the RAMPS 1.4 step/dir pins (include/PinDefinitions.h);
+--axis NAME=STEP,DIR[,invert] adds or replaces one. Rates are in steps/s and
+accelerations in steps/s^2, averaged over --window steps. --json prints summary and compare results in a
+machine readable form.
+"""
+
+import argparse
+import json
+import math
+import sys
+
+TRACE_MAGIC = b"PTRC"
+TRACE_VERSION = 1
+
+# name: (step pin, dir pin, direction inverted)
+DEFAULT_AXES = {
+    "X": (54, 55, False),
+    "Y": (60, 61, False),
+    "Z": (46, 48, False),
+    "E0": (26, 28, False),
+    "E1": (36, 34, False),
+}
+
+NS_PER_S = 1e9
+
+
+def read_trace(path):
+    """Return the output changes of a trace as (nanos, pin, level) tuples."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != TRACE_MAGIC or len(data) < 5:
+        raise ValueError("%s: not a pin trace" % path)
+    if data[4] != TRACE_VERSION:
+        raise ValueError("%s: trace version %d not supported" % (path, data[4]))
+
+    events = []
+    now = 0
+    i = 5
+    while i < len(data):
+        delta = 0
+        shift = 0
+        while True:
+            b = data[i]
+            i += 1
+            delta |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        if i + 2 > len(data):
+            raise ValueError("%s: truncated record" % path)
+        now += delta
+        events.append((now, data[i], data[i + 1]))
+        i += 2
+    return events
+
+
+def axis_steps(events, step_pin, dir_pin, inverted):
+    """Return (nanos, direction) of every rising step edge of one axis."""
+    steps = []
+    step_level = 0
+    forward = not inverted     # Direction output starts LOW
+    for nanos, pin, level in events:
+        if pin == dir_pin:
+            forward = (level != 0) != inverted
+        elif pin == step_pin:
+            if level and not step_level:
+                steps.append((nanos, 1 if forward else -1))
+            step_level = level
+    return steps
+
+
+def split_moves(steps, gap_ns):
+    """Split a step list where the axis stood still for longer than gap_ns."""
+    moves = []
+    start = 0
+    for i in range(1, len(steps) + 1):
+        if i == len(steps) or steps[i][0] - steps[i - 1][0] > gap_ns:
+            if i > start:
+                moves.append(steps[start:i])
+            start = i
+    return moves
+
+
+def rates(steps, window):
+    """Return (time, rate) over every run of `window` steps.
+
+    Averaging over a few steps keeps single-interval jitter out of the
+    rate and, above all, out of the acceleration derived from it.
+    """
+    result = []
+    for i in range(len(steps) - window):
+        t0 = steps[i][0]
+        t1 = steps[i + window][0]
+        if t1 > t0:
+            result.append(((t0 + t1) / 2.0, window * NS_PER_S / (t1 - t0)))
+    return result
+
+
+def accelerations(rate_points, window):
+    """Return (time, acceleration) between rate points `window` apart."""
+    result = []
+    for (t0, r0), (t1, r1) in zip(rate_points, rate_points[window:]):
+        if t1 > t0:
+            result.append(((t0 + t1) / 2.0, (r1 - r0) * NS_PER_S / (t1 - t0)))
+    return result
+
+
+def jitter(steps):
+    """Deviation of each step from a smooth curve through its neighbours, in ns.
+
+    The curve is the 5-point quadratic (Savitzky-Golay) fit of the step
+    times, which follows ramps closely; what remains is timing noise
+    (timer quantisation, steps of other axes, late interrupts).
+    """
+    t = [nanos for nanos, _ in steps]
+    return [t[i] - (-3 * t[i - 2] + 12 * t[i - 1] + 17 * t[i] + 12 * t[i + 1] - 3 * t[i + 2]) / 35.0
+            for i in range(2, len(t) - 2)]
+
+
+def move_stats(move, window):
+    rate_points = rates(move, window)
+    accel_points = accelerations(rate_points, window)
+    deviations = jitter(move)
+    return {
+        "start_s": move[0][0] / NS_PER_S,
+        "end_s": move[-1][0] / NS_PER_S,
+        "steps": len(move),
+        "net": sum(d for _, d in move),
+        "peak_rate": max((r for _, r in rate_points), default=0.0),
+        "peak_accel": max((a for _, a in accel_points), default=0.0),
+        "peak_decel": -min((a for _, a in accel_points), default=0.0),
+        "jitter_rms_us": math.sqrt(sum(j * j for j in deviations) / len(deviations)) / 1000.0
+        if deviations else 0.0,
+        "jitter_max_us": max((abs(j) for j in deviations), default=0.0) / 1000.0,
+        "min_interval_us": min((move[i + 1][0] - move[i][0] for i in range(len(move) - 1)),
+                               default=0) / 1000.0,
+    }
+
+
+def overlap_skew(axes):
+    """Start and end skew of moves of different axes that overlap in time."""
+    result = []
+    names = sorted(axes)
+    for a in range(len(names)):
+        for b in range(a + 1, len(names)):
+            for ma in axes[names[a]]["moves"]:
+                for mb in axes[names[b]]["moves"]:
+                    if ma["start_s"] <= mb["end_s"] and mb["start_s"] <= ma["end_s"]:
+                        result.append({
+                            "axes": [names[a], names[b]],
+                            "start_skew_us": (mb["start_s"] - ma["start_s"]) * 1e6,
+                            "end_skew_us": (mb["end_s"] - ma["end_s"]) * 1e6,
+                        })
+    return result
+
+
+def analyse(events, axis_map, gap_ns, window):
+    axes = {}
+    for name, (step_pin, dir_pin, inverted) in sorted(axis_map.items()):
+        steps = axis_steps(events, step_pin, dir_pin, inverted)
+        if not steps:
+            continue
+        axes[name] = {
+            "steps": steps,
+            "position": sum(d for _, d in steps),
+            "moves": [move_stats(m, window) for m in split_moves(steps, gap_ns)],
+        }
+    return axes
+
+
+def parse_axes(specs):
+    axis_map = dict(DEFAULT_AXES)
+    for spec in specs or []:
+        name, _, pins = spec.partition("=")
+        fields = pins.split(",")
+        if not name or len(fields) < 2:
+            raise SystemExit("bad --axis %r (NAME=STEP,DIR[,invert])" % spec)
+        axis_map[name] = (int(fields[0]), int(fields[1]),
+                          len(fields) > 2 and fields[2] == "invert")
+    return axis_map
+
+
+def public(axes):
+    """Axis results without the raw step lists."""
+    return {name: {k: v for k, v in axis.items() if k != "steps"}
+            for name, axis in axes.items()}
+
+
+def command_summary(args, axis_map):
+    axes = analyse(read_trace(args.trace), axis_map, args.gap_ms * 1e6, args.window)
+
+    expected = {}
+    for spec in args.expect or []:
+        name, _, value = spec.partition("=")
+        expected[name] = int(value)
+
+    result = {"axes": public(axes), "sync": overlap_skew(axes)}
+    for name, target in expected.items():
+        position = axes[name]["position"] if name in axes else 0
+        result["axes"].setdefault(name, {"position": 0, "moves": []})
+        result["axes"][name]["expected"] = target
+        result["axes"][name]["error"] = position - target
+
+    missed = any(axis.get("error") for axis in result["axes"].values())
+
+    if args.json:
+        json.dump(result, sys.stdout, indent=2)
+        print()
+        return 1 if missed else 0
+
+    for name, axis in result["axes"].items():
+        line = "%s: position %d" % (name, axis["position"])
+        if "expected" in axis:
+            line += ", expected %d, error %d" % (axis["expected"], axis["error"])
+        print(line)
+        for m in axis["moves"]:
+            print("  %.4f-%.4f s  %d steps (net %+d)  peak %.1f steps/s  "
+                  "accel %.0f / decel %.0f steps/s^2  jitter rms %.2f max %.2f us  "
+                  "min interval %.1f us"
+                  % (m["start_s"], m["end_s"], m["steps"], m["net"], m["peak_rate"],
+                     m["peak_accel"], m["peak_decel"], m["jitter_rms_us"],
+                     m["jitter_max_us"], m["min_interval_us"]))
+    for s in result["sync"]:
+        print("sync %s/%s: start skew %.1f us, end skew %.1f us"
+              % (s["axes"][0], s["axes"][1], s["start_skew_us"], s["end_skew_us"]))
+    return 1 if missed else 0
+
+
+def command_profile(args, axis_map):
+    if args.axis_name not in axis_map:
+        raise SystemExit("unknown axis %s" % args.axis_name)
+    steps = axis_steps(read_trace(args.trace), *axis_map[args.axis_name])
+
+    # Rate and acceleration over the window ending at each step
+    print("time_s,position,rate,accel")
+    window = args.window
+    position = 0
+    rate_at = []
+    for i, (nanos, direction) in enumerate(steps):
+        position += direction
+        rate = accel = ""
+        if i >= window and nanos > steps[i - window][0]:
+            r = window * NS_PER_S / (nanos - steps[i - window][0])
+            rate = "%.3f" % r
+            if i >= 2 * window and rate_at[i - window] is not None:
+                t0 = (steps[i - 2 * window][0] + steps[i - window][0]) / 2.0
+                t1 = (steps[i - window][0] + nanos) / 2.0
+                accel = "%.1f" % ((r - rate_at[i - window]) * NS_PER_S / (t1 - t0))
+            rate_at.append(r)
+        else:
+            rate_at.append(None)
+        print("%.9f,%d,%s,%s" % (nanos / NS_PER_S, position, rate, accel))
+    return 0
+
+
+def command_compare(args, axis_map):
+    gap_ns = args.gap_ms * 1e6
+    run = analyse(read_trace(args.trace), axis_map, gap_ns, args.window)
+    ref = analyse(read_trace(args.reference), axis_map, gap_ns, args.window)
+
+    result = {"axes": {}, "pass": True}
+    for name in sorted(set(run) | set(ref)):
+        a = run.get(name, {"steps": [], "position": 0, "moves": []})
+        b = ref.get(name, {"steps": [], "position": 0, "moves": []})
+        common = min(len(a["steps"]), len(b["steps"]))
+        shifts = [abs(a["steps"][i][0] - b["steps"][i][0]) / 1000.0 for i in range(common)]
+        peak_a = max((m["peak_rate"] for m in a["moves"]), default=0.0)
+        peak_b = max((m["peak_rate"] for m in b["moves"]), default=0.0)
+        rate_change = (peak_a - peak_b) * 100.0 / peak_b if peak_b else 0.0
+
+        axis = {
+            "position": a["position"],
+            "reference_position": b["position"],
+            "steps": len(a["steps"]),
+            "reference_steps": len(b["steps"]),
+            "moves": len(a["moves"]),
+            "reference_moves": len(b["moves"]),
+            "max_time_shift_us": max(shifts, default=0.0),
+            "peak_rate_change_pct": rate_change,
+        }
+        axis["pass"] = (axis["position"] == axis["reference_position"] and
+                        axis["steps"] == axis["reference_steps"] and
+                        axis["moves"] == axis["reference_moves"] and
+                        axis["max_time_shift_us"] <= args.time_tol_us and
+                        abs(rate_change) <= args.rate_tol_pct)
+        result["axes"][name] = axis
+        result["pass"] = result["pass"] and axis["pass"]
+
+    if args.json:
+        json.dump(result, sys.stdout, indent=2)
+        print()
+    else:
+        for name, axis in result["axes"].items():
+            print("%s: %s  position %d (ref %d)  steps %d (ref %d)  moves %d (ref %d)  "
+                  "max shift %.2f us  peak rate %+.2f%%"
+                  % (name, "ok" if axis["pass"] else "DIFFERS", axis["position"],
+                     axis["reference_position"], axis["steps"], axis["reference_steps"],
+                     axis["moves"], axis["reference_moves"], axis["max_time_shift_us"],
+                     axis["peak_rate_change_pct"]))
+    return 0 if result["pass"] else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Analyse native build step traces")
+    parser.add_argument("--axis", action="append", metavar="NAME=STEP,DIR[,invert]",
+                        help="step and direction pins of an axis")
+    parser.add_argument("--gap-ms", type=float, default=50.0,
+                        help="standstill that separates two moves (default 50)")
+    parser.add_argument("--window", type=int, default=8,
+                        help="steps per rate and acceleration estimate (default 8)")
+    parser.add_argument("--json", action="store_true", help="machine readable output")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    summary = commands.add_parser("summary", help="per-axis motion statistics")
+    summary.add_argument("trace")
+    summary.add_argument("--expect", action="append", metavar="NAME=STEPS",
+                         help="expected final position (exit status 1 if missed)")
+
+    profile = commands.add_parser("profile", help="per-step CSV of one axis")
+    profile.add_argument("trace")
+    profile.add_argument("axis_name")
+
+    compare = commands.add_parser("compare", help="check a run against a reference trace")
+    compare.add_argument("trace")
+    compare.add_argument("reference")
+    compare.add_argument("--time-tol-us", type=float, default=0.0,
+                         help="largest allowed shift of any step (default 0)")
+    compare.add_argument("--rate-tol-pct", type=float, default=0.0,
+                         help="largest allowed peak rate change (default 0)")
+
+    args = parser.parse_args()
+    axis_map = parse_axes(args.axis)
+    handlers = {"summary": command_summary, "profile": command_profile,
+                "compare": command_compare}
+    try:
+        return handlers[args.command](args, axis_map)
+    except (OSError, ValueError) as e:
+        print("steptrace: %s" % e, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())